@@ -6,20 +6,27 @@
 
 #pragma once
 
+#include "fplus/c_locale.h"
+#include "fplus/char_kernels.h"
 #include "fplus/compare.h"
 #include "fplus/composition.h"
 #include "fplus/container_common.h"
 #include "fplus/container_properties.h"
 #include "fplus/container_traits.h"
+#include "fplus/csv.h"
+#include "fplus/file.h"
 #include "fplus/filter.h"
 #include "fplus/generate.h"
+#include "fplus/lazy.h"
 #include "fplus/maps.h"
 #include "fplus/maybe.h"
 #include "fplus/numeric.h"
 #include "fplus/pairs.h"
+#include "fplus/par.h"
 #include "fplus/read.h"
 #include "fplus/replace.h"
 #include "fplus/result.h"
+#include "fplus/rle_vector.h"
 #include "fplus/search.h"
 #include "fplus/show.h"
 #include "fplus/split.h"
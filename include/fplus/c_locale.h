@@ -0,0 +1,99 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <clocale>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+namespace fplus
+{
+
+namespace internal
+{
+
+// The C library functions converting floating point numbers,
+// like snprintf and strtod, use the decimal point of the current C locale,
+// e.g. "," after setlocale(LC_ALL, "de_DE.UTF-8").
+// These helpers make them behave like in the "C" locale instead.
+
+inline const char* c_locale_decimal_point()
+{
+    const char* point = std::localeconv()->decimal_point;
+    return point != nullptr && *point != '\0' ? point : ".";
+}
+
+inline bool c_locale_uses_dot()
+{
+    const char* point = c_locale_decimal_point();
+    return point[0] == '.' && point[1] == '\0';
+}
+
+// Replaces the decimal point of the current C locale
+// in str[0, size), as written by snprintf, with '.'.
+// Returns the new size.
+inline std::size_t to_dot_decimal_point(char* str, std::size_t size)
+{
+    if (c_locale_uses_dot())
+        return size;
+    const char* point = c_locale_decimal_point();
+    const std::size_t point_size = std::strlen(point);
+    char* const last = str + size;
+    char* const found = std::search(str, last, point, point + point_size);
+    if (found == last)
+        return size;
+    *found = '.';
+    std::memmove(found + 1, found + point_size,
+        static_cast<std::size_t>(last - (found + point_size)));
+    return size - (point_size - 1);
+}
+
+// Reads a number from [first, last) using parse, e.g. std::strtod,
+// as if the current C locale was "C".
+// Returns the position behind the chars used, first if there are none.
+// first must point into a null-terminated string.
+template <typename T, typename Parse>
+const char* parse_with_dot_decimal_point(const char* first, const char* last,
+    Parse parse, T& result)
+{
+    char* end = nullptr;
+    if (c_locale_uses_dot())
+    {
+        result = parse(first, &end);
+        return end;
+    }
+    // No number contains the first char of the locale's decimal point,
+    // so it ends the input like it would in the "C" locale.
+    const char* point = c_locale_decimal_point();
+    const std::size_t point_size = std::strlen(point);
+    std::string buffer;
+    buffer.reserve(static_cast<std::size_t>(last - first) + point_size);
+    std::size_t dot = std::string::npos;
+    for (const char* p = first; p != last && *p != point[0]; ++p)
+    {
+        if (*p == '.' && dot == std::string::npos)
+        {
+            dot = buffer.size();
+            buffer += point;
+        }
+        else
+        {
+            buffer += *p;
+        }
+    }
+    result = parse(buffer.c_str(), &end);
+    std::size_t used = static_cast<std::size_t>(end - buffer.c_str());
+    if (dot != std::string::npos && used > dot)
+        used -= point_size - 1;
+    return first + used;
+}
+
+} // namespace internal
+
+} // namespace fplus
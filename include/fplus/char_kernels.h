@@ -0,0 +1,485 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Classification of bytes 16 (SSE2) or 32 (AVX2) at a time,
+// used by string_tools.h for strings of single-byte characters.
+// The instruction set is selected at runtime.
+// Define FPLUS_NO_SIMD to always use the scalar versions.
+#if !defined(FPLUS_NO_SIMD) && defined(__GNUC__) && defined(__SSE2__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define FPLUS_CHAR_KERNELS_SSE2 1
+#include <immintrin.h>
+#define FPLUS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace fplus
+{
+
+namespace internal
+{
+
+enum class char_kernel_isa { scalar, sse2, avx2 };
+
+inline char_kernel_isa detect_char_kernel_isa()
+{
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return char_kernel_isa::avx2;
+    return char_kernel_isa::sse2;
+#else
+    return char_kernel_isa::scalar;
+#endif
+}
+
+// Instruction set used by the kernels below.
+// Can be lowered, e.g. to test the fallbacks.
+inline char_kernel_isa& active_char_kernel_isa()
+{
+    static char_kernel_isa isa = detect_char_kernel_isa();
+    return isa;
+}
+
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+
+// Bytes in [low, high].
+inline __m128i bytes_in_range_sse2(__m128i v, unsigned char low,
+    unsigned char high)
+{
+    const __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(
+        static_cast<char>(low)));
+    const __m128i width = _mm_set1_epi8(static_cast<char>(high - low));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, width), shifted);
+}
+
+inline __m128i bytes_equal_sse2(__m128i v, unsigned char c)
+{
+    return _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(c)));
+}
+
+inline std::uint32_t mask_of_sse2(__m128i m)
+{
+    return static_cast<std::uint32_t>(_mm_movemask_epi8(m));
+}
+
+FPLUS_TARGET_AVX2
+inline __m256i bytes_in_range_avx2(__m256i v, unsigned char low,
+    unsigned char high)
+{
+    const __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(
+        static_cast<char>(low)));
+    const __m256i width = _mm256_set1_epi8(static_cast<char>(high - low));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, width), shifted);
+}
+
+FPLUS_TARGET_AVX2
+inline __m256i bytes_equal_avx2(__m256i v, unsigned char c)
+{
+    return _mm256_cmpeq_epi8(v, _mm256_set1_epi8(static_cast<char>(c)));
+}
+
+FPLUS_TARGET_AVX2
+inline std::uint32_t mask_of_avx2(__m256i m)
+{
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(m));
+}
+
+#endif
+
+// Each byte class provides a scalar test and, with SSE2,
+// mask16/mask32 returning one bit per byte of p[0..15] or p[0..31].
+
+// Neither a letter nor a digit (ASCII).
+struct non_alnum_bytes
+{
+    bool operator()(unsigned char c) const
+    {
+        return !((c >= '0' && c <= '9') ||
+            ((c | 0x20) >= 'a' && (c | 0x20) <= 'z'));
+    }
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    std::uint32_t mask16(const unsigned char* p) const
+    {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p));
+        const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        return ~mask_of_sse2(_mm_or_si128(
+            bytes_in_range_sse2(v, '0', '9'),
+            bytes_in_range_sse2(lower, 'a', 'z'))) & 0xFFFFu;
+    }
+    FPLUS_TARGET_AVX2
+    std::uint32_t mask32(const unsigned char* p) const
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p));
+        const __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+        return ~mask_of_avx2(_mm256_or_si256(
+            bytes_in_range_avx2(v, '0', '9'),
+            bytes_in_range_avx2(lower, 'a', 'z')));
+    }
+#endif
+};
+
+// ' ', '\t', '\n', '\v', '\f' or '\r'
+struct whitespace_bytes
+{
+    bool operator()(unsigned char c) const
+    {
+        return c == ' ' || (c >= 9 && c <= 13);
+    }
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    std::uint32_t mask16(const unsigned char* p) const
+    {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p));
+        return mask_of_sse2(_mm_or_si128(
+            bytes_equal_sse2(v, ' '), bytes_in_range_sse2(v, 9, 13)));
+    }
+    FPLUS_TARGET_AVX2
+    std::uint32_t mask32(const unsigned char* p) const
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p));
+        return mask_of_avx2(_mm256_or_si256(
+            bytes_equal_avx2(v, ' '), bytes_in_range_avx2(v, 9, 13)));
+    }
+#endif
+};
+
+// '\n' or '\r'
+struct line_break_bytes
+{
+    bool operator()(unsigned char c) const
+    {
+        return c == '\n' || c == '\r';
+    }
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    std::uint32_t mask16(const unsigned char* p) const
+    {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p));
+        return mask_of_sse2(_mm_or_si128(
+            bytes_equal_sse2(v, '\n'), bytes_equal_sse2(v, '\r')));
+    }
+    FPLUS_TARGET_AVX2
+    std::uint32_t mask32(const unsigned char* p) const
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p));
+        return mask_of_avx2(_mm256_or_si256(
+            bytes_equal_avx2(v, '\n'), bytes_equal_avx2(v, '\r')));
+    }
+#endif
+};
+
+// Any of the given bytes.
+struct one_of_bytes
+{
+    template <typename Container>
+    explicit one_of_bytes(const Container& bytes) : table_(256, false)
+    {
+        for (const auto c : bytes)
+        {
+            const unsigned char b = static_cast<unsigned char>(c);
+            if (!table_[b])
+                distinct_.push_back(b);
+            table_[b] = true;
+        }
+    }
+    bool operator()(unsigned char c) const
+    {
+        return table_[c];
+    }
+    // One comparison per distinct byte, so large sets stay scalar.
+    bool vectorizable() const
+    {
+        return distinct_.size() <= 8;
+    }
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    std::uint32_t mask16(const unsigned char* p) const
+    {
+        const __m128i v = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(p));
+        __m128i m = _mm_setzero_si128();
+        for (unsigned char c : distinct_)
+            m = _mm_or_si128(m, bytes_equal_sse2(v, c));
+        return mask_of_sse2(m);
+    }
+    FPLUS_TARGET_AVX2
+    std::uint32_t mask32(const unsigned char* p) const
+    {
+        const __m256i v = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(p));
+        __m256i m = _mm256_setzero_si256();
+        for (unsigned char c : distinct_)
+            m = _mm256_or_si256(m, bytes_equal_avx2(v, c));
+        return mask_of_avx2(m);
+    }
+#endif
+private:
+    std::vector<bool> table_;
+    std::vector<unsigned char> distinct_;
+};
+
+template <typename ByteClass>
+bool byte_class_vectorizable(const ByteClass&)
+{
+    return true;
+}
+
+inline bool byte_class_vectorizable(const one_of_bytes& bytes)
+{
+    return bytes.vectorizable();
+}
+
+template <typename ByteClass, typename F>
+void for_each_byte_in_class_scalar(const unsigned char* p, std::size_t n,
+    std::size_t i, const ByteClass& bytes, F& f)
+{
+    for (; i < n; ++i)
+        if (bytes(p[i]))
+            f(i);
+}
+
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+
+inline std::size_t lowest_bit(std::uint32_t mask)
+{
+    return static_cast<std::size_t>(__builtin_ctz(mask));
+}
+
+inline std::size_t highest_bit(std::uint32_t mask)
+{
+    return static_cast<std::size_t>(31 - __builtin_clz(mask));
+}
+
+template <typename ByteClass, typename F>
+void for_each_byte_in_class_sse2(const unsigned char* p, std::size_t n,
+    const ByteClass& bytes, F& f)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (std::uint32_t m = bytes.mask16(p + i); m != 0; m &= m - 1)
+            f(i + lowest_bit(m));
+    for_each_byte_in_class_scalar(p, n, i, bytes, f);
+}
+
+template <typename ByteClass, typename F>
+FPLUS_TARGET_AVX2
+void for_each_byte_in_class_avx2(const unsigned char* p, std::size_t n,
+    const ByteClass& bytes, F& f)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+        for (std::uint32_t m = bytes.mask32(p + i); m != 0; m &= m - 1)
+            f(i + lowest_bit(m));
+    for_each_byte_in_class_scalar(p, n, i, bytes, f);
+}
+
+template <typename ByteClass>
+std::size_t find_first_byte_in_class_sse2(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const std::uint32_t m = bytes.mask16(p + i);
+        if (m != 0)
+            return i + lowest_bit(m);
+    }
+    while (i < n && !bytes(p[i]))
+        ++i;
+    return i;
+}
+
+template <typename ByteClass>
+FPLUS_TARGET_AVX2
+std::size_t find_first_byte_in_class_avx2(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const std::uint32_t m = bytes.mask32(p + i);
+        if (m != 0)
+            return i + lowest_bit(m);
+    }
+    while (i < n && !bytes(p[i]))
+        ++i;
+    return i;
+}
+
+template <typename ByteClass>
+std::size_t find_first_byte_not_in_class_sse2(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const std::uint32_t m = ~bytes.mask16(p + i) & 0xFFFFu;
+        if (m != 0)
+            return i + lowest_bit(m);
+    }
+    while (i < n && bytes(p[i]))
+        ++i;
+    return i;
+}
+
+template <typename ByteClass>
+FPLUS_TARGET_AVX2
+std::size_t find_first_byte_not_in_class_avx2(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        const std::uint32_t m = ~bytes.mask32(p + i);
+        if (m != 0)
+            return i + lowest_bit(m);
+    }
+    while (i < n && bytes(p[i]))
+        ++i;
+    return i;
+}
+
+template <typename ByteClass>
+std::size_t find_end_of_bytes_not_in_class_sse2(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+    std::size_t i = n;
+    for (; i >= 16; i -= 16)
+    {
+        const std::uint32_t m = ~bytes.mask16(p + i - 16) & 0xFFFFu;
+        if (m != 0)
+            return i - 16 + highest_bit(m) + 1;
+    }
+    while (i > 0 && bytes(p[i - 1]))
+        --i;
+    return i;
+}
+
+template <typename ByteClass>
+FPLUS_TARGET_AVX2
+std::size_t find_end_of_bytes_not_in_class_avx2(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+    std::size_t i = n;
+    for (; i >= 32; i -= 32)
+    {
+        const std::uint32_t m = ~bytes.mask32(p + i - 32);
+        if (m != 0)
+            return i - 32 + highest_bit(m) + 1;
+    }
+    while (i > 0 && bytes(p[i - 1]))
+        --i;
+    return i;
+}
+
+#endif
+
+// Calls f(idx) for every idx in ascending order with p[idx] in the class.
+template <typename ByteClass, typename F>
+void for_each_byte_in_class(const unsigned char* p, std::size_t n,
+    const ByteClass& bytes, F f)
+{
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    if (byte_class_vectorizable(bytes))
+    {
+        switch (active_char_kernel_isa())
+        {
+            case char_kernel_isa::avx2:
+                for_each_byte_in_class_avx2(p, n, bytes, f);
+                return;
+            case char_kernel_isa::sse2:
+                for_each_byte_in_class_sse2(p, n, bytes, f);
+                return;
+            case char_kernel_isa::scalar:
+                break;
+        }
+    }
+#endif
+    for_each_byte_in_class_scalar(p, n, 0, bytes, f);
+}
+
+// Index of the first byte in the class, or n.
+template <typename ByteClass>
+std::size_t find_first_byte_in_class(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    if (byte_class_vectorizable(bytes))
+    {
+        switch (active_char_kernel_isa())
+        {
+            case char_kernel_isa::avx2:
+                return find_first_byte_in_class_avx2(p, n, bytes);
+            case char_kernel_isa::sse2:
+                return find_first_byte_in_class_sse2(p, n, bytes);
+            case char_kernel_isa::scalar:
+                break;
+        }
+    }
+#endif
+    std::size_t i = 0;
+    while (i < n && !bytes(p[i]))
+        ++i;
+    return i;
+}
+
+// Index of the first byte not in the class, or n.
+template <typename ByteClass>
+std::size_t find_first_byte_not_in_class(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    switch (active_char_kernel_isa())
+    {
+        case char_kernel_isa::avx2:
+            return find_first_byte_not_in_class_avx2(p, n, bytes);
+        case char_kernel_isa::sse2:
+            return find_first_byte_not_in_class_sse2(p, n, bytes);
+        case char_kernel_isa::scalar:
+            break;
+    }
+#endif
+    std::size_t i = 0;
+    while (i < n && bytes(p[i]))
+        ++i;
+    return i;
+}
+
+// One behind the index of the last byte not in the class, or 0.
+template <typename ByteClass>
+std::size_t find_end_of_bytes_not_in_class(const unsigned char* p,
+    std::size_t n, const ByteClass& bytes)
+{
+#ifdef FPLUS_CHAR_KERNELS_SSE2
+    switch (active_char_kernel_isa())
+    {
+        case char_kernel_isa::avx2:
+            return find_end_of_bytes_not_in_class_avx2(p, n, bytes);
+        case char_kernel_isa::sse2:
+            return find_end_of_bytes_not_in_class_sse2(p, n, bytes);
+        case char_kernel_isa::scalar:
+            break;
+    }
+#endif
+    std::size_t i = n;
+    while (i > 0 && bytes(p[i - 1]))
+        --i;
+    return i;
+}
+
+} // namespace internal
+
+} // namespace fplus
@@ -62,6 +62,152 @@ void check_compare_preprocessors_for_types()
     static_assert(std::is_same<typename utils::function_traits<F>::result_type, typename utils::function_traits<G>::result_type>::value, "Both functions must return same type.");
 }
 
+// The functions below return the following function objects
+// instead of std::function, so calls through them can be inlined.
+// Each has exactly one operator() and thus works with utils::function_traits.
+namespace internal
+{
+
+struct equal_op
+{
+    template <typename T>
+    bool operator()(const T& x, const T& y) const { return x == y; }
+};
+
+struct not_equal_op
+{
+    template <typename T>
+    bool operator()(const T& x, const T& y) const { return x != y; }
+};
+
+struct less_op
+{
+    template <typename T>
+    bool operator()(const T& x, const T& y) const { return x < y; }
+};
+
+struct less_or_equal_op
+{
+    template <typename T>
+    bool operator()(const T& x, const T& y) const { return x <= y; }
+};
+
+struct greater_op
+{
+    template <typename T>
+    bool operator()(const T& x, const T& y) const { return x > y; }
+};
+
+struct greater_or_equal_op
+{
+    template <typename T>
+    bool operator()(const T& x, const T& y) const { return x >= y; }
+};
+
+// op(f(x), g(y))
+template <typename Op, typename F, typename G, typename FIn, typename GIn>
+class compared_by_and_by
+{
+public:
+    compared_by_and_by(F f, G g) : f_(f), g_(g) {}
+    bool operator()(const FIn& x, const GIn& y) const
+    {
+        return Op()(f_(x), g_(y));
+    }
+private:
+    F f_;
+    G g_;
+};
+
+// op(f(y), x)
+template <typename Op, typename F, typename X, typename Y>
+class compared_by_to
+{
+public:
+    compared_by_to(F f, const X& x) : f_(f), x_(x) {}
+    bool operator()(const Y& y) const { return Op()(f_(y), x_); }
+private:
+    F f_;
+    X x_;
+};
+
+// op(y, x)
+template <typename Op, typename X>
+class compared_to
+{
+public:
+    explicit compared_to(const X& x) : x_(x) {}
+    bool operator()(const X& y) const { return Op()(y, x_); }
+private:
+    X x_;
+};
+
+template <typename Y, typename X>
+class constant
+{
+public:
+    explicit constant(const X& x) : x_(x) {}
+    X operator()(const Y&) const { return x_; }
+private:
+    X x_;
+};
+
+template <typename Compare, typename FIn0, typename FIn1>
+class ord_to_eq_of
+{
+public:
+    explicit ord_to_eq_of(Compare comp) : comp_(comp) {}
+    bool operator()(FIn0 x, FIn1 y) const
+    {
+        return !comp_(x, y) && !comp_(y, x);
+    }
+private:
+    Compare comp_;
+};
+
+template <typename Compare, typename FIn0, typename FIn1>
+class ord_to_not_eq_of
+{
+public:
+    explicit ord_to_not_eq_of(Compare comp) : comp_(comp) {}
+    bool operator()(FIn0 x, FIn1 y) const
+    {
+        return comp_(x, y) || comp_(y, x);
+    }
+private:
+    Compare comp_;
+};
+
+template <typename Compare, typename FIn0, typename FIn1>
+class ord_eq_to_eq_of
+{
+public:
+    explicit ord_eq_to_eq_of(Compare comp) : comp_(comp) {}
+    bool operator()(FIn0 x, FIn1 y) const
+    {
+        return comp_(x, y) && comp_(y, x);
+    }
+private:
+    Compare comp_;
+};
+
+template <typename Compare, typename FIn0, typename FIn1>
+class ord_eq_to_not_eq_of
+{
+public:
+    explicit ord_eq_to_not_eq_of(Compare comp) : comp_(comp) {}
+    bool operator()(FIn0 x, FIn1 y) const
+    {
+        bool a = comp_(x, y);
+        bool b = comp_(y, x);
+        return (a && !b) || (!a && b);
+    }
+private:
+    Compare comp_;
+};
+
+} // namespace internal
+
 // identity(x) == x
 template <typename T>
 T identity(const T& x)
@@ -79,32 +225,26 @@ bool is_equal(const T& x, const T& y)
 
 // always(x, y) == x
 template <typename Y, typename X>
-std::function<X(const Y&)> always(const X& x)
+internal::constant<Y, X> always(const X& x)
 {
-    return [x](const Y&) { return x; };
+    return internal::constant<Y, X>(x);
 }
 
 // f(x) == g(y)
 template <typename F, typename G,
     typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<bool(const FIn& x, const GIn& y)>
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type>
+internal::compared_by_and_by<internal::equal_op, F, G, FIn, GIn>
         is_equal_by_and_by(F f, G g)
 {
     check_compare_preprocessors_for_types<F, G, FIn, GIn>();
-    return [f, g](const FIn& x, const GIn& y)
-    {
-        return is_equal(f(x), g(y));
-    };
+    return internal::compared_by_and_by<internal::equal_op, F, G, FIn, GIn>(f, g);
 }
 
 // f(x) == f(y)
 template <typename F,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type>
-std::function<bool(const FIn& x, const FIn& y)>
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type>
+internal::compared_by_and_by<internal::equal_op, F, F, FIn, FIn>
         is_equal_by(F f)
 {
     return is_equal_by_and_by(f, f);
@@ -113,19 +253,17 @@ std::function<bool(const FIn& x, const FIn& y)>
 // f(y) == x
 template <typename F, typename X,
     typename Y = typename utils::function_traits<F>::template arg<0>::type>
-std::function<bool(const Y&)> is_equal_by_to(F f, const X& x)
+internal::compared_by_to<internal::equal_op, F, X, Y>
+        is_equal_by_to(F f, const X& x)
 {
-    return [f, x](const Y& y)
-    {
-        return is_equal(f(y), x);
-    };
+    return internal::compared_by_to<internal::equal_op, F, X, Y>(f, x);
 }
 
-// x == y
+// y == x
 template <typename X>
-std::function<bool(const X&)> is_equal_to(const X& x)
+internal::compared_to<internal::equal_op, X> is_equal_to(const X& x)
 {
-    return is_equal_by_to(identity<X>, x);
+    return internal::compared_to<internal::equal_op, X>(x);
 }
 
 // x != y
@@ -138,24 +276,18 @@ bool is_not_equal(const T& x, const T& y)
 // f(x) != g(y)
 template <typename F, typename G,
     typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<bool(const FIn& x, const GIn& y)>
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type>
+internal::compared_by_and_by<internal::not_equal_op, F, G, FIn, GIn>
         is_not_equal_by_and_by(F f, G g)
 {
     check_compare_preprocessors_for_types<F, G, FIn, GIn>();
-    return [f, g](const FIn& x, const GIn& y)
-    {
-        return is_not_equal(f(x), g(y));
-    };
+    return internal::compared_by_and_by<internal::not_equal_op, F, G, FIn, GIn>(f, g);
 }
 
 // f(x) != f(y)
 template <typename F,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type>
-std::function<bool(const FIn& x, const FIn& y)>
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type>
+internal::compared_by_and_by<internal::not_equal_op, F, F, FIn, FIn>
         is_not_equal_by(F f)
 {
     return is_not_equal_by_and_by(f, f);
@@ -164,22 +296,19 @@ std::function<bool(const FIn& x, const FIn& y)>
 // f(y) != x
 template <typename F, typename X,
     typename Y = typename utils::function_traits<F>::template arg<0>::type>
-std::function<bool(const Y&)> is_not_equal_by_to(F f, const X& x)
+internal::compared_by_to<internal::not_equal_op, F, X, Y>
+        is_not_equal_by_to(F f, const X& x)
 {
-    return [f, x](const Y& y)
-    {
-        return is_not_equal(f(y), x);
-    };
+    return internal::compared_by_to<internal::not_equal_op, F, X, Y>(f, x);
 }
 
 // y != x
 template <typename X>
-std::function<bool(const X&)> is_not_equal_to(const X& x)
+internal::compared_to<internal::not_equal_op, X> is_not_equal_to(const X& x)
 {
-    return is_not_equal_by_to(identity<X>, x);
+    return internal::compared_to<internal::not_equal_op, X>(x);
 }
 
-
 // x < y
 template <typename T>
 bool is_less(const T& x, const T& y)
@@ -187,28 +316,21 @@ bool is_less(const T& x, const T& y)
     return x < y;
 }
 
-
 // f(x) < g(y)
 template <typename F, typename G,
     typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<bool(const FIn& x, const GIn& y)>
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type>
+internal::compared_by_and_by<internal::less_op, F, G, FIn, GIn>
         is_less_by_and_by(F f, G g)
 {
     check_compare_preprocessors_for_types<F, G, FIn, GIn>();
-    return [f, g](const FIn& x, const GIn& y)
-    {
-        return is_less(f(x), g(y));
-    };
+    return internal::compared_by_and_by<internal::less_op, F, G, FIn, GIn>(f, g);
 }
 
 // f(x) < f(y)
 template <typename F,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type>
-std::function<bool(const FIn& x, const FIn& y)>
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type>
+internal::compared_by_and_by<internal::less_op, F, F, FIn, FIn>
         is_less_by(F f)
 {
     return is_less_by_and_by(f, f);
@@ -217,51 +339,41 @@ std::function<bool(const FIn& x, const FIn& y)>
 // f(y) < x
 template <typename F, typename X,
     typename Y = typename utils::function_traits<F>::template arg<0>::type>
-std::function<bool(const Y&)> is_less_by_than(F f, const X& x)
+internal::compared_by_to<internal::less_op, F, X, Y>
+        is_less_by_than(F f, const X& x)
 {
-    return [f, x](const Y& y)
-    {
-        return is_less(f(y), x);
-    };
+    return internal::compared_by_to<internal::less_op, F, X, Y>(f, x);
 }
 
 // y < x
 template <typename X>
-std::function<bool(const X&)> is_less_than(const X& x)
+internal::compared_to<internal::less_op, X> is_less_than(const X& x)
 {
-    return is_less_by_than(identity<X>, x);
+    return internal::compared_to<internal::less_op, X>(x);
 }
 
-
-// x < y
+// x <= y
 template <typename T>
 bool is_less_or_equal(const T& x, const T& y)
 {
     return x <= y;
 }
 
-
 // f(x) <= g(y)
 template <typename F, typename G,
     typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<bool(const FIn& x, const GIn& y)>
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type>
+internal::compared_by_and_by<internal::less_or_equal_op, F, G, FIn, GIn>
         is_less_or_equal_by_and_by(F f, G g)
 {
     check_compare_preprocessors_for_types<F, G, FIn, GIn>();
-    return [f, g](const FIn& x, const GIn& y)
-    {
-        return is_less_or_equal(f(x), g(y));
-    };
+    return internal::compared_by_and_by<internal::less_or_equal_op, F, G, FIn, GIn>(f, g);
 }
 
 // f(x) <= f(y)
 template <typename F,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type>
-std::function<bool(const FIn& x, const FIn& y)>
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type>
+internal::compared_by_and_by<internal::less_or_equal_op, F, F, FIn, FIn>
         is_less_or_equal_by(F f)
 {
     return is_less_or_equal_by_and_by(f, f);
@@ -270,22 +382,19 @@ std::function<bool(const FIn& x, const FIn& y)>
 // f(y) <= x
 template <typename F, typename X,
     typename Y = typename utils::function_traits<F>::template arg<0>::type>
-std::function<bool(const Y&)> is_less_or_equal_by_than(F f, const X& x)
+internal::compared_by_to<internal::less_or_equal_op, F, X, Y>
+        is_less_or_equal_by_than(F f, const X& x)
 {
-    return [f, x](const Y& y)
-    {
-        return is_less_or_equal(f(y), x);
-    };
+    return internal::compared_by_to<internal::less_or_equal_op, F, X, Y>(f, x);
 }
 
 // y <= x
 template <typename X>
-std::function<bool(const X&)> is_less_or_equal_than(const X& x)
+internal::compared_to<internal::less_or_equal_op, X> is_less_or_equal_than(const X& x)
 {
-    return is_less_or_equal_by_than(identity<X>, x);
+    return internal::compared_to<internal::less_or_equal_op, X>(x);
 }
 
-
 // x > y
 template <typename T>
 bool is_greater(const T& x, const T& y)
@@ -293,28 +402,21 @@ bool is_greater(const T& x, const T& y)
     return x > y;
 }
 
-
 // f(x) > g(y)
 template <typename F, typename G,
     typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<bool(const FIn& x, const GIn& y)>
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type>
+internal::compared_by_and_by<internal::greater_op, F, G, FIn, GIn>
         is_greater_by_and_by(F f, G g)
 {
     check_compare_preprocessors_for_types<F, G, FIn, GIn>();
-    return [f, g](const FIn& x, const GIn& y)
-    {
-        return is_greater(f(x), g(y));
-    };
+    return internal::compared_by_and_by<internal::greater_op, F, G, FIn, GIn>(f, g);
 }
 
 // f(x) > f(y)
 template <typename F,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type>
-std::function<bool(const FIn& x, const FIn& y)>
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type>
+internal::compared_by_and_by<internal::greater_op, F, F, FIn, FIn>
         is_greater_by(F f)
 {
     return is_greater_by_and_by(f, f);
@@ -323,19 +425,17 @@ std::function<bool(const FIn& x, const FIn& y)>
 // f(y) > x
 template <typename F, typename X,
     typename Y = typename utils::function_traits<F>::template arg<0>::type>
-std::function<bool(const Y&)> is_greater_by_than(F f, const X& x)
+internal::compared_by_to<internal::greater_op, F, X, Y>
+        is_greater_by_than(F f, const X& x)
 {
-    return [f, x](const Y& y)
-    {
-        return is_greater(f(y), x);
-    };
+    return internal::compared_by_to<internal::greater_op, F, X, Y>(f, x);
 }
 
 // y > x
 template <typename X>
-std::function<bool(const X&)> is_greater_than(const X& x)
+internal::compared_to<internal::greater_op, X> is_greater_than(const X& x)
 {
-    return is_greater_by_than(identity<X>, x);
+    return internal::compared_to<internal::greater_op, X>(x);
 }
 
 // x >= y
@@ -345,28 +445,21 @@ bool is_greater_or_equal(const T& x, const T& y)
     return x >= y;
 }
 
-
 // f(x) >= g(y)
 template <typename F, typename G,
     typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<bool(const FIn& x, const GIn& y)>
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type>
+internal::compared_by_and_by<internal::greater_or_equal_op, F, G, FIn, GIn>
         is_greater_or_equal_by_and_by(F f, G g)
 {
     check_compare_preprocessors_for_types<F, G, FIn, GIn>();
-    return [f, g](const FIn& x, const GIn& y)
-    {
-        return is_greater_or_equal(f(x), g(y));
-    };
+    return internal::compared_by_and_by<internal::greater_or_equal_op, F, G, FIn, GIn>(f, g);
 }
 
 // f(x) >= f(y)
 template <typename F,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type>
-std::function<bool(const FIn& x, const FIn& y)>
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type>
+internal::compared_by_and_by<internal::greater_or_equal_op, F, F, FIn, FIn>
         is_greater_or_equal_by(F f)
 {
     return is_greater_or_equal_by_and_by(f, f);
@@ -375,19 +468,17 @@ std::function<bool(const FIn& x, const FIn& y)>
 // f(y) >= x
 template <typename F, typename X,
     typename Y = typename utils::function_traits<F>::template arg<0>::type>
-std::function<bool(const Y&)> is_greater_or_equal_by_than(F f, const X& x)
+internal::compared_by_to<internal::greater_or_equal_op, F, X, Y>
+        is_greater_or_equal_by_than(F f, const X& x)
 {
-    return [f, x](const Y& y)
-    {
-        return is_greater_or_equal(f(y), x);
-    };
+    return internal::compared_by_to<internal::greater_or_equal_op, F, X, Y>(f, x);
 }
 
 // y >= x
 template <typename X>
-std::function<bool(const X&)> is_greater_or_equal_than(const X& x)
+internal::compared_to<internal::greater_or_equal_op, X> is_greater_or_equal_than(const X& x)
 {
-    return is_greater_or_equal_by_than(identity<X>, x);
+    return internal::compared_to<internal::greater_or_equal_op, X>(x);
 }
 
 
@@ -403,14 +494,12 @@ template <typename Compare,
     typename FIn0 = typename utils::function_traits<Compare>::template arg<0>::type,
     typename FIn1 = typename utils::function_traits<Compare>::template arg<1>::type,
     typename FOut = typename utils::function_traits<Compare>::result_type>
-std::function<FOut(FIn0, FIn1)> ord_to_eq(Compare comp)
+internal::ord_to_eq_of<Compare, FIn0, FIn1> ord_to_eq(Compare comp)
 {
     static_assert(utils::function_traits<Compare>::arity == 2, "Wrong arity.");
     static_assert(std::is_same<FOut, bool>::value, "Function must return bool.");
     static_assert(std::is_same<FIn0, FIn1>::value, "Function must take two equal types.");
-    return [comp]
-           (FIn0 x, FIn1 y)
-           { return !comp(x, y) && !comp(y, x); };
+    return internal::ord_to_eq_of<Compare, FIn0, FIn1>(comp);
 }
 
 // ord_to_not_eq((<)) == (!=)
@@ -418,14 +507,12 @@ template <typename Compare,
     typename FIn0 = typename utils::function_traits<Compare>::template arg<0>::type,
     typename FIn1 = typename utils::function_traits<Compare>::template arg<1>::type,
     typename FOut = typename utils::function_traits<Compare>::result_type>
-std::function<FOut(FIn0, FIn1)> ord_to_not_eq(Compare comp)
+internal::ord_to_not_eq_of<Compare, FIn0, FIn1> ord_to_not_eq(Compare comp)
 {
     static_assert(utils::function_traits<Compare>::arity == 2, "Wrong arity.");
     static_assert(std::is_same<FOut, bool>::value, "Function must return bool.");
     static_assert(std::is_same<FIn0, FIn1>::value, "Function must take two equal types.");
-    return [comp]
-           (FIn0 x, FIn1 y)
-           { return comp(x, y) || comp(y, x); };
+    return internal::ord_to_not_eq_of<Compare, FIn0, FIn1>(comp);
 }
 
 // ord_eq_to_eq((<=)) == (==)
@@ -433,14 +520,12 @@ template <typename Compare,
     typename FIn0 = typename utils::function_traits<Compare>::template arg<0>::type,
     typename FIn1 = typename utils::function_traits<Compare>::template arg<1>::type,
     typename FOut = typename utils::function_traits<Compare>::result_type>
-std::function<FOut(FIn0, FIn1)> ord_eq_to_eq(Compare comp)
+internal::ord_eq_to_eq_of<Compare, FIn0, FIn1> ord_eq_to_eq(Compare comp)
 {
     static_assert(utils::function_traits<Compare>::arity == 2, "Wrong arity.");
     static_assert(std::is_same<FOut, bool>::value, "Function must return bool.");
     static_assert(std::is_same<FIn0, FIn1>::value, "Function must take two equal types.");
-    return [comp]
-           (FIn0 x, FIn1 y)
-           { return comp(x, y) && comp(y, x); };
+    return internal::ord_eq_to_eq_of<Compare, FIn0, FIn1>(comp);
 }
 
 // ord_eq_to_not_eq((<=)) == (!=)
@@ -448,18 +533,12 @@ template <typename Compare,
     typename FIn0 = typename utils::function_traits<Compare>::template arg<0>::type,
     typename FIn1 = typename utils::function_traits<Compare>::template arg<1>::type,
     typename FOut = typename utils::function_traits<Compare>::result_type>
-std::function<FOut(FIn0, FIn1)> ord_eq_to_not_eq(Compare comp)
+internal::ord_eq_to_not_eq_of<Compare, FIn0, FIn1> ord_eq_to_not_eq(Compare comp)
 {
     static_assert(utils::function_traits<Compare>::arity == 2, "Wrong arity.");
     static_assert(std::is_same<FOut, bool>::value, "Function must return bool.");
     static_assert(std::is_same<FIn0, FIn1>::value, "Function must take two equal types.");
-    return [comp]
-           (FIn0 x, FIn1 y)
-           {
-                bool a = comp(x, y);
-                bool b = comp(y, x);
-                return (a && !b) || (!a && b);
-           };
+    return internal::ord_eq_to_not_eq_of<Compare, FIn0, FIn1>(comp);
 }
 
 } // namespace fplus
@@ -15,18 +15,169 @@
 namespace fplus
 {
 
+// The functions below return the following function objects
+// instead of std::function, so calls through them can be inlined.
+// Each has exactly one operator() and thus works with utils::function_traits.
+namespace internal
+{
+
+template <typename F, typename X, typename FIn1, typename FOut>
+class bound_1st_of_2
+{
+public:
+    bound_1st_of_2(F f, X x) : f_(f), x_(x) {}
+    FOut operator()(FIn1 y) const { return f_(x_, y); }
+private:
+    F f_;
+    X x_;
+};
+
+template <typename F, typename X, typename FIn1, typename FIn2, typename FOut>
+class bound_1st_of_3
+{
+public:
+    bound_1st_of_3(F f, X x) : f_(f), x_(x) {}
+    FOut operator()(FIn1 y, FIn2 z) const { return f_(x_, y, z); }
+private:
+    F f_;
+    X x_;
+};
+
+template <typename F, typename X, typename Y, typename FIn2, typename FOut>
+class bound_1st_and_2nd_of_3
+{
+public:
+    bound_1st_and_2nd_of_3(F f, X x, Y y) : f_(f), x_(x), y_(y) {}
+    FOut operator()(FIn2 z) const { return f_(x_, y_, z); }
+private:
+    F f_;
+    X x_;
+    Y y_;
+};
+
+template <typename F, typename A, typename B, typename C>
+class flipped
+{
+public:
+    explicit flipped(F f) : f_(f) {}
+    C operator()(B y, A x) const { return f_(x, y); }
+private:
+    F f_;
+};
+
+template <typename F, typename FIn0, typename FIn1, typename FOut>
+class applied_to_pair
+{
+public:
+    explicit applied_to_pair(F f) : f_(f) {}
+    FOut operator()(const std::pair<FIn0, FIn1>& pair) const
+    {
+        return f_(pair.first, pair.second);
+    }
+private:
+    F f_;
+};
+
+template <typename F, typename G,
+    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
+    typename FOut = typename utils::function_traits<F>::result_type,
+    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
+    typename GOut = typename utils::function_traits<G>::result_type>
+class composed
+{
+public:
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    static_assert(utils::function_traits<G>::arity == 1, "Wrong arity.");
+    static_assert(std::is_convertible<FOut,GIn>::value, "Parameter types do not match");
+    composed(F f, G g) : f_(f), g_(g) {}
+    GOut operator()(FIn x) const { return g_(f_(x)); }
+private:
+    F f_;
+    G g_;
+};
+
+// Folds the functions from the left into nested composed objects.
+template <typename... Fs>
+struct composition;
+
+template <typename F>
+struct composition<F>
+{
+    typedef F type;
+    static type make(F f) { return f; }
+};
+
+template <typename F, typename G, typename... Fs>
+struct composition<F, G, Fs...>
+{
+    typedef composition<composed<F, G>, Fs...> rest;
+    typedef typename rest::type type;
+    static type make(F f, G g, Fs... fs)
+    {
+        return rest::make(composed<F, G>(f, g), fs...);
+    }
+};
+
+template <typename UnaryPredicate, typename X>
+class logical_not_of
+{
+public:
+    explicit logical_not_of(UnaryPredicate f) : f_(f) {}
+    bool operator()(X x) const { return !f_(x); }
+private:
+    UnaryPredicate f_;
+};
+
+template <typename UnaryPredicateF, typename UnaryPredicateG, typename X>
+class logical_or_of
+{
+public:
+    logical_or_of(UnaryPredicateF f, UnaryPredicateG g) : f_(f), g_(g) {}
+    bool operator()(X x) const { return f_(x) || g_(x); }
+private:
+    UnaryPredicateF f_;
+    UnaryPredicateG g_;
+};
+
+template <typename UnaryPredicateF, typename UnaryPredicateG, typename X>
+class logical_and_of
+{
+public:
+    logical_and_of(UnaryPredicateF f, UnaryPredicateG g) : f_(f), g_(g) {}
+    bool operator()(X x) const { return f_(x) && g_(x); }
+private:
+    UnaryPredicateF f_;
+    UnaryPredicateG g_;
+};
+
+template <typename UnaryPredicateF, typename UnaryPredicateG, typename X>
+class logical_xor_of
+{
+public:
+    logical_xor_of(UnaryPredicateF f, UnaryPredicateG g) : f_(f), g_(g) {}
+    bool operator()(X x) const
+    {
+        bool fx = f_(x);
+        bool gx = g_(x);
+        return fx != gx;
+    }
+private:
+    UnaryPredicateF f_;
+    UnaryPredicateG g_;
+};
+
+} // namespace internal
+
 // bind_1st_of_2 : (a -> b -> c) -> a -> (b -> c)
 template <typename F, typename T,
     typename FIn0 = typename utils::function_traits<F>::template arg<0>::type,
     typename FIn1 = typename utils::function_traits<F>::template arg<1>::type,
     typename FOut = typename utils::function_traits<F>::result_type>
-std::function<FOut(FIn1)> bind_1st_of_2(F f, T x)
+internal::bound_1st_of_2<F, T, FIn1, FOut> bind_1st_of_2(F f, T x)
 {
     static_assert(utils::function_traits<F>::arity == 2, "Wrong arity.");
     static_assert(std::is_convertible<T, FIn0>::value, "Function can not take bound parameter type.");
-    return [f, x]
-           (FIn1 y)
-           { return f(x, y); };
+    return internal::bound_1st_of_2<F, T, FIn1, FOut>(f, x);
 }
 
 // bind_1st_of_3 : (a -> b -> c -> d) -> a -> (b -> c -> d)
@@ -35,13 +186,11 @@ template <typename F, typename X,
     typename FIn1 = typename utils::function_traits<F>::template arg<1>::type,
     typename FIn2 = typename utils::function_traits<F>::template arg<2>::type,
     typename FOut = typename utils::function_traits<F>::result_type>
-std::function<FOut(FIn1, FIn2)> bind_1st_of_3(F f, X x)
+internal::bound_1st_of_3<F, X, FIn1, FIn2, FOut> bind_1st_of_3(F f, X x)
 {
     static_assert(utils::function_traits<F>::arity == 3, "Wrong arity.");
     static_assert(std::is_convertible<X, FIn0>::value, "Function can not take bound parameter type.");
-    return [f, x]
-           (FIn1 y, FIn2 z)
-           { return f(x, y, z); };
+    return internal::bound_1st_of_3<F, X, FIn1, FIn2, FOut>(f, x);
 }
 
 // bind_1st_and_2nd_of_3 : (a -> b -> c -> d) -> a -> b -> (c -> d)
@@ -50,14 +199,13 @@ template <typename F, typename X, typename Y,
     typename FIn1 = typename utils::function_traits<F>::template arg<1>::type,
     typename FIn2 = typename utils::function_traits<F>::template arg<2>::type,
     typename FOut = typename utils::function_traits<F>::result_type>
-std::function<FOut(FIn2)> bind_1st_and_2nd_of_3(F f, X x, Y y)
+internal::bound_1st_and_2nd_of_3<F, X, Y, FIn2, FOut>
+bind_1st_and_2nd_of_3(F f, X x, Y y)
 {
     static_assert(utils::function_traits<F>::arity == 3, "Wrong arity.");
     static_assert(std::is_convertible<X, FIn0>::value, "Function can not take first bound parameter type.");
     static_assert(std::is_convertible<Y, FIn1>::value, "Function can not take second bound parameter type.");
-    return [f, x, y]
-           (FIn2 z)
-           { return f(x, y, z); };
+    return internal::bound_1st_and_2nd_of_3<F, X, Y, FIn2, FOut>(f, x, y);
 }
 
 // flip : (a -> b) -> (b -> a)
@@ -66,39 +214,30 @@ template <typename F,
     typename A = typename utils::function_traits<F>::template arg<0>::type,
     typename B = typename utils::function_traits<F>::template arg<1>::type,
     typename C = typename utils::function_traits<F>::result_type>
-std::function<C(B, A)> flip(F f)
+internal::flipped<F, A, B, C> flip(F f)
 {
     static_assert(utils::function_traits<F>::arity == 2, "Wrong arity.");
-    return [f](B y, A x) { return f(x, y); };
+    return internal::flipped<F, A, B, C>(f);
 }
 
 // apply_to_pair : (a -> b -> c) -> (a, b) -> c
 template <typename F,
     typename FIn0 = typename utils::function_traits<F>::template arg<0>::type,
     typename FIn1 = typename utils::function_traits<F>::template arg<1>::type,
-    typename FuncRes = typename utils::function_traits<F>::result_type,
-    typename ResFunc = typename std::function<FuncRes(const std::pair<FIn0, FIn1>&)>>
-ResFunc apply_to_pair(F f)
+    typename FuncRes = typename utils::function_traits<F>::result_type>
+internal::applied_to_pair<F, FIn0, FIn1, FuncRes> apply_to_pair(F f)
 {
     static_assert(utils::function_traits<F>::arity == 2, "Wrong arity.");
-    return [f](const std::pair<FIn0, FIn1>& pair)
-    {
-        return f(pair.first, pair.second);
-    };
+    return internal::applied_to_pair<F, FIn0, FIn1, FuncRes>(f);
 }
 
 // Forward composition: compose(f, g)(x) = g(f(x))
-template <typename F, typename G,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename GOut = typename utils::function_traits<G>::result_type>
-std::function<GOut(FIn)> compose(F f, G g)
+// compose(f, g, h)(x) = h(g(f(x))), and so on for any number of functions.
+template <typename F, typename G, typename... Fs>
+typename internal::composition<F, G, Fs...>::type
+compose(F f, G g, Fs... fs)
 {
-    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<G>::arity == 1, "Wrong arity.");
-    static_assert(std::is_convertible<FOut,GIn>::value, "Parameter types do not match");
-    return [f, g](FIn x) { return g(f(x)); };
+    return internal::composition<F, G, Fs...>::make(f, g, fs...);
 }
 
 template <typename X, typename F,
@@ -109,88 +248,23 @@ FOut forward_apply(const X& x, F f)
     return f(x);
 }
 
-// Forward composition: compose(f, g, h)(x) = h(g(f(x)))
-template <typename F, typename G, typename H,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename GOut = typename utils::function_traits<G>::result_type,
-    typename HIn = typename utils::function_traits<H>::template arg<0>::type,
-    typename HOut = typename utils::function_traits<H>::result_type>
-std::function<HOut(FIn)> compose(F f, G g, H h)
-{
-    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<G>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<H>::arity == 1, "Wrong arity.");
-    static_assert(std::is_convertible<FOut,GIn>::value, "Parameter types do not match");
-    static_assert(std::is_convertible<GOut,HIn>::value, "Parameter types do not match");
-    return [f, g, h](FIn x) { return h(g(f(x))); };
-}
-
-// Forward composition: compose(f, g, h, i)(x) = i(h(g(f(x))))
-template <typename F, typename G, typename H, typename I,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename GOut = typename utils::function_traits<G>::result_type,
-    typename HIn = typename utils::function_traits<H>::template arg<0>::type,
-    typename HOut = typename utils::function_traits<H>::result_type,
-    typename IIn = typename utils::function_traits<I>::template arg<0>::type,
-    typename IOut = typename utils::function_traits<I>::result_type>
-std::function<IOut(FIn)> compose(F f, G g, H h, I i)
-{
-    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<G>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<H>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<I>::arity == 1, "Wrong arity.");
-    static_assert(std::is_convertible<FOut,GIn>::value, "Parameter types do not match");
-    static_assert(std::is_convertible<GOut,HIn>::value, "Parameter types do not match");
-    static_assert(std::is_convertible<HOut,IIn>::value, "Parameter types do not match");
-    return [f, g, h, i](FIn x) { return i(h(g(f(x)))); };
-}
-
-// Forward composition: compose(f, g, h, i, j)(x) = j(i(h(g(f(x)))))
-template <typename F, typename G, typename H, typename I, typename J,
-    typename FIn = typename utils::function_traits<F>::template arg<0>::type,
-    typename FOut = typename utils::function_traits<F>::result_type,
-    typename GIn = typename utils::function_traits<G>::template arg<0>::type,
-    typename GOut = typename utils::function_traits<G>::result_type,
-    typename HIn = typename utils::function_traits<H>::template arg<0>::type,
-    typename HOut = typename utils::function_traits<H>::result_type,
-    typename IIn = typename utils::function_traits<I>::template arg<0>::type,
-    typename IOut = typename utils::function_traits<I>::result_type,
-    typename JIn = typename utils::function_traits<I>::template arg<0>::type,
-    typename JOut = typename utils::function_traits<I>::result_type>
-std::function<JOut(FIn)> compose(F f, G g, H h, I i, J j)
-{
-    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<G>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<H>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<I>::arity == 1, "Wrong arity.");
-    static_assert(utils::function_traits<J>::arity == 1, "Wrong arity.");
-    static_assert(std::is_convertible<FOut,GIn>::value, "Parameter types do not match");
-    static_assert(std::is_convertible<GOut,HIn>::value, "Parameter types do not match");
-    static_assert(std::is_convertible<HOut,IIn>::value, "Parameter types do not match");
-    static_assert(std::is_convertible<IOut,JIn>::value, "Parameter types do not match");
-    return [f, g, h, i, j](FIn x) { return j(i(h(g(f(x))))); };
-}
-
 // logical_not(f) = \x -> !x
 template <typename UnaryPredicate,
     typename X = typename utils::function_traits<UnaryPredicate>::template arg<0>::type>
-std::function<bool(X)> logical_not(UnaryPredicate f)
+internal::logical_not_of<UnaryPredicate, X> logical_not(UnaryPredicate f)
 {
     static_assert(utils::function_traits<UnaryPredicate>::arity == 1, "Wrong arity.");
     typedef typename utils::function_traits<UnaryPredicate>::result_type Res;
     static_assert(std::is_same<Res, bool>::value, "Must return bool.");
-    return [f](X x) { return !f(x); };
+    return internal::logical_not_of<UnaryPredicate, X>(f);
 }
 
 // logical_or(f, g) = \x -> f(x) or g(x)
 template <typename UnaryPredicateF, typename UnaryPredicateG,
     typename X = typename utils::function_traits<UnaryPredicateF>::template arg<0>::type,
     typename Y = typename utils::function_traits<UnaryPredicateG>::template arg<0>::type>
-std::function<bool(X)> logical_or(UnaryPredicateF f, UnaryPredicateG g)
+internal::logical_or_of<UnaryPredicateF, UnaryPredicateG, X>
+logical_or(UnaryPredicateF f, UnaryPredicateG g)
 {
     static_assert(std::is_convertible<X, Y>::value, "Parameter types do not match");
     typedef typename utils::function_traits<UnaryPredicateF>::result_type FRes;
@@ -199,14 +273,15 @@ std::function<bool(X)> logical_or(UnaryPredicateF f, UnaryPredicateG g)
     static_assert(std::is_same<GRes, bool>::value, "Must return bool.");
     static_assert(utils::function_traits<UnaryPredicateF>::arity == 1, "Wrong arity.");
     static_assert(utils::function_traits<UnaryPredicateG>::arity == 1, "Wrong arity.");
-    return [f, g](X x) { return f(x) || g(x); };
+    return internal::logical_or_of<UnaryPredicateF, UnaryPredicateG, X>(f, g);
 }
 
 // logical_and(f, g) = \x -> f(x) and g(x)
 template <typename UnaryPredicateF, typename UnaryPredicateG,
     typename X = typename utils::function_traits<UnaryPredicateF>::template arg<0>::type,
     typename Y = typename utils::function_traits<UnaryPredicateG>::template arg<0>::type>
-std::function<bool(X)> logical_and(UnaryPredicateF f, UnaryPredicateG g)
+internal::logical_and_of<UnaryPredicateF, UnaryPredicateG, X>
+logical_and(UnaryPredicateF f, UnaryPredicateG g)
 {
     static_assert(std::is_convertible<X, Y>::value, "Parameter types do not match");
     typedef typename utils::function_traits<UnaryPredicateF>::result_type FRes;
@@ -215,14 +290,15 @@ std::function<bool(X)> logical_and(UnaryPredicateF f, UnaryPredicateG g)
     static_assert(std::is_same<GRes, bool>::value, "Must return bool.");
     static_assert(utils::function_traits<UnaryPredicateF>::arity == 1, "Wrong arity.");
     static_assert(utils::function_traits<UnaryPredicateG>::arity == 1, "Wrong arity.");
-    return [f, g](X x) { return f(x) && g(x); };
+    return internal::logical_and_of<UnaryPredicateF, UnaryPredicateG, X>(f, g);
 }
 
 // logical_xor(f, g) = \x -> f(x) xor g(x)
 template <typename UnaryPredicateF, typename UnaryPredicateG,
     typename X = typename utils::function_traits<UnaryPredicateF>::template arg<0>::type,
     typename Y = typename utils::function_traits<UnaryPredicateG>::template arg<0>::type>
-std::function<bool(X)> logical_xor(UnaryPredicateF f, UnaryPredicateG g)
+internal::logical_xor_of<UnaryPredicateF, UnaryPredicateG, X>
+logical_xor(UnaryPredicateF f, UnaryPredicateG g)
 {
     static_assert(std::is_convertible<X, Y>::value, "Parameter types do not match");
     typedef typename utils::function_traits<UnaryPredicateF>::result_type FRes;
@@ -231,12 +307,7 @@ std::function<bool(X)> logical_xor(UnaryPredicateF f, UnaryPredicateG g)
     static_assert(std::is_same<GRes, bool>::value, "Must return bool.");
     static_assert(utils::function_traits<UnaryPredicateF>::arity == 1, "Wrong arity.");
     static_assert(utils::function_traits<UnaryPredicateG>::arity == 1, "Wrong arity.");
-    return [f, g](X x)
-    {
-        auto fx = f(x);
-        auto gx = g(x);
-        return (fx && !gx) || (!fx && gx);
-    };
+    return internal::logical_xor_of<UnaryPredicateF, UnaryPredicateG, X>(f, g);
 }
 
 } // namespace fplus
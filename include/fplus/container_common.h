@@ -11,8 +11,14 @@
 #include "compare.h"
 
 #include <algorithm>
+#include <bitset>
 #include <cassert>
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
 
 namespace fplus
 {
@@ -44,47 +50,133 @@ void check_binary_predicate_for_container()
         typename Container::value_type>();
 }
 
-// PrepareContainer and BackInserter are overloaded
-// to increase performance on std::vector and std::string
-// by using std::vector<T>::reserve
-// and std::back_inserter instead of std::back_inserter.
-// In VC2015, release mode, Celsius W520 Xeon
-// this leads to an increase in performance of about a factor of 3
-// for Transform.
-template <typename C>
-void prepare_container(const std::basic_string<C, std::char_traits<C>,
-    std::allocator<C>>& ys, std::size_t size)
+namespace internal
 {
-    ys.reserve(size);
-}
 
-template <typename Y>
-void prepare_container(std::vector<Y>& ys, std::size_t size)
+template <typename Container, typename = void>
+struct has_reserve : public std::false_type {};
+template <typename Container>
+struct has_reserve<Container, decltype(void(
+    std::declval<Container&>().reserve(std::size_t())))>
+    : public std::true_type {};
+
+template <typename Container, typename = void>
+struct has_push_back : public std::false_type {};
+template <typename Container>
+struct has_push_back<Container, decltype(void(
+    std::declval<Container&>().push_back(
+        std::declval<const typename Container::value_type&>())))>
+    : public std::true_type {};
+
+template <typename Container, typename = void>
+struct has_emplace_back : public std::false_type {};
+template <typename Container>
+struct has_emplace_back<Container, decltype(void(
+    std::declval<Container&>().emplace_back(
+        std::declval<const typename Container::value_type&>())))>
+    : public std::true_type {};
+
+// Output iterator appending to a container that only has emplace_back.
+template <typename Container>
+class back_emplace_iterator
+{
+public:
+    typedef std::output_iterator_tag iterator_category;
+    typedef void value_type;
+    typedef void difference_type;
+    typedef void pointer;
+    typedef void reference;
+    explicit back_emplace_iterator(Container& ys) : ys_(&ys) {}
+    back_emplace_iterator& operator = (
+        const typename Container::value_type& y)
+    {
+        ys_->emplace_back(y);
+        return *this;
+    }
+    back_emplace_iterator& operator = (typename Container::value_type&& y)
+    {
+        ys_->emplace_back(std::move(y));
+        return *this;
+    }
+    back_emplace_iterator& operator * () { return *this; }
+    back_emplace_iterator& operator ++ () { return *this; }
+    back_emplace_iterator& operator ++ (int) { return *this; }
+private:
+    Container* ys_;
+};
+
+template <typename Container>
+void reserve_if_possible(Container& ys, std::size_t size, std::true_type)
 {
     ys.reserve(size);
 }
 
 template <typename Container>
-void prepare_container(Container&, std::size_t)
+void reserve_if_possible(Container&, std::size_t, std::false_type)
 {
 }
 
-template <typename Container, typename Y>
-std::back_insert_iterator<Container> get_back_inserter(std::string& ys)
+// push_back, emplace_back or insert at the end, in this order of preference.
+template <typename Container,
+    bool = has_push_back<Container>::value,
+    bool = has_emplace_back<Container>::value>
+struct appender
 {
-    return std::back_inserter(ys);
-}
+    typedef std::back_insert_iterator<Container> iterator;
+    static iterator make(Container& ys) { return std::back_inserter(ys); }
+};
 
-template <typename Container, typename Y>
-std::back_insert_iterator<Container> get_back_inserter(std::vector<Y>& ys)
+template <typename Container>
+struct appender<Container, false, true>
 {
-    return std::back_inserter(ys);
+    typedef back_emplace_iterator<Container> iterator;
+    static iterator make(Container& ys) { return iterator(ys); }
+};
+
+template <typename Container>
+struct appender<Container, false, false>
+{
+    typedef std::insert_iterator<Container> iterator;
+    static iterator make(Container& ys)
+    {
+        return std::inserter(ys, std::end(ys));
+    }
+};
+
+} // namespace internal
+
+// Customization point for how the functions fill the containers they return.
+// reserve(ys, n) is called before n elements are appended,
+// and inserter(ys) returns the output iterator appending them.
+// By default reserve is used if the container has it,
+// and appending uses push_back, emplace_back or insert at the end.
+// Specialize this template to adapt containers not fitting these defaults.
+template <typename Container>
+struct container_builder
+{
+    typedef typename internal::appender<Container>::iterator iterator;
+    static void reserve(Container& ys, std::size_t size)
+    {
+        internal::reserve_if_possible(ys, size,
+            internal::has_reserve<Container>());
+    }
+    static iterator inserter(Container& ys)
+    {
+        return internal::appender<Container>::make(ys);
+    }
+};
+
+template <typename Container>
+void prepare_container(Container& ys, std::size_t size)
+{
+    container_builder<Container>::reserve(ys, size);
 }
 
 template <typename Container>
-std::insert_iterator<Container> get_back_inserter(Container& ys)
+typename container_builder<Container>::iterator
+get_back_inserter(Container& ys)
 {
-    return std::inserter(ys, std::end(ys));
+    return container_builder<Container>::inserter(ys);
 }
 
 // is_empty([1, 2]) == false
@@ -176,6 +268,7 @@ Container get_range
     assert(idxBegin <= idxEnd);
     assert(idxEnd <= size_of_cont(xs));
     Container result;
+    prepare_container(result, idxEnd - idxBegin);
     auto itBegin = std::begin(xs);
     std::advance(itBegin, idxBegin);
     auto itEnd = itBegin;
@@ -267,7 +360,7 @@ std::vector<T> elems_at_idxs(const ContainerIdxs& idxs, const Container& xs)
     static_assert(std::is_same<typename ContainerIdxs::value_type, std::size_t>::value, "Indices must be std::size_t");
     ContainerOut result;
     prepare_container(result, size_of_cont(idxs));
-    auto itOut = back_inserter(result);
+    auto itOut = get_back_inserter(result);
     for (std::size_t idx : idxs)
     {
         *itOut = elem_at_idx(idx, xs);
@@ -313,6 +406,21 @@ ContainerOut transform(F f, const ContainerIn& xs)
     return ys;
 }
 
+// Reuses the memory of a temporary container
+// if f does not change the element type.
+// The template parameters are ordered differently than above
+// so that transform<F, ContainerIn> still names a single function.
+template <typename ContainerIn, typename F,
+    typename = enable_if_reusable_container_t<ContainerIn>,
+    typename = typename std::enable_if<std::is_same<ContainerIn,
+        typename same_cont_new_t_from_unary_f<ContainerIn, F>::type>::value>::type>
+ContainerIn transform(F f, ContainerIn&& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    std::transform(std::begin(xs), std::end(xs), std::begin(xs), f);
+    return std::move(xs);
+}
+
 // reverse([0,4,2,6]) == [6,2,4,0]
 template <typename Container>
 Container reverse(const Container& xs)
@@ -324,6 +432,14 @@ Container reverse(const Container& xs)
     return ys;
 }
 
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container reverse(Container&& xs)
+{
+    std::reverse(std::begin(xs), std::end(xs));
+    return std::move(xs);
+}
+
 // take(3, [0,1,2,3,4,5,6,7]) == [0,1,2]
 // take(10, [0,1,2]) == [0,1,2]
 template <typename Container>
@@ -369,7 +485,13 @@ template <typename F, typename Container,
 Acc fold_left_1(F f, const Container& xs)
 {
     assert(!xs.empty());
-    return fold_left(f, xs.front(), drop(1, xs));
+    auto it = std::begin(xs);
+    Acc acc = *it;
+    for (++it; it != std::end(xs); ++it)
+    {
+        acc = f(acc, *it);
+    }
+    return acc;
 }
 
 // fold_right((+), 0, [1, 2, 3]) == 1+(2+(3+0)) == 6
@@ -381,7 +503,12 @@ template <typename F, typename Container,
     typename Acc = typename utils::function_traits<F>::template arg<1>::type>
 Acc fold_right(F f, const Acc& init, const Container& xs)
 {
-    return fold_left(flip(f), init, reverse(xs));
+    Acc acc = init;
+    for (auto it = xs.rbegin(); it != xs.rend(); ++it)
+    {
+        acc = f(*it, acc);
+    }
+    return acc;
 }
 
 // fold_right_1((+), [1, 2, 3]) == 1+(2+3)) == 6
@@ -392,7 +519,14 @@ template <typename F, typename Container,
     typename Acc = typename Container::value_type>
 Acc fold_right_1(F f, const Container& xs)
 {
-    return fold_left_1(flip(f), reverse(xs));
+    assert(!xs.empty());
+    auto it = xs.rbegin();
+    Acc acc = *it;
+    for (++it; it != xs.rend(); ++it)
+    {
+        acc = f(*it, acc);
+    }
+    return acc;
 }
 
 // scan_left((+), 0, [1, 2, 3]) == [0, 1, 3, 6]
@@ -481,6 +615,14 @@ Container append(const Container& xs, const Container& ys)
     return result;
 }
 
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container append(Container&& xs, const Container& ys)
+{
+    xs.insert(std::end(xs), std::begin(ys), std::end(ys));
+    return std::move(xs);
+}
+
 // concat([[1, 2], [], [3]]) == [1, 2, 3]
 // also known as flatten
 template <typename ContainerIn,
@@ -507,6 +649,13 @@ std::list<T> sort_by(Compare comp, const std::list<T>& xs)
     return result;
 }
 
+template <typename Compare, typename T>
+std::list<T> sort_by(Compare comp, std::list<T>&& xs)
+{
+    xs.sort(comp);
+    return std::move(xs);
+}
+
 // sort by given less comparator
 template <typename Compare, typename Container>
 Container sort_by(Compare comp, const Container& xs)
@@ -516,6 +665,14 @@ Container sort_by(Compare comp, const Container& xs)
     return result;
 }
 
+template <typename Compare, typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container sort_by(Compare comp, Container&& xs)
+{
+    std::sort(std::begin(xs), std::end(xs), comp);
+    return std::move(xs);
+}
+
 // sort by std::less
 template <typename Container>
 Container sort(const Container& xs)
@@ -524,6 +681,14 @@ Container sort(const Container& xs)
     return sort_by(std::less<T>(), xs);
 }
 
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container sort(Container&& xs)
+{
+    typedef typename Container::value_type T;
+    return sort_by(std::less<T>(), std::move(xs));
+}
+
 // Like unique but with user supplied equality predicate.
 template <typename Container, typename BinaryPredicate>
 Container unique_by(BinaryPredicate p, const Container& xs)
@@ -535,6 +700,15 @@ Container unique_by(BinaryPredicate p, const Container& xs)
     return result;
 }
 
+template <typename Container, typename BinaryPredicate,
+    typename = enable_if_reusable_container_t<Container>>
+Container unique_by(BinaryPredicate p, Container&& xs)
+{
+    check_binary_predicate_for_container<BinaryPredicate, Container>();
+    xs.erase(std::unique(std::begin(xs), std::end(xs), p), std::end(xs));
+    return std::move(xs);
+}
+
 // unique([1,2,2,3,2]) == [1,2,3,2]
 template <typename Container>
 Container unique(const Container& xs)
@@ -545,6 +719,14 @@ Container unique(const Container& xs)
     return result;
 }
 
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container unique(Container&& xs)
+{
+    xs.erase(std::unique(std::begin(xs), std::end(xs)), std::end(xs));
+    return std::move(xs);
+}
+
 // intersperse(0, [1, 2, 3]) == [1, 0, 2, 0, 3]
 template <typename Container,
     typename X = typename Container::value_type>
@@ -590,6 +772,7 @@ bool is_elem_of(const typename Container::value_type& x, const Container& xs)
 }
 
 // nub_by((==), [1,2,2,3,2]) == [1,2,3]
+// O(n^2)
 template <typename Container, typename BinaryPredicate>
 Container nub_by(BinaryPredicate p, const Container& xs)
 {
@@ -606,12 +789,142 @@ Container nub_by(BinaryPredicate p, const Container& xs)
     return result;
 }
 
+namespace internal
+{
+
+// Integral types of up to 16 bits fit into a bitmap.
+template <typename T>
+struct is_small_integral : std::integral_constant<bool,
+    std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+    sizeof(T) <= 2> {};
+
+template <typename T>
+struct is_hashable_helper
+{
+    template <typename U, typename = decltype(
+        std::declval<const std::hash<U>&>()(std::declval<const U&>()))>
+    static std::true_type test(int);
+    template <typename U>
+    static std::false_type test(...);
+    typedef decltype(test<T>(0)) type;
+};
+
+template <typename T>
+struct is_hashable : std::integral_constant<bool,
+    is_hashable_helper<T>::type::value &&
+    std::is_default_constructible<std::hash<T>>::value> {};
+
+// Remembers which values have been seen.
+// insert returns true if x has not been seen before.
+template <typename T, bool Dense = is_small_integral<T>::value>
+class seen_set
+{
+public:
+    bool insert(const T& x) { return set_.insert(x).second; }
+private:
+    std::unordered_set<T> set_;
+};
+
+template <typename T>
+class seen_set<T, true>
+{
+public:
+    bool insert(T x)
+    {
+        const std::size_t idx = static_cast<
+            typename std::make_unsigned<T>::type>(x);
+        if (bits_[idx])
+            return false;
+        bits_[idx] = true;
+        return true;
+    }
+private:
+    std::bitset<std::size_t(1) << (8 * sizeof(T))> bits_;
+};
+
+// Up to this size the quadratic algorithms beat hashing.
+inline std::size_t max_nub_size_for_quadratic()
+{
+    return 16;
+}
+
+} // namespace internal
+
+// Keeps the first element of every key.
+// nub_on((mod 3), [1,4,2,7,5,3]) == [1,2,3]
+// O(n) on average, the keys need std::hash and ==.
+template <typename Container, typename F>
+Container nub_on(F f, const Container& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    typedef typename std::decay<
+        typename utils::function_traits<F>::result_type>::type Key;
+    internal::seen_set<Key> seen;
+    Container result;
+    auto itOut = get_back_inserter(result);
+    for (const auto& x : xs)
+        if (seen.insert(f(x)))
+            *itOut = x;
+    return result;
+}
+
+// nub_hash([1,2,2,3,2]) == [1,2,3]
+// O(n) on average, the elements need std::hash.
+// Integral types of up to 16 bits are looked up in a bitmap.
+template <typename Container>
+Container nub_hash(const Container& xs)
+{
+    typedef typename Container::value_type T;
+    internal::seen_set<T> seen;
+    Container result;
+    auto itOut = get_back_inserter(result);
+    for (const auto& x : xs)
+        if (seen.insert(x))
+            *itOut = x;
+    return result;
+}
+
+// Returns true for empty containers.
+// O(n) on average, the elements need std::hash.
+template <typename Container>
+bool all_unique_hash(const Container& xs)
+{
+    typedef typename Container::value_type T;
+    internal::seen_set<T> seen;
+    for (const auto& x : xs)
+        if (!seen.insert(x))
+            return false;
+    return true;
+}
+
+namespace internal
+{
+
+template <typename Container>
+Container nub(const Container& xs, std::true_type)
+{
+    typedef typename Container::value_type T;
+    if (size_of_cont(xs) <= max_nub_size_for_quadratic())
+        return nub_by(std::equal_to<T>(), xs);
+    return nub_hash(xs);
+}
+
+template <typename Container>
+Container nub(const Container& xs, std::false_type)
+{
+    typedef typename Container::value_type T;
+    return nub_by(std::equal_to<T>(), xs);
+}
+
+} // namespace internal
+
 // nub([1,2,2,3,2]) == [1,2,3]
+// O(n) on average for types supporting std::hash, O(n^2) otherwise.
 template <typename Container>
 Container nub(const Container& xs)
 {
     typedef typename Container::value_type T;
-    return nub_by(std::equal_to<T>(), xs);
+    return internal::nub(xs, internal::is_hashable<T>());
 }
 
 // Returns true for empty containers.
@@ -623,14 +936,34 @@ bool all_unique_by_eq(BinaryPredicate p, const Container& xs)
     return size_of_cont(nub_by(p, xs)) == size_of_cont(xs);
 }
 
+namespace internal
+{
+
+template <typename Container>
+bool all_unique(const Container& xs, std::true_type)
+{
+    typedef typename Container::value_type T;
+    if (size_of_cont(xs) <= max_nub_size_for_quadratic())
+        return all_unique_by_eq(std::equal_to<T>(), xs);
+    return all_unique_hash(xs);
+}
+
+template <typename Container>
+bool all_unique(const Container& xs, std::false_type)
+{
+    typedef typename Container::value_type T;
+    return all_unique_by_eq(std::equal_to<T>(), xs);
+}
+
+} // namespace internal
+
 // Returns true for empty containers.
-// O(n^2)
+// O(n) on average for types supporting std::hash, O(n^2) otherwise.
 template <typename Container>
 bool all_unique(const Container& xs)
 {
     typedef typename Container::value_type T;
-    auto comp = std::equal_to<T>();
-    return all_unique_by_eq(comp, xs);
+    return internal::all_unique(xs, internal::is_hashable<T>());
 }
 
 // comp(a, b) must return true only if a < b.
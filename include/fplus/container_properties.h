@@ -158,7 +158,7 @@ Result median(const Container& xs)
         auto it2 = it1;
         ++it2;
         std::vector<T> upperAndLower = { *it1, *it2 };
-        return mean<Result, Container>(upperAndLower);
+        return mean<Result>(upperAndLower);
     }
 }
 
@@ -217,7 +217,8 @@ template <typename UnaryPredicate, typename Container>
 std::size_t count_if(UnaryPredicate p, const Container& xs)
 {
     check_unary_predicate_for_container<UnaryPredicate, Container>();
-    return size_of_cont(find_all_idxs_by(p, xs));
+    return static_cast<std::size_t>(
+        std::count_if(std::begin(xs), std::end(xs), p));
 }
 
 // count(2, [1, 2, 3, 5, 7, 2, 2]) == 3
@@ -225,7 +226,7 @@ template <typename Container>
 std::size_t count
         (const typename Container::value_type& x, const Container& xs)
 {
-    return size_of_cont(find_all_idxs_of(x, xs));
+    return count_if(is_equal_to(x), xs);
 }
 
 } // namespace fplus
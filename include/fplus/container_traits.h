@@ -15,6 +15,8 @@
 #include <queue>
 #include <set>
 #include <stack>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 namespace fplus
@@ -31,6 +33,19 @@ template<class T, class Container> struct has_order<std::queue<T, Container>> :
 template<class T, class Container, class Compare> struct has_order<std::priority_queue<T, Container, Compare>> : public std::false_type {};
 template<class CharT, class Traits, class Alloc> struct has_order<std::basic_string<CharT, Traits, Alloc>> : public std::true_type {};
 
+// Sequence containers whose elements can be modified, erased and appended
+// in place. Functions taking a Container&& use this to accept temporaries
+// of these types and reuse their memory. Since only the plain types
+// are listed, lvalues (deduced as T&) and const rvalues do not match.
+template<class T> struct is_reusable_container : public std::false_type {};
+template<class T, class Alloc> struct is_reusable_container<std::vector<T, Alloc>> : public std::true_type {};
+template<class T, class Alloc> struct is_reusable_container<std::deque<T, Alloc>> : public std::true_type {};
+template<class T, class Alloc> struct is_reusable_container<std::list<T, Alloc>> : public std::true_type {};
+template<class CharT, class Traits, class Alloc> struct is_reusable_container<std::basic_string<CharT, Traits, Alloc>> : public std::true_type {};
+
+template<class Container>
+using enable_if_reusable_container_t = typename std::enable_if<is_reusable_container<Container>::value>::type;
+
 //http://stackoverflow.com/a/33828321/1866775
 template<class Cont, class NewT> struct same_cont_new_t : public std::false_type{};
 template<class T, std::size_t N, class NewT> struct same_cont_new_t<std::array<T, N>, NewT> { typedef typename std::array<NewT, N> type; };
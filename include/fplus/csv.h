@@ -0,0 +1,315 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "par.h"
+#include "read.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace fplus
+{
+
+// Values of one column read by read_csv_columns.
+// valid[i] is false if the field of row i is missing
+// or can not be read, values[i] then is T().
+template <typename T>
+struct csv_column
+{
+    std::vector<T> values;
+    std::vector<bool> valid;
+};
+
+namespace internal
+{
+
+// Quoted fields are given without their enclosing quotes.
+struct csv_field
+{
+    const char* first;
+    const char* last;
+    bool has_escaped_quotes;
+};
+
+// Reads the field at p and moves p behind the following delimiter.
+// Returns false if the record ends after the field,
+// p then points to the start of the next record.
+inline bool next_csv_field(const char*& p, const char* end, char delimiter,
+    csv_field& field)
+{
+    field.has_escaped_quotes = false;
+    if (p != end && *p == '"')
+    {
+        field.first = ++p;
+        field.last = end;
+        while (p != end)
+        {
+            const char* const quote = static_cast<const char*>(
+                std::memchr(p, '"', static_cast<std::size_t>(end - p)));
+            if (quote == nullptr)
+            {
+                p = end;
+                break;
+            }
+            p = quote + 1;
+            if (p != end && *p == '"')
+            {
+                field.has_escaped_quotes = true;
+                ++p;
+                continue;
+            }
+            field.last = quote;
+            break;
+        }
+        // Chars between the closing quote and the delimiter are ignored.
+        while (p != end && *p != delimiter && *p != '\n')
+            ++p;
+    }
+    else
+    {
+        field.first = p;
+        while (p != end && *p != delimiter && *p != '\n')
+            ++p;
+        field.last = p;
+        if (field.last != field.first && field.last[-1] == '\r' &&
+            (p == end || *p == '\n'))
+            --field.last;
+    }
+    if (p == end)
+        return false;
+    return *p++ == delimiter;
+}
+
+// Index behind the first line break outside of quotes at or after pos.
+inline std::size_t next_csv_record_start(const char* data, std::size_t pos,
+    std::size_t size, bool in_quotes)
+{
+    for (; pos != size; ++pos)
+    {
+        if (data[pos] == '"')
+            in_quotes = !in_quotes;
+        else if (data[pos] == '\n' && !in_quotes)
+            return pos + 1;
+    }
+    return size;
+}
+
+inline std::string unescape_csv_field(const csv_field& field)
+{
+    std::string result;
+    result.reserve(static_cast<std::size_t>(field.last - field.first));
+    for (const char* p = field.first; p != field.last; ++p)
+    {
+        result += *p;
+        if (*p == '"' && p + 1 != field.last && p[1] == '"')
+            ++p;
+    }
+    return result;
+}
+
+inline bool read_csv_field(const csv_field& field, std::string& result)
+{
+    if (field.has_escaped_quotes)
+        result = unescape_csv_field(field);
+    else
+        result.assign(field.first, field.last);
+    return true;
+}
+
+// The number parsers need a null-terminated string,
+// so short fields are copied to the stack.
+template <typename T>
+bool read_csv_field(const csv_field& field, T& result)
+{
+    typedef internal_helper_read_value_struct<T> Reader;
+    const std::size_t size = static_cast<std::size_t>(
+        field.last - field.first);
+    char buffer[64];
+    if (!field.has_escaped_quotes && size < sizeof(buffer))
+    {
+        std::memcpy(buffer, field.first, size);
+        buffer[size] = '\0';
+        return Reader::read(buffer, buffer + size, result) == nullptr;
+    }
+    const std::string str = unescape_csv_field(field);
+    return Reader::read(str.c_str(), str.c_str() + str.size(),
+        result) == nullptr;
+}
+
+template <typename T>
+void append_csv_field(csv_column<T>& column, const csv_field& field)
+{
+    column.values.push_back(T());
+    const bool valid = read_csv_field(field, column.values.back());
+    if (!valid)
+        column.values.back() = T();
+    column.valid.push_back(valid);
+}
+
+template <typename T>
+void append_missing_csv_field(csv_column<T>& column)
+{
+    column.values.push_back(T());
+    column.valid.push_back(false);
+}
+
+template <std::size_t I, std::size_t N>
+struct csv_row_reader
+{
+    template <typename Columns>
+    static void read(Columns& columns, const char*& p, const char* end,
+        char delimiter, bool& more_fields)
+    {
+        if (more_fields)
+        {
+            csv_field field;
+            more_fields = next_csv_field(p, end, delimiter, field);
+            append_csv_field(std::get<I>(columns), field);
+        }
+        else
+        {
+            append_missing_csv_field(std::get<I>(columns));
+        }
+        csv_row_reader<I + 1, N>::read(columns, p, end, delimiter,
+            more_fields);
+    }
+};
+
+template <std::size_t N>
+struct csv_row_reader<N, N>
+{
+    template <typename Columns>
+    static void read(Columns&, const char*&, const char*, char, bool&) {}
+};
+
+template <std::size_t I, std::size_t N>
+struct csv_columns_appender
+{
+    template <typename Columns>
+    static void append(Columns& dest, Columns& src)
+    {
+        auto& dest_column = std::get<I>(dest);
+        auto& src_column = std::get<I>(src);
+        dest_column.values.insert(std::end(dest_column.values),
+            std::make_move_iterator(std::begin(src_column.values)),
+            std::make_move_iterator(std::end(src_column.values)));
+        dest_column.valid.insert(std::end(dest_column.valid),
+            std::begin(src_column.valid), std::end(src_column.valid));
+        csv_columns_appender<I + 1, N>::append(dest, src);
+    }
+};
+
+template <std::size_t N>
+struct csv_columns_appender<N, N>
+{
+    template <typename Columns>
+    static void append(Columns&, Columns&) {}
+};
+
+// Reads all records starting in [first, last).
+template <typename Columns>
+void read_csv_records(Columns& columns, const char* first, const char* last,
+    const char* end, char delimiter)
+{
+    const std::size_t column_count = std::tuple_size<Columns>::value;
+    const char* p = first;
+    while (p < last)
+    {
+        if (*p == '\n' || (*p == '\r' && p + 1 != end && p[1] == '\n'))
+        {
+            p += *p == '\n' ? 1 : 2;
+            continue;
+        }
+        bool more_fields = true;
+        csv_row_reader<0, column_count>::read(columns, p, end, delimiter,
+            more_fields);
+        csv_field ignored;
+        while (more_fields)
+            more_fields = next_csv_field(p, end, delimiter, ignored);
+    }
+}
+
+} // namespace internal
+
+// Reads delimiter-separated values, like CSV or TSV (delimiter '\t'),
+// into one column per given type.
+// Fields can be enclosed in double quotes to contain delimiters,
+// line breaks and escaped quotes (""), but quotes inside
+// unquoted fields are not supported. Records end with "\n" or "\r\n",
+// empty lines are skipped. Numbers are read like read_value does.
+// Fields beyond the given types are ignored,
+// missing or unreadable ones are marked as not valid.
+// Large inputs are split into chunks at record boundaries,
+// which are read concurrently on the thread pool of fplus::par.
+// data can be a std::string or an fplus::mapped_file.
+// read_csv_columns<int, std::string>(',', false, "1,a\n2,\"b,c\"\nx,d\n")
+//     == ({[1, 2, 0], [true, true, false]},
+//         {["a", "b,c", "d"], [true, true, true]})
+template <typename... Ts, typename String>
+std::tuple<csv_column<Ts>...> read_csv_columns(
+    char delimiter, bool skipHeader, const String& data)
+{
+    typedef std::tuple<csv_column<Ts>...> Columns;
+    const char* const p = data.data();
+    const std::size_t size = data.size();
+    const std::size_t start = skipHeader
+        ? internal::next_csv_record_start(p, 0, size, false) : 0;
+    const std::size_t chunks = par::internal::chunk_count(size - start);
+    Columns result;
+    if (chunks == 1)
+    {
+        internal::read_csv_records(result, p + start, p + size, p + size,
+            delimiter);
+        return result;
+    }
+
+    // A chunk starts with the first record beginning in its byte range.
+    // Whether that range starts inside of quotes
+    // follows from the number of quotes in front of it.
+    std::vector<std::size_t> quotes(chunks);
+    par::internal::for_each_chunk(chunks, size - start,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        quotes[chunk] = static_cast<std::size_t>(
+            std::count(p + start + begin, p + start + end, '"'));
+    });
+    std::vector<std::size_t> bounds(chunks + 1, size);
+    bounds[0] = start;
+    std::size_t quotes_before = 0;
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        quotes_before += quotes[chunk - 1];
+        const std::size_t begin = start + chunk * (size - start) / chunks;
+        // Starting one byte early finds records beginning right at begin.
+        const std::size_t quotes_in_front =
+            quotes_before - (p[begin - 1] == '"' ? 1 : 0);
+        bounds[chunk] = std::max(bounds[chunk - 1],
+            internal::next_csv_record_start(p, begin - 1, size,
+                quotes_in_front % 2 == 1));
+    }
+
+    std::vector<Columns> parts(chunks);
+    par::internal::default_pool().run(chunks, [&](std::size_t chunk)
+    {
+        internal::read_csv_records(parts[chunk],
+            p + bounds[chunk], p + bounds[chunk + 1], p + size, delimiter);
+    });
+    result = std::move(parts.front());
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+        internal::csv_columns_appender<0, sizeof...(Ts)>::append(
+            result, parts[chunk]);
+    return result;
+}
+
+} // namespace fplus
@@ -0,0 +1,272 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "result.h"
+#include "show.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+// Define FPLUS_NO_MMAP to always read files with the streaming fallback.
+#if !defined(FPLUS_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#define FPLUS_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fplus
+{
+
+// Read-only contents of a file.
+// Copies share the same bytes, so passing it around is cheap.
+// It can be used like a container of chars,
+// e.g. with lazy::split_lines or count.
+class mapped_file
+{
+public:
+    typedef char value_type;
+    typedef const char* const_iterator;
+    typedef const char* iterator;
+    typedef std::size_t size_type;
+    mapped_file() : size_(0), mapped_(false) {}
+    // Wraps bytes kept alive by data.
+    mapped_file(std::shared_ptr<const char> data, std::size_t size,
+            bool mapped) :
+        data_(data), size_(size), mapped_(mapped) {}
+    const char* data() const { return data_.get(); }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* begin() const { return data(); }
+    const char* end() const { return data() + size_; }
+    // Is the file mapped into memory instead of having been read?
+    bool is_mapped() const { return mapped_; }
+    std::string str() const { return std::string(begin(), end()); }
+#if __cplusplus >= 201703L
+    std::string_view view() const { return std::string_view(data(), size_); }
+#endif
+private:
+    std::shared_ptr<const char> data_;
+    std::size_t size_;
+    bool mapped_;
+};
+
+namespace internal
+{
+
+inline std::string file_error(const std::string& path)
+{
+    return path + ": " + std::strerror(errno);
+}
+
+inline mapped_file mapped_file_from_buffer(std::vector<char>&& buffer)
+{
+    const std::size_t size = buffer.size();
+    const auto owner = std::make_shared<std::vector<char>>(std::move(buffer));
+    return mapped_file(std::shared_ptr<const char>(owner, owner->data()),
+        size, false);
+}
+
+#ifdef FPLUS_HAS_MMAP
+
+class file_descriptor
+{
+public:
+    explicit file_descriptor(int fd) : fd_(fd) {}
+    ~file_descriptor() { if (fd_ >= 0) ::close(fd_); }
+    file_descriptor(const file_descriptor&) = delete;
+    file_descriptor& operator = (const file_descriptor&) = delete;
+    int get() const { return fd_; }
+private:
+    int fd_;
+};
+
+// Reads until EOF, growing the buffer geometrically.
+inline bool read_all(int fd, std::size_t size_hint, std::vector<char>& buffer)
+{
+    std::size_t size = 0;
+    buffer.resize(size_hint + 1 > 65536 ? size_hint + 1 : 65536);
+    for (;;)
+    {
+        if (size == buffer.size())
+            buffer.resize(2 * buffer.size());
+        const ssize_t got = ::read(fd, buffer.data() + size,
+            buffer.size() - size);
+        if (got == 0)
+            break;
+        if (got < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        size += static_cast<std::size_t>(got);
+    }
+    buffer.resize(size);
+    return true;
+}
+
+inline result<mapped_file, std::string> read_file_streamed(
+    const std::string& path, int fd, std::size_t size_hint)
+{
+    std::vector<char> buffer;
+    if (!read_all(fd, size_hint, buffer))
+        return error<mapped_file, std::string>(file_error(path));
+    return ok<mapped_file, std::string>(
+        mapped_file_from_buffer(std::move(buffer)));
+}
+
+inline result<mapped_file, std::string> read_file_streamed(
+    const std::string& path)
+{
+    const file_descriptor fd(::open(path.c_str(), O_RDONLY));
+    if (fd.get() < 0)
+        return error<mapped_file, std::string>(file_error(path));
+    struct stat info;
+    const std::size_t size_hint =
+        ::fstat(fd.get(), &info) == 0 && S_ISREG(info.st_mode)
+            ? static_cast<std::size_t>(info.st_size) : 0;
+    return read_file_streamed(path, fd.get(), size_hint);
+}
+
+#else
+
+inline result<mapped_file, std::string> read_file_streamed(
+    const std::string& path)
+{
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr)
+        return error<mapped_file, std::string>(file_error(path));
+    std::vector<char> buffer(65536);
+    std::size_t size = 0;
+    for (;;)
+    {
+        if (size == buffer.size())
+            buffer.resize(2 * buffer.size());
+        const std::size_t got = std::fread(buffer.data() + size, 1,
+            buffer.size() - size, file);
+        size += got;
+        if (got == 0)
+            break;
+    }
+    const bool failed = std::ferror(file) != 0;
+    std::fclose(file);
+    if (failed)
+        return error<mapped_file, std::string>(path + ": Read error.");
+    buffer.resize(size);
+    return ok<mapped_file, std::string>(
+        mapped_file_from_buffer(std::move(buffer)));
+}
+
+#endif
+
+inline bool write_all(std::FILE* file, const std::string& buffer)
+{
+    return std::fwrite(buffer.data(), 1, buffer.size(), file) ==
+        buffer.size();
+}
+
+} // namespace internal
+
+// Maps the file into memory, so its bytes are only copied
+// by the kernel when they are first touched.
+// Files that can not be mapped, like pipes or empty files,
+// are read into memory instead.
+// read_file_mapped("in.txt") == Ok mapped_file
+// read_file_mapped("missing.txt") == Error "missing.txt: No such file..."
+inline result<mapped_file, std::string> read_file_mapped(
+    const std::string& path)
+{
+#ifdef FPLUS_HAS_MMAP
+    const internal::file_descriptor fd(::open(path.c_str(), O_RDONLY));
+    if (fd.get() < 0)
+        return error<mapped_file, std::string>(internal::file_error(path));
+    struct stat info;
+    const bool regular = ::fstat(fd.get(), &info) == 0 &&
+        S_ISREG(info.st_mode);
+    const std::size_t size = regular
+        ? static_cast<std::size_t>(info.st_size) : 0;
+    if (size > 0)
+    {
+        void* const address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE,
+            fd.get(), 0);
+        if (address != MAP_FAILED)
+        {
+#ifdef MADV_SEQUENTIAL
+            ::madvise(address, size, MADV_SEQUENTIAL);
+#endif
+            const std::shared_ptr<const char> data(
+                static_cast<const char*>(address),
+                [size](const char* p)
+                {
+                    ::munmap(const_cast<char*>(p), size);
+                });
+            return ok<mapped_file, std::string>(
+                mapped_file(data, size, true));
+        }
+    }
+    return internal::read_file_streamed(path, fd.get(), size);
+#else
+    return internal::read_file_streamed(path);
+#endif
+}
+
+// Writes every element followed by "\n", formatted like show does.
+// The output is collected in large blocks, which are written
+// without further buffering by the C library.
+// Returns the number of lines written.
+// write_lines("out.txt", ["a", "b"]) == Ok 2
+template <typename Container>
+result<std::size_t, std::string> write_lines(
+    const std::string& path, const Container& xs)
+{
+    const std::size_t block_size = 1 << 16;
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr)
+        return error<std::size_t, std::string>(internal::file_error(path));
+    std::setvbuf(file, nullptr, _IONBF, 0);
+    std::string buffer;
+    buffer.reserve(2 * block_size);
+    std::size_t lines = 0;
+    bool failed = false;
+    for (const auto& x : xs)
+    {
+        show_into(buffer, x);
+        buffer += '\n';
+        ++lines;
+        if (buffer.size() >= block_size)
+        {
+            if (!internal::write_all(file, buffer))
+            {
+                failed = true;
+                break;
+            }
+            buffer.clear();
+        }
+    }
+    if (!failed)
+        failed = !internal::write_all(file, buffer);
+    const std::string message = failed ? internal::file_error(path) : "";
+    if (std::fclose(file) != 0 && !failed)
+        return error<std::size_t, std::string>(internal::file_error(path));
+    if (failed)
+        return error<std::size_t, std::string>(message);
+    return ok<std::size_t, std::string>(lines);
+}
+
+} // namespace fplus
@@ -12,6 +12,7 @@
 #include "container_common.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace fplus
 {
@@ -28,6 +29,17 @@ Container keep_if(Pred pred, const Container& xs)
     return result;
 }
 
+template <typename Pred, typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container keep_if(Pred pred, Container&& xs)
+{
+    check_unary_predicate_for_container<Pred, Container>();
+    typedef typename Container::value_type T;
+    xs.erase(std::remove_if(std::begin(xs), std::end(xs),
+        [&pred](const T& x) { return !pred(x); }), std::end(xs));
+    return std::move(xs);
+}
+
 // drop_if(is_even, [1, 2, 3, 2, 4, 5]) == [1, 3, 5]
 // Also known as Reject.
 template <typename Pred, typename Container>
@@ -37,6 +49,16 @@ Container drop_if(Pred pred, const Container& xs)
     return keep_if(logical_not(pred), xs);
 }
 
+template <typename Pred, typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container drop_if(Pred pred, Container&& xs)
+{
+    check_unary_predicate_for_container<Pred, Container>();
+    xs.erase(std::remove_if(std::begin(xs), std::end(xs), pred),
+        std::end(xs));
+    return std::move(xs);
+}
+
 // without(0, [1, 0, 0, 5, 3, 0, 1]) == [1, 5, 3, 1]
 template <typename Container,
     typename T = typename Container::value_type>
@@ -68,7 +90,10 @@ template <typename Pred, typename Container>
 Container drop_if_with_idx(Pred pred, const Container& xs)
 {
     check_index_with_type_predicate_for_container<Pred, Container>();
-    return keep_if_with_idx(logical_not(pred), xs);
+    typedef typename Container::value_type T;
+    return keep_if_with_idx(
+        [pred](std::size_t idx, const T& x) { return !pred(idx, x); },
+        xs);
 }
 
 // Predicate takes an index and decides if an element is kept.
@@ -189,6 +214,16 @@ Container trim_left_by(UnaryPredicate p, const Container& xs)
     return Container(itFirstNot, std::end(xs));
 }
 
+template <typename Container, typename UnaryPredicate,
+    typename = enable_if_reusable_container_t<Container>>
+Container trim_left_by(UnaryPredicate p, Container&& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    xs.erase(std::begin(xs),
+        std::find_if_not(std::begin(xs), std::end(xs), p));
+    return std::move(xs);
+}
+
 // trim_left(0, [0,0,0,5,6,7,8,6,4]) == [5,6,7,8,6,4]
 template <typename Container,
         typename T = typename Container::value_type>
@@ -197,16 +232,58 @@ Container trim_left(const T& x, const Container& xs)
     return trim_left_by(is_equal_to(x), xs);
 }
 
+template <typename Container,
+        typename T = typename Container::value_type,
+        typename = enable_if_reusable_container_t<Container>>
+Container trim_left(const T& x, Container&& xs)
+{
+    return trim_left_by(is_equal_to(x), std::move(xs));
+}
+
+namespace {
+    // Returns the position behind the leading repetitions
+    // of the token [token_first, token_last).
+    template <typename TokenIterator, typename Iterator>
+    Iterator internal_helper_skip_tokens(
+            TokenIterator token_first, TokenIterator token_last,
+            Iterator first, Iterator last)
+    {
+        if (token_first == token_last)
+            return first;
+        for (;;)
+        {
+            auto it = first;
+            auto itToken = token_first;
+            while (itToken != token_last && it != last && *itToken == *it)
+            {
+                ++itToken;
+                ++it;
+            }
+            if (itToken != token_last)
+                return first;
+            first = it;
+        }
+    }
+} // anonymous namespace
+
 // trim_token_left([0,1,2], [0,1,2,0,1,2,7,5,9]) == [7,5,9]
 template <typename Container>
 Container trim_token_left(const Container& token, const Container& xs)
 {
-    auto result = xs;
-    while (is_prefix_of(token, result))
-    {
-        result = get_range(size_of_cont(token), size_of_cont(result), result);
-    }
-    return result;
+    const auto it = internal_helper_skip_tokens(
+        std::begin(token), std::end(token), std::begin(xs), std::end(xs));
+    return get_range(static_cast<std::size_t>(
+            std::distance(std::begin(xs), it)),
+        size_of_cont(xs), xs);
+}
+
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container trim_token_left(const Container& token, Container&& xs)
+{
+    xs.erase(std::begin(xs), internal_helper_skip_tokens(
+        std::begin(token), std::end(token), std::begin(xs), std::end(xs)));
+    return std::move(xs);
 }
 
 // trim_right_by(is_even, [0,2,4,5,6,7,8,6,4]) == [0,2,4,5,6,7]
@@ -217,6 +294,16 @@ Container trim_right_by(UnaryPredicate p, const Container& xs)
     return reverse(trim_left_by(p, reverse(xs)));
 }
 
+template <typename Container, typename UnaryPredicate,
+    typename = enable_if_reusable_container_t<Container>>
+Container trim_right_by(UnaryPredicate p, Container&& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    xs.erase(std::find_if_not(xs.rbegin(), xs.rend(), p).base(),
+        std::end(xs));
+    return std::move(xs);
+}
+
 // trim_right(4, [0,2,4,5,6,7,8,4,4]) == [0,2,4,5,6,7,8]
 template <typename Container,
         typename T = typename Container::value_type>
@@ -225,6 +312,14 @@ Container trim_right(const T& x, const Container& xs)
     return trim_right_by(is_equal_to(x), xs);
 }
 
+template <typename Container,
+        typename T = typename Container::value_type,
+        typename = enable_if_reusable_container_t<Container>>
+Container trim_right(const T& x, Container&& xs)
+{
+    return trim_right_by(is_equal_to(x), std::move(xs));
+}
+
 // trim_token_right([0,1,2], [7,5,9,0,1,2,0,1,2]) == [7,5,9]
 template <typename Container>
 Container trim_token_right(const Container& token, const Container& xs)
@@ -232,6 +327,16 @@ Container trim_token_right(const Container& token, const Container& xs)
     return reverse(trim_token_left(reverse(token), reverse(xs)));
 }
 
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container trim_token_right(const Container& token, Container&& xs)
+{
+    xs.erase(internal_helper_skip_tokens(
+        token.rbegin(), token.rend(), xs.rbegin(), xs.rend()).base(),
+        std::end(xs));
+    return std::move(xs);
+}
+
 // trim_by(is_even, [0,2,4,5,6,7,8,6,4]) == [5,6,7]
 template <typename Container, typename UnaryPredicate>
 Container trim_by(UnaryPredicate p, const Container& xs)
@@ -240,6 +345,14 @@ Container trim_by(UnaryPredicate p, const Container& xs)
     return trim_right_by(p, trim_left_by(p, xs));
 }
 
+template <typename Container, typename UnaryPredicate,
+    typename = enable_if_reusable_container_t<Container>>
+Container trim_by(UnaryPredicate p, Container&& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    return trim_right_by(p, trim_left_by(p, std::move(xs)));
+}
+
 // trim(0, [0,2,4,5,6,7,8,0,0]) == [2,4,5,6,7,8]
 template <typename Container,
         typename T = typename Container::value_type>
@@ -248,6 +361,14 @@ Container trim(const T& x, const Container& xs)
     return trim_right(x, trim_left(x, xs));
 }
 
+template <typename Container,
+        typename T = typename Container::value_type,
+        typename = enable_if_reusable_container_t<Container>>
+Container trim(const T& x, Container&& xs)
+{
+    return trim_right(x, trim_left(x, std::move(xs)));
+}
+
 // trim_token([0,1], [0,1,7,8,9,0,1]) == [7,8,9]
 template <typename Container>
 Container trim_token(const Container& token, const Container& xs)
@@ -255,4 +376,11 @@ Container trim_token(const Container& token, const Container& xs)
     return trim_token_right(token, trim_token_left(token, xs));
 }
 
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container trim_token(const Container& token, Container&& xs)
+{
+    return trim_token_right(token, trim_token_left(token, std::move(xs)));
+}
+
 } // namespace fplus
@@ -184,11 +184,13 @@ namespace {
         auto go = [](const Vec& elems, const VecVec& acc)
         {
             VecVec result;
+            prepare_container(result, size_of_cont(elems) * size_of_cont(acc));
+            auto itOut = get_back_inserter(result);
             for (const T& x : elems)
             {
                 for (const Vec& tail : acc)
                 {
-                    result.push_back(append(Vec(1, x), tail));
+                    *itOut = append(Vec(1, x), tail);
                 }
             }
             return result;
@@ -0,0 +1,907 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#include "char_kernels.h"
+#include "compare.h"
+#include "composition.h"
+#include "container_common.h"
+#include "container_traits.h"
+#include "function_traits.h"
+#include "maybe.h"
+#include "string_tools.h"
+
+namespace fplus
+{
+
+// The functions in fplus::lazy mirror their eager namesakes,
+// but instead of a new container they return a view,
+// which computes its elements only while it is being consumed.
+// Stacked views run in one pass without intermediate containers,
+// and consumers like lazy::is_elem_of stop as soon as the answer is known.
+//
+// lazy::materialize(lazy::transform(f, lazy::keep_if(p, xs)))
+//     == transform(f, keep_if(p, xs))
+// lazy::is_elem_of(std::string("I"), lazy::split_words(team, false))
+//
+// A view made from a container lvalue only refers to it,
+// so the container has to outlive the view.
+// Temporaries are moved into the view instead.
+// Views can also be iterated over with a range-based for loop.
+namespace lazy
+{
+
+namespace internal
+{
+
+struct view_tag {};
+
+template <typename T>
+struct is_view :
+    public std::is_base_of<view_tag, typename std::decay<T>::type> {};
+
+// Keeps the element a cursor currently points to.
+// References into the source are kept as pointers,
+// computed values are stored inline.
+template <typename Reference>
+class element_holder
+{
+public:
+    typedef typename std::decay<Reference>::type value_type;
+    typedef const value_type& reference;
+    void set(Reference x)
+    {
+        value_.destroy();
+        value_.construct(std::move(x));
+    }
+    reference get() const { return value_.value(); }
+private:
+    fplus::internal::maybe_storage<value_type> value_;
+};
+
+template <typename T>
+class element_holder<T&>
+{
+public:
+    typedef T& reference;
+    element_holder() : ptr_(nullptr) {}
+    void set(T& x) { ptr_ = &x; }
+    reference get() const { return *ptr_; }
+private:
+    T* ptr_;
+};
+
+// Like element_holder, but a stored value does not move
+// when the holder is copied, so iterators into it stay valid.
+template <typename Reference>
+class stable_element_holder
+{
+public:
+    typedef typename std::decay<Reference>::type value_type;
+    typedef const value_type& reference;
+    void set(Reference x)
+    {
+        value_ = std::make_shared<const value_type>(std::move(x));
+    }
+    reference get() const { return *value_; }
+private:
+    std::shared_ptr<const value_type> value_;
+};
+
+template <typename T>
+class stable_element_holder<T&> : public element_holder<T&> {};
+
+// A cursor walks through the elements of a view.
+// done() tells if it has passed the last element,
+// get() returns the current element and next() advances to the next one.
+template <typename Iterator>
+class range_cursor
+{
+public:
+    typedef typename std::iterator_traits<Iterator>::reference reference;
+    range_cursor(Iterator it, Iterator end) : it_(it), end_(end) {}
+    bool done() const { return it_ == end_; }
+    reference get() const { return *it_; }
+    void next() { ++it_; }
+private:
+    Iterator it_;
+    Iterator end_;
+};
+
+// Input iterator driving a cursor. A default constructed one marks the end.
+template <typename Cursor>
+class cursor_iterator
+{
+public:
+    typedef std::input_iterator_tag iterator_category;
+    typedef typename Cursor::reference reference;
+    typedef typename std::decay<reference>::type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type* pointer;
+    cursor_iterator() {}
+    explicit cursor_iterator(const Cursor& cursor)
+    {
+        cursor_.construct(cursor);
+    }
+    reference operator*() const { return cursor_.value().get(); }
+    cursor_iterator& operator++()
+    {
+        cursor_.value().next();
+        return *this;
+    }
+    bool operator == (const cursor_iterator& other) const
+    {
+        return at_end() == other.at_end();
+    }
+    bool operator != (const cursor_iterator& other) const
+    {
+        return !(*this == other);
+    }
+private:
+    bool at_end() const
+    {
+        return !cursor_.is_present() || cursor_.value().done();
+    }
+    fplus::internal::maybe_storage<Cursor> cursor_;
+};
+
+template <typename View>
+class view_base : public view_tag
+{
+public:
+    template <typename V = View>
+    cursor_iterator<typename V::cursor> begin() const
+    {
+        return cursor_iterator<typename V::cursor>(
+            static_cast<const V&>(*this).make_cursor());
+    }
+    template <typename V = View>
+    cursor_iterator<typename V::cursor> end() const
+    {
+        return cursor_iterator<typename V::cursor>();
+    }
+};
+
+template <typename Container>
+class container_view : public view_base<container_view<Container>>
+{
+public:
+    typedef Container source_container;
+    typedef typename Container::value_type value_type;
+    typedef range_cursor<typename Container::const_iterator> cursor;
+    explicit container_view(const Container& xs) : xs_(&xs) {}
+    const Container& container() const { return *xs_; }
+    cursor make_cursor() const
+    {
+        return cursor(std::begin(*xs_), std::end(*xs_));
+    }
+private:
+    const Container* xs_;
+};
+
+// Shares ownership, so copying the view does not copy the elements.
+template <typename Container>
+class owning_container_view : public view_base<owning_container_view<Container>>
+{
+public:
+    typedef Container source_container;
+    typedef typename Container::value_type value_type;
+    typedef range_cursor<typename Container::const_iterator> cursor;
+    explicit owning_container_view(Container&& xs) :
+        xs_(std::make_shared<const Container>(std::move(xs))) {}
+    const Container& container() const { return *xs_; }
+    cursor make_cursor() const
+    {
+        return cursor(std::begin(*xs_), std::end(*xs_));
+    }
+private:
+    std::shared_ptr<const Container> xs_;
+};
+
+// Maps the argument of a lazy function to the view it reads from.
+template <typename Xs,
+    bool = is_view<Xs>::value,
+    bool = std::is_lvalue_reference<Xs>::value>
+struct view_of;
+
+template <typename Xs, bool IsLvalue>
+struct view_of<Xs, true, IsLvalue>
+{
+    typedef typename std::decay<Xs>::type type;
+    static type make(const type& xs) { return xs; }
+};
+
+template <typename Xs>
+struct view_of<Xs, false, true>
+{
+    typedef container_view<typename std::decay<Xs>::type> type;
+    static type make(const typename std::decay<Xs>::type& xs)
+    {
+        return type(xs);
+    }
+};
+
+template <typename Xs>
+struct view_of<Xs, false, false>
+{
+    typedef owning_container_view<typename std::decay<Xs>::type> type;
+    static type make(typename std::decay<Xs>::type&& xs)
+    {
+        return type(std::move(xs));
+    }
+};
+
+template <typename Xs>
+typename view_of<Xs>::type make_view(Xs&& xs)
+{
+    return view_of<Xs>::make(std::forward<Xs>(xs));
+}
+
+template <typename F, typename View>
+class transform_view : public view_base<transform_view<F, View>>
+{
+public:
+    typedef typename View::source_container source_container;
+    typedef typename std::decay<
+        typename utils::function_traits<F>::result_type>::type value_type;
+    class cursor
+    {
+    public:
+        typedef value_type reference;
+        cursor(F f, const typename View::cursor& inner) :
+            f_(f), inner_(inner) {}
+        bool done() const { return inner_.done(); }
+        reference get() const { return f_(inner_.get()); }
+        void next() { inner_.next(); }
+    private:
+        F f_;
+        typename View::cursor inner_;
+    };
+    transform_view(F f, const View& xs) : f_(f), xs_(xs) {}
+    cursor make_cursor() const { return cursor(f_, xs_.make_cursor()); }
+private:
+    F f_;
+    View xs_;
+};
+
+// Keeps the elements for which the predicate returns Keep.
+template <typename UnaryPredicate, typename View, bool Keep>
+class keep_if_view : public view_base<keep_if_view<UnaryPredicate, View, Keep>>
+{
+public:
+    typedef typename View::source_container source_container;
+    typedef typename View::value_type value_type;
+    class cursor
+    {
+    public:
+        typedef element_holder<typename View::cursor::reference> holder;
+        typedef typename holder::reference reference;
+        cursor(UnaryPredicate p, const typename View::cursor& inner) :
+            p_(p), inner_(inner)
+        {
+            skip_unwanted();
+        }
+        bool done() const { return inner_.done(); }
+        reference get() const { return current_.get(); }
+        void next()
+        {
+            inner_.next();
+            skip_unwanted();
+        }
+    private:
+        void skip_unwanted()
+        {
+            for (; !inner_.done(); inner_.next())
+            {
+                current_.set(inner_.get());
+                if (static_cast<bool>(p_(current_.get())) == Keep)
+                    return;
+            }
+        }
+        UnaryPredicate p_;
+        typename View::cursor inner_;
+        holder current_;
+    };
+    keep_if_view(UnaryPredicate p, const View& xs) : p_(p), xs_(xs) {}
+    cursor make_cursor() const { return cursor(p_, xs_.make_cursor()); }
+private:
+    UnaryPredicate p_;
+    View xs_;
+};
+
+template <typename View>
+class take_view : public view_base<take_view<View>>
+{
+public:
+    typedef typename View::source_container source_container;
+    typedef typename View::value_type value_type;
+    class cursor
+    {
+    public:
+        typedef typename View::cursor::reference reference;
+        cursor(std::size_t amount, const typename View::cursor& inner) :
+            amount_(amount), inner_(inner) {}
+        bool done() const { return amount_ == 0 || inner_.done(); }
+        reference get() const { return inner_.get(); }
+        void next()
+        {
+            // The source is not touched after the last element taken.
+            if (--amount_ != 0)
+                inner_.next();
+        }
+    private:
+        std::size_t amount_;
+        typename View::cursor inner_;
+    };
+    take_view(std::size_t amount, const View& xs) : amount_(amount), xs_(xs) {}
+    cursor make_cursor() const { return cursor(amount_, xs_.make_cursor()); }
+private:
+    std::size_t amount_;
+    View xs_;
+};
+
+template <typename View>
+class drop_view : public view_base<drop_view<View>>
+{
+public:
+    typedef typename View::source_container source_container;
+    typedef typename View::value_type value_type;
+    typedef typename View::cursor cursor;
+    drop_view(std::size_t amount, const View& xs) : amount_(amount), xs_(xs) {}
+    cursor make_cursor() const
+    {
+        cursor result = xs_.make_cursor();
+        for (std::size_t i = 0; i < amount_ && !result.done(); ++i)
+            result.next();
+        return result;
+    }
+private:
+    std::size_t amount_;
+    View xs_;
+};
+
+template <typename UnaryPredicate, typename View>
+class take_while_view : public view_base<take_while_view<UnaryPredicate, View>>
+{
+public:
+    typedef typename View::source_container source_container;
+    typedef typename View::value_type value_type;
+    class cursor
+    {
+    public:
+        typedef element_holder<typename View::cursor::reference> holder;
+        typedef typename holder::reference reference;
+        cursor(UnaryPredicate p, const typename View::cursor& inner) :
+            p_(p), inner_(inner), done_(false)
+        {
+            check_current();
+        }
+        bool done() const { return done_; }
+        reference get() const { return current_.get(); }
+        void next()
+        {
+            inner_.next();
+            check_current();
+        }
+    private:
+        void check_current()
+        {
+            if (inner_.done())
+            {
+                done_ = true;
+                return;
+            }
+            current_.set(inner_.get());
+            done_ = !p_(current_.get());
+        }
+        UnaryPredicate p_;
+        typename View::cursor inner_;
+        holder current_;
+        bool done_;
+    };
+    take_while_view(UnaryPredicate p, const View& xs) : p_(p), xs_(xs) {}
+    cursor make_cursor() const { return cursor(p_, xs_.make_cursor()); }
+private:
+    UnaryPredicate p_;
+    View xs_;
+};
+
+template <typename ViewA, typename ViewB>
+class zip_view : public view_base<zip_view<ViewA, ViewB>>
+{
+public:
+    typedef typename ViewA::source_container source_container;
+    typedef std::pair<typename ViewA::value_type, typename ViewB::value_type>
+        value_type;
+    class cursor
+    {
+    public:
+        typedef value_type reference;
+        cursor(const typename ViewA::cursor& a,
+                const typename ViewB::cursor& b) :
+            a_(a), b_(b) {}
+        bool done() const { return a_.done() || b_.done(); }
+        reference get() const { return value_type(a_.get(), b_.get()); }
+        void next()
+        {
+            a_.next();
+            b_.next();
+        }
+    private:
+        typename ViewA::cursor a_;
+        typename ViewB::cursor b_;
+    };
+    zip_view(const ViewA& xs, const ViewB& ys) : xs_(xs), ys_(ys) {}
+    cursor make_cursor() const
+    {
+        return cursor(xs_.make_cursor(), ys_.make_cursor());
+    }
+private:
+    ViewA xs_;
+    ViewB ys_;
+};
+
+// Produces the same pieces as fplus::split_by, one at a time.
+template <typename UnaryPredicate, typename SourceView>
+class split_view : public view_base<split_view<UnaryPredicate, SourceView>>
+{
+public:
+    typedef typename SourceView::source_container value_type;
+    typedef std::vector<value_type> source_container;
+    class cursor
+    {
+    public:
+        typedef value_type reference;
+        typedef typename value_type::const_iterator iterator;
+        cursor(UnaryPredicate p, bool allow_empty,
+                iterator start, iterator end) :
+            p_(p), allow_empty_(allow_empty),
+            start_(start), end_(end), piece_begin_(start), piece_end_(start),
+            done_(false), trailing_empty_(false)
+        {
+            find_next_piece();
+        }
+        bool done() const { return done_; }
+        reference get() const { return value_type(piece_begin_, piece_end_); }
+        void next() { find_next_piece(); }
+    private:
+        void find_next_piece()
+        {
+            while (start_ != end_)
+            {
+                const iterator piece_begin = start_;
+                const iterator stop = std::find_if(start_, end_, p_);
+                if (stop == end_)
+                {
+                    start_ = end_;
+                }
+                else
+                {
+                    start_ = std::next(stop);
+                    trailing_empty_ = allow_empty_ && start_ == end_;
+                }
+                if (piece_begin != stop || allow_empty_)
+                {
+                    piece_begin_ = piece_begin;
+                    piece_end_ = stop;
+                    return;
+                }
+            }
+            if (trailing_empty_)
+            {
+                trailing_empty_ = false;
+                piece_begin_ = end_;
+                piece_end_ = end_;
+                return;
+            }
+            done_ = true;
+        }
+        UnaryPredicate p_;
+        bool allow_empty_;
+        iterator start_;
+        iterator end_;
+        iterator piece_begin_;
+        iterator piece_end_;
+        bool done_;
+        bool trailing_empty_;
+    };
+    split_view(UnaryPredicate p, bool allow_empty, const SourceView& xs) :
+        p_(p), allow_empty_(allow_empty), xs_(xs) {}
+    cursor make_cursor() const
+    {
+        return cursor(p_, allow_empty_,
+            std::begin(xs_.container()), std::end(xs_.container()));
+    }
+private:
+    UnaryPredicate p_;
+    bool allow_empty_;
+    SourceView xs_;
+};
+
+inline void assign_line(std::string& line, const char* p, std::size_t n)
+{
+    line.assign(p, n);
+}
+
+#if __cplusplus >= 201703L
+inline void assign_line(std::string_view& line, const char* p, std::size_t n)
+{
+    line = std::string_view(p, n);
+}
+#endif
+
+// Produces the same lines as fplus::split_lines, one at a time.
+// The current line is kept in one buffer, which is reused,
+// so the lines only stay valid until the view advances.
+// Copies of a cursor share the buffer, so references into it
+// held by stacked views stay valid.
+template <typename Line, typename SourceView>
+class lines_view : public view_base<lines_view<Line, SourceView>>
+{
+public:
+    typedef Line value_type;
+    typedef std::vector<value_type> source_container;
+    class cursor
+    {
+    public:
+        typedef const Line& reference;
+        cursor(const char* p, std::size_t n, bool allow_empty) :
+            p_(p), n_(n), pos_(0), allow_empty_(allow_empty),
+            done_(false), last_(false), line_(std::make_shared<Line>())
+        {
+            find_next_line();
+        }
+        bool done() const { return done_; }
+        reference get() const { return *line_; }
+        void next() { find_next_line(); }
+    private:
+        void find_next_line()
+        {
+            while (!last_)
+            {
+                const std::size_t start = pos_;
+                const std::size_t length = fplus::internal::
+                    find_first_byte_in_class(
+                        reinterpret_cast<const unsigned char*>(p_) + start,
+                        n_ - start, fplus::internal::line_break_bytes());
+                if (start + length == n_)
+                {
+                    last_ = true;
+                    if (n_ == 0 || (length == 0 && !allow_empty_))
+                        break;
+                }
+                else
+                {
+                    pos_ = start + length + 1;
+                    if (p_[pos_ - 1] == '\r' && pos_ != n_ && p_[pos_] == '\n')
+                        ++pos_;
+                    if (length == 0 && !allow_empty_)
+                        continue;
+                }
+                assign_line(*line_, p_ + start, length);
+                return;
+            }
+            done_ = true;
+        }
+        const char* p_;
+        std::size_t n_;
+        std::size_t pos_;
+        bool allow_empty_;
+        bool done_;
+        bool last_;
+        std::shared_ptr<Line> line_;
+    };
+    lines_view(bool allow_empty, const SourceView& xs) :
+        allow_empty_(allow_empty), xs_(xs) {}
+    cursor make_cursor() const
+    {
+        return cursor(xs_.container().data(), xs_.container().size(),
+            allow_empty_);
+    }
+private:
+    bool allow_empty_;
+    SourceView xs_;
+};
+
+template <typename View>
+class concat_view : public view_base<concat_view<View>>
+{
+public:
+    typedef typename View::value_type source_container;
+    typedef typename source_container::value_type value_type;
+    class cursor
+    {
+    public:
+        typedef stable_element_holder<typename View::cursor::reference> holder;
+        typedef typename source_container::const_iterator iterator;
+        typedef typename std::iterator_traits<iterator>::reference reference;
+        explicit cursor(const typename View::cursor& outer) : outer_(outer)
+        {
+            skip_empty();
+        }
+        bool done() const { return outer_.done(); }
+        reference get() const { return *it_; }
+        void next()
+        {
+            if (++it_ == end_)
+            {
+                outer_.next();
+                skip_empty();
+            }
+        }
+    private:
+        void skip_empty()
+        {
+            for (; !outer_.done(); outer_.next())
+            {
+                current_.set(outer_.get());
+                it_ = std::begin(current_.get());
+                end_ = std::end(current_.get());
+                if (it_ != end_)
+                    return;
+            }
+        }
+        typename View::cursor outer_;
+        holder current_;
+        iterator it_;
+        iterator end_;
+    };
+    explicit concat_view(const View& xss) : xss_(xss) {}
+    cursor make_cursor() const { return cursor(xss_.make_cursor()); }
+private:
+    View xss_;
+};
+
+template <typename View>
+void check_view()
+{
+    static_assert(is_view<View>::value, "Argument must be a lazy view.");
+}
+
+} // namespace internal
+
+// lazy::transform(square, [1, 2, 3, 4]) == view of [1, 4, 9, 16]
+template <typename F, typename Xs>
+internal::transform_view<F, typename internal::view_of<Xs>::type>
+transform(F f, Xs&& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    return internal::transform_view<F, typename internal::view_of<Xs>::type>(
+        f, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::keep_if(is_even, [1, 2, 3, 2, 4, 5]) == view of [2, 2, 4]
+template <typename UnaryPredicate, typename Xs>
+internal::keep_if_view<UnaryPredicate,
+    typename internal::view_of<Xs>::type, true>
+keep_if(UnaryPredicate pred, Xs&& xs)
+{
+    static_assert(utils::function_traits<UnaryPredicate>::arity == 1, "Wrong arity.");
+    return internal::keep_if_view<UnaryPredicate,
+        typename internal::view_of<Xs>::type, true>(
+            pred, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::drop_if(is_even, [1, 2, 3, 2, 4, 5]) == view of [1, 3, 5]
+template <typename UnaryPredicate, typename Xs>
+internal::keep_if_view<UnaryPredicate,
+    typename internal::view_of<Xs>::type, false>
+drop_if(UnaryPredicate pred, Xs&& xs)
+{
+    static_assert(utils::function_traits<UnaryPredicate>::arity == 1, "Wrong arity.");
+    return internal::keep_if_view<UnaryPredicate,
+        typename internal::view_of<Xs>::type, false>(
+            pred, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::take(3, [0,1,2,3,4,5,6,7]) == view of [0,1,2]
+// Elements after the last one taken are never computed.
+template <typename Xs>
+internal::take_view<typename internal::view_of<Xs>::type>
+take(std::size_t amount, Xs&& xs)
+{
+    return internal::take_view<typename internal::view_of<Xs>::type>(
+        amount, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::drop(3, [0,1,2,3,4,5,6,7]) == view of [3,4,5,6,7]
+template <typename Xs>
+internal::drop_view<typename internal::view_of<Xs>::type>
+drop(std::size_t amount, Xs&& xs)
+{
+    return internal::drop_view<typename internal::view_of<Xs>::type>(
+        amount, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::take_while(is_even, [0,2,4,5,6,7,8]) == view of [0,2,4]
+template <typename UnaryPredicate, typename Xs>
+internal::take_while_view<UnaryPredicate, typename internal::view_of<Xs>::type>
+take_while(UnaryPredicate pred, Xs&& xs)
+{
+    static_assert(utils::function_traits<UnaryPredicate>::arity == 1, "Wrong arity.");
+    return internal::take_while_view<UnaryPredicate,
+        typename internal::view_of<Xs>::type>(
+            pred, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::zip([1,2,3], [5,6]) == view of [(1,5),(2,6)]
+template <typename Xs, typename Ys>
+internal::zip_view<typename internal::view_of<Xs>::type,
+    typename internal::view_of<Ys>::type>
+zip(Xs&& xs, Ys&& ys)
+{
+    return internal::zip_view<typename internal::view_of<Xs>::type,
+        typename internal::view_of<Ys>::type>(
+            internal::make_view(std::forward<Xs>(xs)),
+            internal::make_view(std::forward<Ys>(ys)));
+}
+
+// lazy::split_by(is_even, true, [1,3,2,2,5,5,3,6,7,9])
+//     == view of [[1,3],[],[5,5,3],[7,9]]
+// xs has to be a container, not a view.
+template <typename UnaryPredicate, typename Xs>
+internal::split_view<UnaryPredicate, typename internal::view_of<Xs>::type>
+split_by(UnaryPredicate pred, bool allowEmpty, Xs&& xs)
+{
+    static_assert(!internal::is_view<Xs>::value, "Can only split containers.");
+    static_assert(utils::function_traits<UnaryPredicate>::arity == 1, "Wrong arity.");
+    return internal::split_view<UnaryPredicate,
+        typename internal::view_of<Xs>::type>(
+            pred, allowEmpty, internal::make_view(std::forward<Xs>(xs)));
+}
+
+// lazy::split_words("How are you?", false) == view of ["How", "are", "you"]
+template <typename String>
+auto split_words(String&& str, bool allowEmpty)
+    -> decltype(split_by(
+        logical_not(is_letter_or_digit<typename std::decay<String>::type>),
+        allowEmpty, std::forward<String>(str)))
+{
+    typedef typename std::decay<String>::type Str;
+    return split_by(logical_not(is_letter_or_digit<Str>),
+        allowEmpty, std::forward<String>(str));
+}
+
+// lazy::split_lines("Hi,\nhow are you?", false)
+//     == view of ["Hi,", "how are you?"]
+// str has to provide its chars contiguously via data() and size(),
+// like std::string or fplus::mapped_file.
+template <typename String>
+internal::lines_view<std::string, typename internal::view_of<String>::type>
+split_lines(String&& str, bool allowEmpty)
+{
+    static_assert(!internal::is_view<String>::value, "Can only split containers.");
+    static_assert(std::is_same<typename std::decay<String>::type::value_type,
+        char>::value, "chars required.");
+    return internal::lines_view<std::string,
+        typename internal::view_of<String>::type>(
+            allowEmpty, internal::make_view(std::forward<String>(str)));
+}
+
+#if __cplusplus >= 201703L
+// Like lazy::split_lines, but without copying the lines.
+// The string_views point into str.
+template <typename String>
+internal::lines_view<std::string_view,
+    typename internal::view_of<String>::type>
+split_lines_views(String&& str, bool allowEmpty)
+{
+    static_assert(!internal::is_view<String>::value, "Can only split containers.");
+    static_assert(std::is_same<typename std::decay<String>::type::value_type,
+        char>::value, "chars required.");
+    return internal::lines_view<std::string_view,
+        typename internal::view_of<String>::type>(
+            allowEmpty, internal::make_view(std::forward<String>(str)));
+}
+#endif
+
+// lazy::concat([[1,2],[],[3]]) == view of [1,2,3]
+template <typename Xss>
+internal::concat_view<typename internal::view_of<Xss>::type>
+concat(Xss&& xss)
+{
+    return internal::concat_view<typename internal::view_of<Xss>::type>(
+        internal::make_view(std::forward<Xss>(xss)));
+}
+
+// Evaluates the whole view into a container.
+// lazy::materialize<std::list<int>>(lazy::take(2, [1,2,3])) == [1,2]
+template <typename ContainerOut, typename View>
+ContainerOut materialize(const View& xs)
+{
+    internal::check_view<View>();
+    ContainerOut result;
+    auto itOut = get_back_inserter<ContainerOut>(result);
+    for (auto cursor = xs.make_cursor(); !cursor.done(); cursor.next())
+        *itOut = cursor.get();
+    return result;
+}
+
+// Without an explicit type, the view is evaluated into
+// the type of container its source had, e.g. a std::vector
+// for views on std::vectors and a std::string for views on std::strings.
+// Views produced by split_by hold std::vectors of pieces.
+// lazy::materialize(lazy::take(2, [1,2,3])) == [1,2]
+template <typename View,
+    typename ContainerOut = typename same_cont_new_t<
+        typename View::source_container, typename View::value_type>::type>
+ContainerOut materialize(const View& xs)
+{
+    return materialize<ContainerOut, View>(xs);
+}
+
+// Stops at the first element satisfying the predicate.
+// lazy::any_by(is_odd, view of [2, 4, 6]) == false
+template <typename UnaryPredicate, typename View>
+bool any_by(UnaryPredicate p, const View& xs)
+{
+    internal::check_view<View>();
+    for (auto cursor = xs.make_cursor(); !cursor.done(); cursor.next())
+    {
+        const auto& x = cursor.get();
+        if (p(x))
+            return true;
+    }
+    return false;
+}
+
+// Stops at the first element not satisfying the predicate.
+// lazy::all_by(is_odd, view of [2, 3, 6]) == false
+template <typename UnaryPredicate, typename View>
+bool all_by(UnaryPredicate p, const View& xs)
+{
+    internal::check_view<View>();
+    for (auto cursor = xs.make_cursor(); !cursor.done(); cursor.next())
+    {
+        const auto& x = cursor.get();
+        if (!p(x))
+            return false;
+    }
+    return true;
+}
+
+// Stops at the first match.
+// lazy::is_elem_of(2, view of [1,2,3]) == true
+template <typename View>
+bool is_elem_of(const typename View::value_type& x, const View& xs)
+{
+    return any_by(is_equal_to(x), xs);
+}
+
+// Stops at the first match.
+// lazy::find_first_by(is_even, view of [1, 3, 4, 6, 9]) == Just(4)
+// lazy::find_first_by(is_even, view of [1, 3, 5, 7, 9]) == Nothing
+template <typename UnaryPredicate, typename View,
+    typename T = typename View::value_type>
+maybe<T> find_first_by(UnaryPredicate pred, const View& xs)
+{
+    internal::check_view<View>();
+    for (auto cursor = xs.make_cursor(); !cursor.done(); cursor.next())
+    {
+        const auto& x = cursor.get();
+        if (pred(x))
+            return just<T>(x);
+    }
+    return nothing<T>();
+}
+
+} // namespace lazy
+
+} // namespace fplus
@@ -11,7 +11,9 @@
 #include <cassert>
 #include <exception>
 #include <functional>
-#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace fplus
 {
@@ -25,24 +27,121 @@ maybe<T> just(const T& val);
 template <typename T>
 maybe<T> nothing();
 
+namespace internal
+{
+
+// Inline storage for a value that may or may not be present.
+// For trivially copyable types it is trivially copyable itself.
+template <typename T, bool = std::is_trivially_copyable<T>::value>
+class maybe_storage;
+
+template <typename T>
+class maybe_storage<T, true>
+{
+public:
+    maybe_storage() : is_present_(false) {}
+    bool is_present() const { return is_present_; }
+    const T& value() const { return *reinterpret_cast<const T*>(&storage_); }
+    T& value() { return *reinterpret_cast<T*>(&storage_); }
+    template <typename... Args>
+    void construct(Args&&... args)
+    {
+        assert(!is_present_);
+        new (&storage_) T(std::forward<Args>(args)...);
+        is_present_ = true;
+    }
+    void destroy() { is_present_ = false; }
+private:
+    typename std::aligned_storage<sizeof(T),
+        std::alignment_of<T>::value>::type storage_;
+    bool is_present_;
+};
+
+template <typename T>
+class maybe_storage<T, false>
+{
+public:
+    maybe_storage() : is_present_(false) {}
+    maybe_storage(const maybe_storage& other) : is_present_(false)
+    {
+        if (other.is_present_)
+            construct(other.value());
+    }
+    maybe_storage(maybe_storage&& other)
+        noexcept(std::is_nothrow_move_constructible<T>::value) :
+        is_present_(false)
+    {
+        if (other.is_present_)
+            construct(std::move(other.value()));
+    }
+    maybe_storage& operator = (const maybe_storage& other)
+    {
+        if (is_present_ && other.is_present_)
+            value() = other.value();
+        else if (other.is_present_)
+            construct(other.value());
+        else
+            destroy();
+        return *this;
+    }
+    maybe_storage& operator = (maybe_storage&& other)
+        noexcept(std::is_nothrow_move_constructible<T>::value &&
+            std::is_nothrow_move_assignable<T>::value)
+    {
+        if (is_present_ && other.is_present_)
+            value() = std::move(other.value());
+        else if (other.is_present_)
+            construct(std::move(other.value()));
+        else
+            destroy();
+        return *this;
+    }
+    ~maybe_storage() { destroy(); }
+    bool is_present() const { return is_present_; }
+    const T& value() const { return *reinterpret_cast<const T*>(&storage_); }
+    T& value() { return *reinterpret_cast<T*>(&storage_); }
+    template <typename... Args>
+    void construct(Args&&... args)
+    {
+        assert(!is_present_);
+        new (&storage_) T(std::forward<Args>(args)...);
+        is_present_ = true;
+    }
+    void destroy()
+    {
+        if (is_present_)
+            value().~T();
+        is_present_ = false;
+    }
+private:
+    typename std::aligned_storage<sizeof(T),
+        std::alignment_of<T>::value>::type storage_;
+    bool is_present_;
+};
+
+} // namespace internal
+
 // Can hold a value of type T or nothing.
+// The value is stored inline, so no heap allocation takes place.
 template <typename T>
-class maybe
+class maybe : private internal::maybe_storage<T>
 {
 public:
-    maybe(const maybe<T>& other) :
-        ptr_(other.get() ? ptr_t( new T(*other.get())) : ptr_t())
-        {}
-    bool is_just() const { return static_cast<bool>(get()); }
-    const T& unsafe_get_just() const { assert(is_just()); return *get(); }
+    bool is_just() const { return this->is_present(); }
+    const T& unsafe_get_just() const { assert(is_just()); return this->value(); }
+    // Replaces the current value (if any)
+    // by one constructed in place from args.
+    template <typename... Args>
+    void emplace(Args&&... args)
+    {
+        this->destroy();
+        this->construct(std::forward<Args>(args)...);
+    }
     typedef T type;
 private:
     maybe() {}
     friend maybe<T> just<T>(const T& val);
     friend maybe<T> nothing<T>();
-    typedef std::unique_ptr<T> ptr_t;
-    const ptr_t& get() const { return ptr_; }
-    ptr_t ptr_;
 };
 
 // Is not nothing?
@@ -89,7 +188,7 @@ template <typename T>
 maybe<T> just(const T& val)
 {
     maybe<T> x;
-    x.ptr_.reset(new T(val));
+    x.emplace(val);
     return x;
 }
 
@@ -92,7 +92,7 @@ template <typename F,
 std::function<const FIn&(const FIn& x, const FIn& y)>
         min_2_by(F f)
 {
-    return [f](const FIn& x, const FIn& y)
+    return [f](const FIn& x, const FIn& y) -> const FIn&
     {
         return f(x) < f(y) ? x : y;
     };
@@ -103,7 +103,7 @@ template <typename F,
 std::function<const FIn&(const FIn& x, const FIn& y)>
         max_2_by(F f)
 {
-    return [f](const FIn& x, const FIn& y)
+    return [f](const FIn& x, const FIn& y) -> const FIn&
     {
         return f(x) > f(y) ? x : y;
     };
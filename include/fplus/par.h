@@ -0,0 +1,591 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "container_common.h"
+#include "container_properties.h"
+#include "container_traits.h"
+#include "filter.h"
+#include "function_traits.h"
+#include "generate.h"
+#include "maybe.h"
+#include "split.h"
+#include "transform.h"
+
+namespace fplus
+{
+
+// The functions in fplus::par do the same as their namesakes in fplus,
+// but split random access inputs into contiguous chunks,
+// which are processed concurrently on a shared thread pool.
+// The results are combined in input order,
+// so they are the same as the ones of the sequential versions.
+// Inputs with less than min_parallel_size() elements
+// are handed to the sequential versions directly.
+//
+// par::transform(f, xs) == transform(f, xs)
+//
+// The functions passed in are called from several threads at once.
+namespace par
+{
+
+// Inputs shorter than this are processed sequentially.
+// par::min_parallel_size() = 100000;
+inline std::atomic<std::size_t>& min_parallel_size()
+{
+    static std::atomic<std::size_t> size(10000);
+    return size;
+}
+
+namespace internal
+{
+
+// Fixed set of worker threads executing tasks from a shared queue.
+class thread_pool
+{
+public:
+    explicit thread_pool(std::size_t workers) : stop_(false)
+    {
+        for (std::size_t i = 0; i < workers; ++i)
+            workers_.emplace_back([this]() { work(); });
+    }
+    ~thread_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_)
+            worker.join();
+    }
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator = (const thread_pool&) = delete;
+
+    // Number of threads working on a run, including the calling one.
+    std::size_t size() const { return workers_.size() + 1; }
+
+    // Calls f(0), f(1), ..., f(n - 1) concurrently
+    // and returns when all of them are finished.
+    // The calling thread takes part, so nested runs do not deadlock.
+    // The first exception thrown by f is rethrown.
+    template <typename F>
+    void run(std::size_t n, F f)
+    {
+        if (n == 0)
+            return;
+        batch tasks(n);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (std::size_t i = 1; i < n; ++i)
+                tasks_.push_back([&tasks, &f, i]() { tasks.execute(f, i); });
+        }
+        wake_.notify_all();
+        tasks.execute(f, 0);
+        while (!tasks.finished())
+        {
+            // Once the queue is empty, the remaining tasks
+            // of this run are being executed by other threads.
+            if (!run_pending_task())
+                tasks.wait();
+        }
+        tasks.rethrow();
+    }
+
+private:
+    class batch
+    {
+    public:
+        explicit batch(std::size_t n) : remaining_(n) {}
+        template <typename F>
+        void execute(F& f, std::size_t i)
+        {
+            std::exception_ptr error;
+            try
+            {
+                f(i);
+            }
+            catch (...)
+            {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (error && !error_)
+                error_ = error;
+            if (--remaining_ == 0)
+                done_.notify_all();
+        }
+        bool finished()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return remaining_ == 0;
+        }
+        void wait()
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this]() { return remaining_ == 0; });
+        }
+        void rethrow() const
+        {
+            if (error_)
+                std::rethrow_exception(error_);
+        }
+    private:
+        std::mutex mutex_;
+        std::condition_variable done_;
+        std::size_t remaining_;
+        std::exception_ptr error_;
+    };
+
+    bool run_pending_task()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty())
+                return false;
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+        return true;
+    }
+
+    void work()
+    {
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+};
+
+// Started on first use with one thread per hardware thread, but at least two.
+inline thread_pool& default_pool()
+{
+    static thread_pool pool(
+        std::max<std::size_t>(std::thread::hardware_concurrency(), 2) - 1);
+    return pool;
+}
+
+template <typename Container>
+void check_random_access()
+{
+    typedef typename std::iterator_traits<
+        typename Container::const_iterator>::iterator_category Category;
+    static_assert(std::is_base_of<std::random_access_iterator_tag,
+        Category>::value, "Container must provide random access.");
+}
+
+// 1 means the input is to be processed sequentially.
+inline std::size_t chunk_count(std::size_t size)
+{
+    if (size == 0 || size < min_parallel_size().load())
+        return 1;
+    return std::min(default_pool().size(), size);
+}
+
+// Calls f(chunk_idx, begin_idx, end_idx) for chunks of about equal size
+// covering [0, size).
+template <typename F>
+void for_each_chunk(std::size_t chunks, std::size_t size, F f)
+{
+    default_pool().run(chunks, [&](std::size_t chunk)
+    {
+        f(chunk, chunk * size / chunks, (chunk + 1) * size / chunks);
+    });
+}
+
+template <typename Container>
+Container concat_chunks(std::vector<Container>& parts)
+{
+    std::size_t size = 0;
+    for (const auto& part : parts)
+        size += size_of_cont(part);
+    Container result = std::move(parts.front());
+    prepare_container(result, size);
+    for (std::size_t i = 1; i < parts.size(); ++i)
+    {
+        result.insert(std::end(result),
+            std::make_move_iterator(std::begin(parts[i])),
+            std::make_move_iterator(std::end(parts[i])));
+    }
+    return result;
+}
+
+// Writing elements of a pre-sized container from several threads is fine,
+// except for the bits of a std::vector<bool>.
+template <typename Container, typename T = typename Container::value_type>
+struct can_assign_concurrently : public std::integral_constant<bool,
+    std::is_default_constructible<T>::value &&
+    !std::is_same<T, bool>::value> {};
+
+// [g(0), g(1), ..., g(size - 1)]
+template <typename ContainerOut, typename G>
+ContainerOut generate_chunked(std::size_t chunks, std::size_t size, G g,
+    std::true_type)
+{
+    ContainerOut ys;
+    ys.resize(size);
+    const auto first = std::begin(ys);
+    for_each_chunk(chunks, size,
+        [&](std::size_t, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            first[i] = g(i);
+    });
+    return ys;
+}
+
+template <typename ContainerOut, typename G>
+ContainerOut generate_chunked(std::size_t chunks, std::size_t size, G g,
+    std::false_type)
+{
+    std::vector<ContainerOut> parts(chunks);
+    for_each_chunk(chunks, size,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        ContainerOut& part = parts[chunk];
+        prepare_container(part, end - begin);
+        auto it = get_back_inserter<ContainerOut>(part);
+        for (std::size_t i = begin; i < end; ++i)
+            *it = g(i);
+    });
+    return concat_chunks(parts);
+}
+
+template <typename ContainerOut, typename G>
+ContainerOut generate_chunked(std::size_t chunks, std::size_t size, G g)
+{
+    return generate_chunked<ContainerOut>(chunks, size, g,
+        can_assign_concurrently<ContainerOut>());
+}
+
+template <bool Expected, typename UnaryPredicate, typename Container>
+bool any_chunk_finds(std::size_t chunks, UnaryPredicate p,
+    const Container& xs)
+{
+    std::atomic<bool> found(false);
+    const auto first = std::begin(xs);
+    for_each_chunk(chunks, size_of_cont(xs),
+        [&](std::size_t, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (found.load(std::memory_order_relaxed))
+                return;
+            if (static_cast<bool>(p(first[i])) == Expected)
+            {
+                found.store(true, std::memory_order_relaxed);
+                return;
+            }
+        }
+    });
+    return found.load();
+}
+
+} // namespace internal
+
+// par::transform((*2), [1, 3, 4]) == [2, 6, 8]
+template <typename F, typename ContainerIn,
+    typename ContainerOut = typename same_cont_new_t_from_unary_f<ContainerIn, F>::type>
+ContainerOut transform(F f, const ContainerIn& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    internal::check_random_access<ContainerIn>();
+    const std::size_t size = size_of_cont(xs);
+    const std::size_t chunks = internal::chunk_count(size);
+    if (chunks == 1)
+        return fplus::transform<F, ContainerIn, ContainerOut>(f, xs);
+    const auto first = std::begin(xs);
+    return internal::generate_chunked<ContainerOut>(chunks, size,
+        [&](std::size_t i) { return f(first[i]); });
+}
+
+// par::transform_with_idx(f, [6, 4, 7]) == [f(0, 6), f(1, 4), f(2, 7)]
+template <typename F, typename ContainerIn,
+    typename ContainerOut = typename same_cont_new_t_from_binary_f< ContainerIn, F, std::size_t, typename ContainerIn::value_type>::type>
+ContainerOut transform_with_idx(F f, const ContainerIn& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 2, "Wrong arity.");
+    internal::check_random_access<ContainerIn>();
+    const std::size_t size = size_of_cont(xs);
+    const std::size_t chunks = internal::chunk_count(size);
+    if (chunks == 1)
+        return fplus::transform_with_idx<F, ContainerIn, ContainerOut>(f, xs);
+    const auto first = std::begin(xs);
+    return internal::generate_chunked<ContainerOut>(chunks, size,
+        [&](std::size_t i) { return f(i, first[i]); });
+}
+
+// par::generate_by_idx(f, 3) == [f(0), f(1), f(2)]
+template <typename ContainerOut, typename F>
+ContainerOut generate_by_idx(F f, std::size_t amount)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    typedef typename utils::function_traits<F>::template arg<0>::type FIn;
+    static_assert(std::is_convertible<std::size_t, FIn>::value, "Function does not take std::size_t or compatible type.");
+    internal::check_random_access<ContainerOut>();
+    const std::size_t chunks = internal::chunk_count(amount);
+    if (chunks == 1)
+        return fplus::generate_by_idx<ContainerOut>(f, amount);
+    return internal::generate_chunked<ContainerOut>(chunks, amount,
+        [&](std::size_t i) { return f(i); });
+}
+
+// par::keep_if(is_even, [1, 2, 3, 2, 4, 5]) == [2, 2, 4]
+template <typename UnaryPredicate, typename Container>
+Container keep_if(UnaryPredicate pred, const Container& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    internal::check_random_access<Container>();
+    const std::size_t chunks = internal::chunk_count(size_of_cont(xs));
+    if (chunks == 1)
+        return fplus::keep_if(pred, xs);
+    std::vector<Container> parts(chunks);
+    const auto first = std::begin(xs);
+    internal::for_each_chunk(chunks, size_of_cont(xs),
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        auto it = get_back_inserter<Container>(parts[chunk]);
+        std::copy_if(first + begin, first + end, it, pred);
+    });
+    return internal::concat_chunks(parts);
+}
+
+// par::drop_if(is_even, [1, 2, 3, 2, 4, 5]) == [1, 3, 5]
+template <typename UnaryPredicate, typename Container>
+Container drop_if(UnaryPredicate pred, const Container& xs)
+{
+    return keep_if(logical_not(pred), xs);
+}
+
+// par::count_if(is_even, [1, 2, 3, 5, 7, 8]) == 2
+template <typename UnaryPredicate, typename Container>
+std::size_t count_if(UnaryPredicate p, const Container& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    internal::check_random_access<Container>();
+    const std::size_t chunks = internal::chunk_count(size_of_cont(xs));
+    if (chunks == 1)
+        return fplus::count_if(p, xs);
+    std::vector<std::size_t> counts(chunks, 0);
+    const auto first = std::begin(xs);
+    internal::for_each_chunk(chunks, size_of_cont(xs),
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        counts[chunk] = static_cast<std::size_t>(
+            std::count_if(first + begin, first + end, p));
+    });
+    return fplus::sum(counts);
+}
+
+// par::all_by(is_even, [2, 4, 6]) == true
+// Chunks stop early once another chunk found a counterexample.
+template <typename UnaryPredicate, typename Container>
+bool all_by(UnaryPredicate p, const Container& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    internal::check_random_access<Container>();
+    const std::size_t chunks = internal::chunk_count(size_of_cont(xs));
+    if (chunks == 1)
+        return fplus::all_by(p, xs);
+    return !internal::any_chunk_finds<false>(chunks, p, xs);
+}
+
+// par::any_by(is_odd, [2, 4, 6]) == false
+// Chunks stop early once another chunk found a match.
+template <typename UnaryPredicate, typename Container>
+bool any_by(UnaryPredicate p, const Container& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    internal::check_random_access<Container>();
+    const std::size_t chunks = internal::chunk_count(size_of_cont(xs));
+    if (chunks == 1)
+        return fplus::any_by(p, xs);
+    return internal::any_chunk_finds<true>(chunks, p, xs);
+}
+
+// par::fold_left((+), 0, [1, 2, 3]) == 6
+// f has to be associative, because the chunks are folded separately
+// and their results are then folded into init from left to right.
+template <typename F, typename Container,
+    typename Acc = typename utils::function_traits<F>::template arg<0>::type>
+Acc fold_left(F f, const Acc& init, const Container& xs)
+{
+    static_assert(std::is_convertible<typename Container::value_type, Acc>::value, "Elements must be convertible to the accumulator type.");
+    internal::check_random_access<Container>();
+    const std::size_t chunks = internal::chunk_count(size_of_cont(xs));
+    if (chunks == 1)
+        return fplus::fold_left(f, init, xs);
+    std::vector<maybe<Acc>> partials(chunks, nothing<Acc>());
+    const auto first = std::begin(xs);
+    internal::for_each_chunk(chunks, size_of_cont(xs),
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        Acc acc = first[begin];
+        for (std::size_t i = begin + 1; i < end; ++i)
+            acc = f(acc, first[i]);
+        partials[chunk] = just(acc);
+    });
+    Acc acc = init;
+    for (const auto& partial : partials)
+        acc = f(acc, unsafe_get_just(partial));
+    return acc;
+}
+
+// par::sum([1, 2, 3]) == 6
+// Floating point sums can differ slightly from the sequential ones,
+// since the additions are grouped differently.
+template <typename Container>
+typename Container::value_type sum(const Container& xs)
+{
+    typedef typename Container::value_type X;
+    return fold_left([](const X& acc, const X& x) { return acc+x; }, X(), xs);
+}
+
+namespace internal
+{
+
+// Histograms of the chunks, which are added up afterwards.
+template <typename MapOut, typename Container>
+MapOut count_occurrences_chunked(std::size_t chunks, const Container& xs,
+    std::false_type)
+{
+    typedef typename Container::value_type T;
+    std::vector<fplus::internal::flat_counter<T>> parts(chunks);
+    const auto first = std::begin(xs);
+    for_each_chunk(chunks, size_of_cont(xs),
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            parts[chunk].add(first[i], 1);
+    });
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+        for (const auto& entry : parts[chunk].entries())
+            parts.front().add(entry.first, entry.second);
+    MapOut result;
+    for (const auto& entry : parts.front().entries())
+        result[entry.first] += entry.second;
+    return result;
+}
+
+template <typename MapOut, typename Container>
+MapOut count_occurrences_chunked(std::size_t chunks, const Container& xs,
+    std::true_type)
+{
+    typedef typename Container::value_type T;
+    const std::size_t size = size_of_cont(xs);
+    if (!fplus::internal::use_counting_array<T>(size))
+        return count_occurrences_chunked<MapOut>(chunks, xs,
+            std::false_type());
+    const std::size_t domain =
+        fplus::internal::small_integral_domain_size<T>();
+    std::vector<std::vector<std::size_t>> parts(chunks);
+    const auto first = std::begin(xs);
+    for_each_chunk(chunks, size,
+        [&](std::size_t chunk, std::size_t begin, std::size_t end)
+    {
+        parts[chunk].assign(domain, 0);
+        fplus::internal::add_counts(parts[chunk], first + begin, first + end);
+    });
+    for (std::size_t chunk = 1; chunk < chunks; ++chunk)
+        for (std::size_t i = 0; i < domain; ++i)
+            parts.front()[i] += parts[chunk][i];
+    return fplus::internal::map_from_counts<T, MapOut>(parts.front());
+}
+
+} // namespace internal
+
+// par::count_occurrences([1,2,2,3,2)) == [(1, 1), (2, 3), (3, 1)]
+// Every chunk is counted into its own histogram,
+// an array for integral types of up to 16 bits
+// and a flat hash table otherwise, so the elements need std::hash.
+template <typename ContainerIn,
+    typename MapOut = std::map<typename ContainerIn::value_type, std::size_t>>
+MapOut count_occurrences(const ContainerIn& xs)
+{
+    typedef typename ContainerIn::value_type T;
+    internal::check_random_access<ContainerIn>();
+    const std::size_t chunks = internal::chunk_count(size_of_cont(xs));
+    if (chunks == 1)
+        return fplus::count_occurrences<ContainerIn, MapOut>(xs);
+    return internal::count_occurrences_chunked<MapOut>(chunks, xs,
+        fplus::internal::can_count_in_array<MapOut, T>());
+}
+
+// par::sort_by((<), [3, 1, 2]) == [1, 2, 3]
+// The chunks are sorted concurrently and then merged pairwise.
+// Unlike with sort_by, equivalent elements keep their relative order.
+template <typename Compare, typename Container>
+Container sort_by(Compare comp, const Container& xs)
+{
+    internal::check_random_access<Container>();
+    const std::size_t size = size_of_cont(xs);
+    const std::size_t chunks = internal::chunk_count(size);
+    Container result = xs;
+    const auto first = std::begin(result);
+    if (chunks == 1)
+    {
+        std::stable_sort(first, std::end(result), comp);
+        return result;
+    }
+    internal::for_each_chunk(chunks, size,
+        [&](std::size_t, std::size_t begin, std::size_t end)
+    {
+        std::stable_sort(first + begin, first + end, comp);
+    });
+    auto bound = [&](std::size_t chunk)
+    {
+        return first + std::min(chunk, chunks) * size / chunks;
+    };
+    for (std::size_t width = 1; width < chunks; width *= 2)
+    {
+        const std::size_t merges = (chunks + 2 * width - 1) / (2 * width);
+        internal::default_pool().run(merges, [&](std::size_t merge)
+        {
+            const std::size_t chunk = merge * 2 * width;
+            if (chunk + width < chunks)
+                std::inplace_merge(bound(chunk), bound(chunk + width),
+                    bound(chunk + 2 * width), comp);
+        });
+    }
+    return result;
+}
+
+} // namespace par
+
+} // namespace fplus
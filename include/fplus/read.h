@@ -6,127 +6,389 @@
 
 #pragma once
 
+#include "c_locale.h"
+#include "container_common.h"
 #include "maybe.h"
 #include "result.h"
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 namespace fplus
 {
 
+// The parsers below do not throw and read numbers like the "C" locale,
+// whatever locale is set.
+// Their error messages are short enough to not allocate.
+// Like std::stoi and std::stod they skip leading whitespace
+// and accept an optional sign, but the whole string must be used.
 namespace
 {
+    inline const char* internal_helper_skip_space(
+        const char* first, const char* last)
+    {
+        while (first != last && (*first == ' ' ||
+            (*first >= '\t' && *first <= '\r')))
+            ++first;
+        return first;
+    }
+
+    // Returns nullptr on success and an error message otherwise.
+    template <typename T>
+    const char* internal_helper_read_integer(
+        const char* first, const char* last, T& result)
+    {
+        typedef unsigned long long U;
+        first = internal_helper_skip_space(first, last);
+        bool negative = false;
+        if (first != last && (*first == '+' || *first == '-'))
+        {
+            negative = *first == '-';
+            ++first;
+        }
+        if (first == last || *first < '0' || *first > '9')
+            return "No number.";
+        const U limit = !std::is_signed<T>::value
+            ? static_cast<U>(std::numeric_limits<T>::max())
+            : negative
+                ? static_cast<U>(std::numeric_limits<T>::max()) + 1
+                : static_cast<U>(std::numeric_limits<T>::max());
+        U value = 0;
+        for (; first != last && *first >= '0' && *first <= '9'; ++first)
+        {
+            const U digit = static_cast<U>(*first - '0');
+            if (value > (limit - digit) / 10)
+                return "Out of range.";
+            value = value * 10 + digit;
+        }
+        if (first != last)
+            return "Trailing chars.";
+        if (negative && !std::is_signed<T>::value && value != 0)
+            return "Out of range.";
+        // Negating in the unsigned domain avoids overflow for min().
+        result = negative
+            ? static_cast<T>(0 - static_cast<T>(value - 1) - 1)
+            : static_cast<T>(value);
+        return nullptr;
+    }
+
+    // Short decimals are first converted to Exact, where mantissas
+    // up to 2^53 and powers of ten up to 1e22 are exact.
+    template <typename T>
+    struct internal_helper_float_traits {};
+
+    template <>
+    struct internal_helper_float_traits<float>
+    {
+        typedef double Exact;
+        // Rounding the double again can be wrong
+        // if it lies exactly between two floats.
+        static bool narrow(double value, float& result)
+        {
+            std::uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            if ((bits & 0x1FFFFFFFu) == 0x10000000u)
+                return false;
+            result = static_cast<float>(value);
+            return true;
+        }
+        static float from_chars(const char* str, char** end)
+        {
+            return std::strtof(str, end);
+        }
+    };
+
+    template <>
+    struct internal_helper_float_traits<double>
+    {
+        typedef double Exact;
+        static bool narrow(double value, double& result)
+        {
+            result = value;
+            return true;
+        }
+        static double from_chars(const char* str, char** end)
+        {
+            return std::strtod(str, end);
+        }
+    };
+
+    template <>
+    struct internal_helper_float_traits<long double>
+    {
+        typedef long double Exact;
+        static bool narrow(long double value, long double& result)
+        {
+            result = value;
+            return true;
+        }
+        static long double from_chars(const char* str, char** end)
+        {
+            return std::strtold(str, end);
+        }
+    };
+
+    template <typename T>
+    T internal_helper_exact_pow10(int exponent)
+    {
+        T result = 1;
+        for (int i = 0; i < exponent; ++i)
+            result *= 10;
+        return result;
+    }
+
+    // Short decimal numbers are converted with one rounding step
+    // (Clinger's fast path). Everything else, including hexadecimal
+    // numbers, infinity and NaN, is handed to strtod and friends.
+    // first must point into a null-terminated string.
+    template <typename T>
+    const char* internal_helper_read_float(
+        const char* first, const char* last, T& result)
+    {
+        typedef internal_helper_float_traits<T> Traits;
+        first = internal_helper_skip_space(first, last);
+        const char* const number = first;
+        bool negative = false;
+        if (first != last && (*first == '+' || *first == '-'))
+        {
+            negative = *first == '-';
+            ++first;
+        }
+        bool slow_path = false;
+        if (first != last && (*first == 'i' || *first == 'I' ||
+            *first == 'n' || *first == 'N' ||
+            (*first == '0' && last - first > 1 &&
+                (first[1] == 'x' || first[1] == 'X'))))
+        {
+            slow_path = true;
+        }
+        std::uint64_t mantissa = 0;
+        int digits = 0;
+        int exponent = 0;
+        bool any_digit = false;
+        for (; !slow_path && first != last &&
+            *first >= '0' && *first <= '9'; ++first)
+        {
+            any_digit = true;
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 +
+                    static_cast<std::uint64_t>(*first - '0');
+                if (mantissa != 0)
+                    ++digits;
+            }
+            else
+            {
+                slow_path = true;
+            }
+        }
+        if (!slow_path && first != last && *first == '.')
+        {
+            ++first;
+            for (; first != last && *first >= '0' && *first <= '9'; ++first)
+            {
+                any_digit = true;
+                if (digits < 19)
+                {
+                    mantissa = mantissa * 10 +
+                        static_cast<std::uint64_t>(*first - '0');
+                    if (mantissa != 0)
+                        ++digits;
+                    --exponent;
+                }
+                else
+                {
+                    slow_path = true;
+                }
+            }
+        }
+        if (!slow_path && !any_digit)
+            return "No number.";
+        if (!slow_path && first != last && (*first == 'e' || *first == 'E'))
+        {
+            ++first;
+            bool negative_exponent = false;
+            if (first != last && (*first == '+' || *first == '-'))
+            {
+                negative_exponent = *first == '-';
+                ++first;
+            }
+            if (first == last || *first < '0' || *first > '9')
+                return "Trailing chars.";
+            int explicit_exponent = 0;
+            for (; first != last && *first >= '0' && *first <= '9'; ++first)
+                if (explicit_exponent < 100000)
+                    explicit_exponent = explicit_exponent * 10 +
+                        (*first - '0');
+            exponent += negative_exponent
+                ? -explicit_exponent : explicit_exponent;
+        }
+        if (!slow_path && first != last)
+            return "Trailing chars.";
+        if (!slow_path && mantissa == 0)
+        {
+            result = negative ? -T(0) : T(0);
+            return nullptr;
+        }
+        typedef typename Traits::Exact Exact;
+        if (!slow_path && mantissa <= (1ull << 53) &&
+            exponent >= -22 && exponent <= 22)
+        {
+            Exact value = static_cast<Exact>(mantissa);
+            if (exponent < 0)
+                value /= internal_helper_exact_pow10<Exact>(-exponent);
+            else
+                value *= internal_helper_exact_pow10<Exact>(exponent);
+            if (Traits::narrow(negative ? -value : value, result))
+                return nullptr;
+        }
+        T value = T();
+        const int saved_errno = errno;
+        errno = 0;
+        const char* const end = internal::parse_with_dot_decimal_point(
+            number, last, Traits::from_chars, value);
+        const bool out_of_range = errno == ERANGE;
+        errno = saved_errno;
+        if (end == number)
+            return "No number.";
+        if (end != last)
+            return "Trailing chars.";
+        if (out_of_range)
+            return "Out of range.";
+        result = value;
+        return nullptr;
+    }
+
     template <typename T>
     struct internal_helper_read_value_struct {};
 
     template <>
     struct internal_helper_read_value_struct <int>
     {
-        static void read(const std::string& str, int& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, int& result)
         {
-            result = std::stoi(str, &num_chars_used);
+            return internal_helper_read_integer(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <long>
     {
-        static void read(const std::string& str, long& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, long& result)
         {
-            result = std::stol(str, &num_chars_used);
+            return internal_helper_read_integer(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <long long>
     {
-        static void read(const std::string& str, long long& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, long long& result)
         {
-            result = std::stoll(str, &num_chars_used);
+            return internal_helper_read_integer(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <unsigned int>
     {
-        static void read(const std::string& str, unsigned int& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, unsigned int& result)
         {
-            unsigned long result_u_l = std::stoul(str, &num_chars_used);
-            result = static_cast<unsigned int>(result_u_l);
+            return internal_helper_read_integer(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <unsigned long>
     {
-        static void read(const std::string& str, unsigned long& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, unsigned long& result)
         {
-            result = std::stoul(str, &num_chars_used);
+            return internal_helper_read_integer(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <unsigned long long>
     {
-        static void read(const std::string& str, unsigned long long& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, unsigned long long& result)
         {
-            result = std::stoull(str, &num_chars_used);
+            return internal_helper_read_integer(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <float>
     {
-        static void read(const std::string& str, float& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, float& result)
         {
-            result = std::stof(str, &num_chars_used);
+            return internal_helper_read_float(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <double>
     {
-        static void read(const std::string& str, double& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, double& result)
         {
-            result = std::stod(str, &num_chars_used);
+            return internal_helper_read_float(first, last, result);
         }
     };
 
     template <>
     struct internal_helper_read_value_struct <long double>
     {
-        static void read(const std::string& str, long double& result, std::size_t& num_chars_used)
+        static const char* read(const char* first, const char* last, long double& result)
         {
-            result = std::stold(str, &num_chars_used);
+            return internal_helper_read_float(first, last, result);
         }
     };
 } // anonymous namespace
 
+// read_value_result<int>("42") == Ok 42
+// read_value_result<int>("42x") == Error "Trailing chars."
 template <typename T>
 result<T, std::string> read_value_result(const std::string& str)
 {
-    try
-    {
-        T result;
-        std::size_t num_chars_used = 0;
-        internal_helper_read_value_struct<T>::read(str, result, num_chars_used);
-        if (num_chars_used != str.size())
-        {
-            return error<T>(std::string("String not fully parsable."));
-        }
-        return ok<T, std::string>(result);
-    } catch(const std::invalid_argument& e) {
-        return error<T, std::string>(e.what());
-    } catch(const std::out_of_range& e) {
-        return error<T, std::string>(e.what());
-    }
+    T result = T();
+    const char* const error_message = internal_helper_read_value_struct<T>::
+        read(str.c_str(), str.c_str() + str.size(), result);
+    if (error_message != nullptr)
+        return error<T, std::string>(error_message);
+    return ok<T, std::string>(result);
 }
 
+// read_value<int>("42") == Just 42
+// read_value<int>("forty-two") == Nothing
 template <typename T>
 maybe<T> read_value(const std::string& str)
 {
-    return to_maybe(read_value_result<T>(str));
+    T result = T();
+    if (internal_helper_read_value_struct<T>::
+        read(str.c_str(), str.c_str() + str.size(), result) != nullptr)
+        return nothing<T>();
+    return just(result);
+}
+
+// Parses every string, keeping the positions of unparsable ones.
+// read_values<int>(["1", "x", "3"]) == [Just 1, Nothing, Just 3]
+template <typename T, typename ContainerIn,
+    typename ContainerOut = std::vector<maybe<T>>>
+ContainerOut read_values(const ContainerIn& strs)
+{
+    static_assert(std::is_same<typename ContainerIn::value_type,
+        std::string>::value, "Strings required.");
+    ContainerOut result;
+    prepare_container(result, size_of_cont(strs));
+    auto itOut = get_back_inserter(result);
+    for (const auto& str : strs)
+        *itOut = read_value<T>(str);
+    return result;
 }
 
 } // namespace fplus
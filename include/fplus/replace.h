@@ -8,8 +8,14 @@
 
 #include "container_common.h"
 #include "compare.h"
+#include "search.h"
 #include "split.h"
 
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include <utility>
+
 namespace fplus
 {
 
@@ -29,6 +35,16 @@ Container replace_if(UnaryPredicate p,
     return result;
 }
 
+template <typename UnaryPredicate, typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container replace_if(UnaryPredicate p,
+        const typename Container::value_type& dest, Container&& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, Container>();
+    std::replace_if(std::begin(xs), std::end(xs), p, dest);
+    return std::move(xs);
+}
+
 // replace_elems(4, 0, [1, 3, 4, 4, 7]) == [1, 3, 0, 0, 7]
 template <typename Container,
         typename T = typename Container::value_type>
@@ -37,13 +53,151 @@ Container replace_elems(const T& source, const T& dest, const Container& xs)
     return replace_if(bind_1st_of_2(is_equal<T>, source), dest, xs);
 }
 
+namespace internal
+{
+
+template <typename Container>
+std::size_t count_non_overlapping_instances_of_token(
+    const Container& token, const Container& xs)
+{
+    std::size_t result = 0;
+    for_each_instance_of_token(token, xs, false,
+        [&](std::size_t) -> bool
+    {
+        ++result;
+        return true;
+    });
+    return result;
+}
+
+} // namespace internal
+
+// The matches are counted in a first pass, so the result
+// is written into a container of the exact final size in a second one.
 // replace_tokens("haha", "hihi", "oh, hahaha!") == "oh, hihiha!"
 template <typename Container>
 Container replace_tokens
         (const Container& source, const Container& dest, const Container& xs)
 {
-    auto splitted = split_by_token(source, true, xs);
-    return join(dest, splitted);
+    const std::size_t matches =
+        internal::count_non_overlapping_instances_of_token(source, xs);
+    if (matches == 0)
+        return xs;
+    const std::size_t source_size = size_of_cont(source);
+    const std::size_t dest_size = size_of_cont(dest);
+    Container result;
+    prepare_container(result, size_of_cont(xs) +
+        matches * dest_size - matches * source_size);
+    auto itIn = std::begin(xs);
+    std::size_t idxIn = 0;
+    internal::for_each_instance_of_token(source, xs, false,
+        [&](std::size_t idx) -> bool
+    {
+        auto itMatch = itIn;
+        std::advance(itMatch, idx - idxIn);
+        result.insert(std::end(result), itIn, itMatch);
+        result.insert(std::end(result), std::begin(dest), std::end(dest));
+        itIn = itMatch;
+        std::advance(itIn, source_size);
+        idxIn = idx + source_size;
+        return true;
+    });
+    result.insert(std::end(result), itIn, std::end(xs));
+    return result;
+}
+
+// Tokens of equal length are replaced in place.
+// The search never looks back at a match it has reported,
+// so each one is overwritten right away.
+template <typename Container,
+    typename = enable_if_reusable_container_t<Container>>
+Container replace_tokens
+        (const Container& source, const Container& dest, Container&& xs)
+{
+    const std::size_t source_size = size_of_cont(source);
+    if (source_size == 0 || source_size != size_of_cont(dest))
+        return replace_tokens(source, dest, static_cast<const Container&>(xs));
+    auto itIn = std::begin(xs);
+    std::size_t idxIn = 0;
+    internal::for_each_instance_of_token(source, xs, false,
+        [&](std::size_t idx) -> bool
+    {
+        std::advance(itIn, idx - idxIn);
+        itIn = std::copy(std::begin(dest), std::end(dest), itIn);
+        idxIn = idx + source_size;
+        return true;
+    });
+    return std::move(xs);
+}
+
+// Replaces every instance of automaton.token(i) by dests[i].
+// Instances are chosen from left to right. Of those starting
+// at the same position the longest one wins, and the replaced
+// parts do not overlap.
+template <typename Container, typename ContainerDests>
+Container replace_tokens_many(const token_automaton<Container>& automaton,
+    const ContainerDests& dests, const Container& xs)
+{
+    static_assert(std::is_same<Container,
+        typename ContainerDests::value_type>::value,
+        "Containers do not match.");
+    assert(size_of_cont(dests) == automaton.token_count());
+    // (position, (-length, token index)), sorted
+    typedef std::pair<std::size_t,
+        std::pair<std::ptrdiff_t, std::size_t>> Instance;
+    std::vector<Instance> instances;
+    automaton.for_each_instance(xs,
+        [&](std::size_t token_idx, std::size_t pos)
+    {
+        const std::size_t length = size_of_cont(automaton.token(token_idx));
+        assert(length > 0);
+        instances.push_back(std::make_pair(pos, std::make_pair(
+            -static_cast<std::ptrdiff_t>(length), token_idx)));
+    });
+    std::sort(std::begin(instances), std::end(instances));
+    const std::vector<Container> dest_vec(std::begin(dests), std::end(dests));
+    Container result;
+    prepare_container(result, size_of_cont(xs));
+    auto itOut = get_back_inserter(result);
+    auto itIn = std::begin(xs);
+    std::size_t idx = 0;
+    for (const auto& instance : instances)
+    {
+        const std::size_t pos = instance.first;
+        if (pos < idx)
+            continue;
+        auto itMatch = itIn;
+        std::advance(itMatch, pos - idx);
+        itOut = std::copy(itIn, itMatch, itOut);
+        const Container& dest = dest_vec[instance.second.second];
+        itOut = std::copy(std::begin(dest), std::end(dest), itOut);
+        const std::size_t length =
+            static_cast<std::size_t>(-instance.second.first);
+        itIn = itMatch;
+        std::advance(itIn, length);
+        idx = pos + length;
+    }
+    std::copy(itIn, std::end(xs), itOut);
+    return result;
+}
+
+// Replaces the keys of mapping by their values in one pass.
+// Empty keys are not allowed.
+// replace_tokens_many([("he", "HE"), ("hers", "X")], "ushers and he")
+//     == "usX and HE"
+template <typename Mapping, typename Container>
+Container replace_tokens_many(const Mapping& mapping, const Container& xs)
+{
+    std::vector<Container> sources;
+    std::vector<Container> dests;
+    sources.reserve(size_of_cont(mapping));
+    dests.reserve(size_of_cont(mapping));
+    for (const auto& source_and_dest : mapping)
+    {
+        sources.push_back(source_and_dest.first);
+        dests.push_back(source_and_dest.second);
+    }
+    return replace_tokens_many(make_token_automaton(sources), dests, xs);
 }
 
 } // namespace fplus
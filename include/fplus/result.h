@@ -11,7 +11,9 @@
 
 #include <cassert>
 #include <functional>
-#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace fplus
 {
@@ -26,36 +28,127 @@ template <typename Ok, typename Error>
 result<Ok, Error> error(const Error& error);
 
 // Can hold a value of type Ok or an error of type Error.
+// Both are stored inline in a union, so no heap allocation takes place.
 template <typename Ok, typename Error>
 class result
 {
 public:
-    result(const result<Ok, Error>& other) :
-        ptr_ok_(other.get_ok() ? ptr_ok( new Ok(*other.get_ok())) : ptr_ok()),
-        ptr_error_(other.get_error() ? ptr_error( new Error(*other.get_error())) : ptr_error())
+    result(const result<Ok, Error>& other) : is_ok_(other.is_ok_)
+    {
+        if (is_ok_)
+            new (&ok_) Ok(other.ok_);
+        else
+            new (&error_) Error(other.error_);
+    }
+    result(result<Ok, Error>&& other)
+        noexcept(std::is_nothrow_move_constructible<Ok>::value &&
+            std::is_nothrow_move_constructible<Error>::value) :
+        is_ok_(other.is_ok_)
+    {
+        construct_from(std::move(other));
+    }
+    result<Ok, Error>& operator = (const result<Ok, Error>& other)
+    {
+        if (is_ok_ && other.is_ok_)
+            ok_ = other.ok_;
+        else if (!is_ok_ && !other.is_ok_)
+            error_ = other.error_;
+        else
+            *this = result<Ok, Error>(other);
+        return *this;
+    }
+    result<Ok, Error>& operator = (result<Ok, Error>&& other)
+        noexcept(std::is_nothrow_move_constructible<Ok>::value &&
+            std::is_nothrow_move_constructible<Error>::value &&
+            std::is_nothrow_move_assignable<Ok>::value &&
+            std::is_nothrow_move_assignable<Error>::value)
+    {
+        if (is_ok_ && other.is_ok_)
+            ok_ = std::move(other.ok_);
+        else if (!is_ok_ && !other.is_ok_)
+            error_ = std::move(other.error_);
+        else if (is_ok_)
         {
-            check_either_or_invariant();
+            replace_alternative(ok_, error_, other.error_);
+            is_ok_ = false;
         }
-    bool is_ok() const { return static_cast<bool>(get_ok()); }
-    bool is_error() const { return static_cast<bool>(get_error()); }
-    const Ok& unsafe_get_ok() const { check_either_or_invariant(); assert(is_ok()); return *get_ok(); }
-    const Error& unsafe_get_error() const { check_either_or_invariant(); assert(is_error()); return *get_error(); }
+        else
+        {
+            replace_alternative(error_, ok_, other.ok_);
+            is_ok_ = true;
+        }
+        return *this;
+    }
+    ~result()
+    {
+        destroy();
+    }
+    bool is_ok() const { return is_ok_; }
+    bool is_error() const { return !is_ok_; }
+    const Ok& unsafe_get_ok() const { assert(is_ok()); return ok_; }
+    const Error& unsafe_get_error() const { assert(is_error()); return error_; }
     typedef Ok ok_t;
     typedef Error error_t;
 private:
-    void check_either_or_invariant() const
+    struct ok_tag {};
+    struct error_tag {};
+    template <typename... Args>
+    explicit result(ok_tag, Args&&... args) :
+        ok_(std::forward<Args>(args)...), is_ok_(true) {}
+    template <typename... Args>
+    explicit result(error_tag, Args&&... args) :
+        error_(std::forward<Args>(args)...), is_ok_(false) {}
+    void construct_from(result<Ok, Error>&& other)
+    {
+        if (is_ok_)
+            new (&ok_) Ok(std::move(other.ok_));
+        else
+            new (&error_) Error(std::move(other.error_));
+    }
+    // Destroys old and moves value into place, which shares its storage.
+    // If that throws, old gets its value back, so the result stays valid.
+    // Only if this throws too, std::terminate is called.
+    template <typename Old, typename New>
+    static void replace_alternative(Old& old, New& place, New& value)
     {
-        assert(is_ok() != is_error());
+        if (std::is_nothrow_move_constructible<New>::value)
+        {
+            old.~Old();
+            new (&place) New(std::move(value));
+            return;
+        }
+        Old backup(std::move(old));
+        old.~Old();
+        try
+        {
+            new (&place) New(std::move(value));
+        }
+        catch (...)
+        {
+            restore(old, backup);
+            throw;
+        }
+    }
+    template <typename T>
+    static void restore(T& place, T& backup) noexcept
+    {
+        new (&place) T(std::move(backup));
+    }
+    void destroy()
+    {
+        if (is_ok_)
+            ok_.~Ok();
+        else
+            error_.~Error();
     }
-    result() {}
     friend result<Ok, Error> ok<Ok, Error>(const Ok& ok);
     friend result<Ok, Error> error<Ok, Error>(const Error& error);
-    typedef std::unique_ptr<Ok> ptr_ok;
-    typedef std::unique_ptr<Error> ptr_error;
-    const ptr_ok& get_ok() const { return ptr_ok_; }
-    const ptr_error& get_error() const { return ptr_error_; }
-    ptr_ok ptr_ok_;
-    ptr_error ptr_error_;
+    union
+    {
+        Ok ok_;
+        Error error_;
+    };
+    bool is_ok_;
 };
 
 // Is not error?
@@ -99,18 +192,15 @@ Ok ok_with_default(const Ok& defaultValue, const result<Ok, Error>& result)
 template <typename Ok, typename Error>
 result<Ok, Error> ok(const Ok& val)
 {
-    result<Ok, Error> x;
-    x.ptr_ok_.reset(new Ok(val));
-    return x;
+    return result<Ok, Error>(typename result<Ok, Error>::ok_tag(), val);
 }
 
 // Construct an error of a certain result type.
 template <typename Ok, typename Error>
 result<Ok, Error> error(const Error& error)
 {
-    result<Ok, Error> x;
-    x.ptr_error_.reset(new Error(error));
-    return x;
+    return result<Ok, Error>(
+        typename result<Ok, Error>::error_tag(), error);
 }
 
 // Convert ok to just, error to nothing.
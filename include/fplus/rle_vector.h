@@ -0,0 +1,280 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "container_common.h"
+#include "container_properties.h"
+#include "container_traits.h"
+#include "filter.h"
+#include "function_traits.h"
+#include "maybe.h"
+#include "search.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fplus
+{
+
+// Sequence stored as runs of equal elements,
+// in the (count, value) format run_length_encode returns.
+// Adjacent runs always differ and no run is empty.
+// Its iterators visit every element, so the functions of fplus
+// reading their input sequentially accept it too.
+// size_of_cont, elem_at_idx, sum, count, find_first_idx,
+// transform and keep_if work on the runs directly.
+// rle_vector<int>([(3, 1), (2, 5)]) == [1,1,1,5,5]
+template <typename T>
+class rle_vector
+{
+public:
+    typedef T value_type;
+    typedef std::pair<std::size_t, T> run_type;
+    typedef std::size_t size_type;
+
+    // Forward iterator visiting every element of every run.
+    class const_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef const T& reference;
+        const_iterator() : run_(nullptr), offset_(0) {}
+        const_iterator(const run_type* run, std::size_t offset) :
+            run_(run), offset_(offset) {}
+        reference operator * () const { return run_->second; }
+        pointer operator -> () const { return &run_->second; }
+        const_iterator& operator ++ ()
+        {
+            if (++offset_ == run_->first)
+            {
+                ++run_;
+                offset_ = 0;
+            }
+            return *this;
+        }
+        const_iterator operator ++ (int)
+        {
+            const_iterator result = *this;
+            ++*this;
+            return result;
+        }
+        bool operator == (const const_iterator& other) const
+        {
+            return run_ == other.run_ && offset_ == other.offset_;
+        }
+        bool operator != (const const_iterator& other) const
+        {
+            return !(*this == other);
+        }
+    private:
+        const run_type* run_;
+        std::size_t offset_;
+    };
+    typedef const_iterator iterator;
+
+    rle_vector() {}
+
+    // Empty runs are dropped and equal neighbors merged.
+    template <typename ContainerIn>
+    explicit rle_vector(const ContainerIn& runs)
+    {
+        for (const auto& run : runs)
+            append_run(run.first, run.second);
+    }
+
+    template <typename InputIterator>
+    rle_vector(InputIterator first, InputIterator last)
+    {
+        for (; first != last; ++first)
+            push_back(*first);
+    }
+
+    void push_back(const T& x)
+    {
+        append_run(1, x);
+    }
+
+    void append_run(std::size_t count, const T& x)
+    {
+        if (count == 0)
+            return;
+        if (!runs_.empty() && runs_.back().second == x)
+        {
+            runs_.back().first += count;
+            ends_.back() += count;
+            return;
+        }
+        runs_.push_back(run_type(count, x));
+        ends_.push_back(size() + count);
+    }
+
+    std::size_t size() const { return ends_.empty() ? 0 : ends_.back(); }
+    bool empty() const { return runs_.empty(); }
+    const std::vector<run_type>& runs() const { return runs_; }
+
+    // Index of the run containing the element at idx.
+    // O(log(number of runs))
+    std::size_t run_idx(std::size_t idx) const
+    {
+        assert(idx < size());
+        return static_cast<std::size_t>(std::distance(std::begin(ends_),
+            std::upper_bound(std::begin(ends_), std::end(ends_), idx)));
+    }
+
+    // Index of the first element of a run.
+    std::size_t run_start(std::size_t run_idx) const
+    {
+        return run_idx == 0 ? 0 : ends_[run_idx - 1];
+    }
+
+    const T& operator [] (std::size_t idx) const
+    {
+        return runs_[run_idx(idx)].second;
+    }
+
+    const_iterator begin() const
+    {
+        return const_iterator(runs_.data(), 0);
+    }
+    const_iterator end() const
+    {
+        return const_iterator(runs_.data() + runs_.size(), 0);
+    }
+
+    bool operator == (const rle_vector& other) const
+    {
+        return runs_ == other.runs_;
+    }
+    bool operator != (const rle_vector& other) const
+    {
+        return !(*this == other);
+    }
+
+private:
+    std::vector<run_type> runs_;
+    // Prefix sums of the run lengths.
+    std::vector<std::size_t> ends_;
+};
+
+template <typename T>
+struct has_order<rle_vector<T>> : public std::true_type {};
+
+template <typename T, typename NewT>
+struct same_cont_new_t<rle_vector<T>, NewT>
+{
+    typedef rle_vector<NewT> type;
+};
+
+// to_rle_vector([1,1,1,5,5]) == rle_vector<int>([(3, 1), (2, 5)])
+template <typename ContainerIn,
+    typename T = typename ContainerIn::value_type>
+rle_vector<T> to_rle_vector(const ContainerIn& xs)
+{
+    return rle_vector<T>(std::begin(xs), std::end(xs));
+}
+
+// O(log(number of runs))
+template <typename T>
+T elem_at_idx(std::size_t idx, const rle_vector<T>& xs)
+{
+    assert(idx < size_of_cont(xs));
+    return xs[idx];
+}
+
+namespace internal
+{
+
+template <typename T>
+T sum_runs(const rle_vector<T>& xs, std::true_type)
+{
+    T acc = T();
+    for (const auto& run : xs.runs())
+        acc += static_cast<T>(run.first) * run.second;
+    return acc;
+}
+
+template <typename T>
+T sum_runs(const rle_vector<T>& xs, std::false_type)
+{
+    T acc = T();
+    for (const auto& run : xs.runs())
+        for (std::size_t i = 0; i < run.first; ++i)
+            acc = acc + run.second;
+    return acc;
+}
+
+} // namespace internal
+
+// Arithmetic runs are multiplied instead of being added up element-wise,
+// so floating point sums can differ slightly from the ones of sum.
+template <typename T>
+T sum(const rle_vector<T>& xs)
+{
+    return internal::sum_runs(xs, std::is_arithmetic<T>());
+}
+
+// O(number of runs)
+template <typename T>
+std::size_t count(const typename rle_vector<T>::value_type& x,
+    const rle_vector<T>& xs)
+{
+    std::size_t result = 0;
+    for (const auto& run : xs.runs())
+        if (run.second == x)
+            result += run.first;
+    return result;
+}
+
+// O(number of runs)
+template <typename T>
+maybe<std::size_t> find_first_idx(const typename rle_vector<T>::value_type& x,
+    const rle_vector<T>& xs)
+{
+    std::size_t idx = 0;
+    for (const auto& run : xs.runs())
+    {
+        if (run.second == x)
+            return just(idx);
+        idx += run.first;
+    }
+    return nothing<std::size_t>();
+}
+
+// f is called once per run.
+template <typename F, typename T,
+    typename U = typename std::decay<
+        typename utils::function_traits<F>::result_type>::type>
+rle_vector<U> transform(F f, const rle_vector<T>& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    rle_vector<U> result;
+    for (const auto& run : xs.runs())
+        result.append_run(run.first, f(run.second));
+    return result;
+}
+
+// pred is called once per run.
+template <typename Pred, typename T>
+rle_vector<T> keep_if(Pred pred, const rle_vector<T>& xs)
+{
+    check_unary_predicate_for_container<Pred, rle_vector<T>>();
+    rle_vector<T> result;
+    for (const auto& run : xs.runs())
+        if (pred(run.second))
+            result.append_run(run.first, run.second);
+    return result;
+}
+
+} // namespace fplus
@@ -7,6 +7,15 @@
 #pragma once
 
 #include <algorithm>
+#include <bitset>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
 
 #include "container_common.h"
 #include "composition.h"
@@ -114,37 +123,234 @@ ContainerOut find_all_idxs_of
     return find_all_idxs_by(is_equal_to(x), xs);
 }
 
-// find_all_instances_of_token("haha", "oh, hahaha!") == [4, 6]
-template <typename ContainerOut = std::vector<std::size_t>, typename Container>
-ContainerOut find_all_instances_of_token(const Container& token,
-        const Container& xs)
+namespace internal
 {
-    if (size_of_cont(token) > size_of_cont(xs))
-        return ContainerOut();
 
+template <typename T>
+struct is_byte_like : std::integral_constant<bool,
+    std::is_same<T, char>::value ||
+    std::is_same<T, signed char>::value ||
+    std::is_same<T, unsigned char>::value> {};
+
+// Containers whose elements are single bytes stored contiguously
+// and compared bitwise. These are searched with memchr/memcmp.
+template <typename Container>
+struct is_contiguous_byte_container : std::false_type {};
+
+template <typename T, typename Alloc>
+struct is_contiguous_byte_container<
+    std::basic_string<T, std::char_traits<T>, Alloc>> : is_byte_like<T> {};
+
+template <typename T, typename Alloc>
+struct is_contiguous_byte_container<std::vector<T, Alloc>> : is_byte_like<T> {};
+
+struct generic_token_search_tag {};
+struct random_access_token_search_tag {};
+struct byte_token_search_tag {};
+
+template <typename Container>
+struct token_search_tag
+{
+    typedef typename std::conditional<
+        is_contiguous_byte_container<Container>::value,
+        byte_token_search_tag,
+        typename std::conditional<
+            std::is_convertible<
+                typename std::iterator_traits<
+                    typename Container::const_iterator>::iterator_category,
+                std::random_access_iterator_tag>::value,
+            random_access_token_search_tag,
+            generic_token_search_tag>::type>::type type;
+};
+
+// Tokens of at least this length are searched with Knuth-Morris-Pratt
+// on random-access containers, or with Boyer-Moore-Horspool on bytes.
+inline std::size_t long_token_size()
+{
+    return 8;
+}
+
+// Compares the token at every position.
+template <typename Container, typename F>
+void search_token(generic_token_search_tag, const Container& token,
+    const Container& xs, std::size_t n, std::size_t m,
+    bool overlapping, F f)
+{
     auto itInBegin = std::begin(xs);
     auto itInEnd = itInBegin;
-    std::advance(itInEnd, size_of_cont(token));
+    std::advance(itInEnd, m);
+    const std::size_t last_possible_idx = n - m;
     std::size_t idx = 0;
-    ContainerOut result;
-    auto outIt = get_back_inserter(result);
-    std::size_t last_possible_idx = size_of_cont(xs) - size_of_cont(token);
-    auto check_and_push = [&]()
+    for (;;)
     {
-        if (std::equal(itInBegin, itInEnd,
-            std::begin(token)))
+        std::size_t step = 1;
+        if (std::equal(itInBegin, itInEnd, std::begin(token)))
         {
-            *outIt = idx;
+            if (!f(idx))
+                return;
+            if (!overlapping)
+                step = m;
         }
-    };
-    while (idx != last_possible_idx)
+        if (last_possible_idx - idx < step)
+            return;
+        std::advance(itInBegin, step);
+        std::advance(itInEnd, step);
+        idx += step;
+    }
+}
+
+// Jumps to candidates via the first element of the token.
+// Long tokens use Knuth-Morris-Pratt to stay linear
+// for repetitive inputs.
+template <typename Container, typename F>
+void search_token(random_access_token_search_tag, const Container& token,
+    const Container& xs, std::size_t n, std::size_t m,
+    bool overlapping, F f)
+{
+    const auto ts = std::begin(token);
+    const auto xb = std::begin(xs);
+    if (m < long_token_size())
     {
-        check_and_push();
-        ++itInBegin;
-        ++itInEnd;
-        ++idx;
+        const auto candidates_end = xb + static_cast<std::ptrdiff_t>(n - m + 1);
+        auto it = xb;
+        for (;;)
+        {
+            it = std::find(it, candidates_end, *ts);
+            if (it == candidates_end)
+                return;
+            if (std::equal(ts + 1, std::end(token), it + 1))
+            {
+                if (!f(static_cast<std::size_t>(it - xb)))
+                    return;
+                if (!overlapping)
+                {
+                    if (static_cast<std::size_t>(candidates_end - it) <= m)
+                        return;
+                    it += static_cast<std::ptrdiff_t>(m);
+                    continue;
+                }
+            }
+            ++it;
+        }
     }
-    check_and_push();
+    std::vector<std::size_t> border(m, 0);
+    for (std::size_t i = 1, k = 0; i < m; ++i)
+    {
+        while (k > 0 && !(ts[i] == ts[k]))
+            k = border[k - 1];
+        if (ts[i] == ts[k])
+            ++k;
+        border[i] = k;
+    }
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        while (j > 0 && !(xb[i] == ts[j]))
+            j = border[j - 1];
+        if (xb[i] == ts[j])
+            ++j;
+        if (j == m)
+        {
+            if (!f(i + 1 - m))
+                return;
+            j = overlapping ? border[m - 1] : 0;
+        }
+    }
+}
+
+// Short tokens: memchr for the first byte, then a check of the last byte.
+// Long tokens: Boyer-Moore-Horspool with a table of 256 shifts.
+template <typename Container, typename F>
+void search_token(byte_token_search_tag, const Container& token,
+    const Container& xs, std::size_t n, std::size_t m,
+    bool overlapping, F f)
+{
+    const unsigned char* const p =
+        reinterpret_cast<const unsigned char*>(xs.data());
+    const unsigned char* const t =
+        reinterpret_cast<const unsigned char*>(token.data());
+    const unsigned char last = t[m - 1];
+    if (m < long_token_size())
+    {
+        const unsigned char* it = p;
+        const unsigned char* const candidates_end = p + (n - m + 1);
+        while (it < candidates_end)
+        {
+            it = static_cast<const unsigned char*>(std::memchr(
+                it, t[0], static_cast<std::size_t>(candidates_end - it)));
+            if (it == nullptr)
+                return;
+            if (it[m - 1] == last && std::memcmp(it + 1, t + 1, m - 1) == 0)
+            {
+                if (!f(static_cast<std::size_t>(it - p)))
+                    return;
+                if (!overlapping)
+                {
+                    it += m;
+                    continue;
+                }
+            }
+            ++it;
+        }
+        return;
+    }
+    std::size_t shift[256];
+    std::fill(shift, shift + 256, m);
+    for (std::size_t i = 0; i + 1 < m; ++i)
+        shift[t[i]] = m - 1 - i;
+    std::size_t pos = 0;
+    while (pos <= n - m)
+    {
+        const unsigned char c = p[pos + m - 1];
+        if (c == last && std::memcmp(p + pos, t, m - 1) == 0)
+        {
+            if (!f(pos))
+                return;
+            pos += overlapping ? shift[c] : m;
+        }
+        else
+        {
+            pos += shift[c];
+        }
+    }
+}
+
+// Calls f with the index of every instance of token in xs,
+// in ascending order, as long as f returns true.
+template <typename Container, typename F>
+void for_each_instance_of_token(const Container& token,
+    const Container& xs, bool overlapping, F f)
+{
+    const std::size_t n = size_of_cont(xs);
+    const std::size_t m = size_of_cont(token);
+    if (m > n)
+        return;
+    if (m == 0)
+    {
+        for (std::size_t idx = 0; idx <= n; ++idx)
+            if (!f(idx))
+                return;
+        return;
+    }
+    search_token(typename token_search_tag<Container>::type(),
+        token, xs, n, m, overlapping, f);
+}
+
+} // namespace internal
+
+// find_all_instances_of_token("haha", "oh, hahaha!") == [4, 6]
+template <typename ContainerOut = std::vector<std::size_t>, typename Container>
+ContainerOut find_all_instances_of_token(const Container& token,
+        const Container& xs)
+{
+    ContainerOut result;
+    auto outIt = get_back_inserter(result);
+    internal::for_each_instance_of_token(token, xs, true,
+        [&](std::size_t idx) -> bool
+    {
+        *outIt = idx;
+        return true;
+    });
     return result;
 }
 
@@ -153,18 +359,14 @@ template <typename ContainerOut = std::vector<std::size_t>, typename Container>
 ContainerOut find_all_instances_of_token_non_overlapping
         (const Container& token, const Container& xs)
 {
-    auto overlapping_instances = find_all_instances_of_token<ContainerOut>(
-            token, xs);
     ContainerOut result;
     auto outIt = get_back_inserter(result);
-    std::size_t token_size = size_of_cont(token);
-    for (const auto idx : overlapping_instances)
+    internal::for_each_instance_of_token(token, xs, false,
+        [&](std::size_t idx) -> bool
     {
-        if (result.empty() || result.back() + token_size <= idx)
-        {
-            *outIt = idx;
-        }
-    }
+        *outIt = idx;
+        return true;
+    });
     return result;
 }
 
@@ -173,29 +375,289 @@ template <typename Container>
 maybe<std::size_t> find_first_instance_of_token
         (const Container& token, const Container& xs)
 {
-    if (size_of_cont(token) > size_of_cont(xs))
-        return nothing<std::size_t>();
+    maybe<std::size_t> result = nothing<std::size_t>();
+    internal::for_each_instance_of_token(token, xs, true,
+        [&](std::size_t idx) -> bool
+    {
+        result = just(idx);
+        return false;
+    });
+    return result;
+}
 
-    auto itInBegin = std::begin(xs);
-    auto itInEnd = itInBegin;
-    std::advance(itInEnd, size_of_cont(token));
-    std::size_t idx = 0;
-    std::size_t last_possible_idx = size_of_cont(xs) - size_of_cont(token);
-    while (idx != last_possible_idx)
+namespace internal
+{
+
+// Dense transition table, one row of 256 states per node.
+template <typename T>
+struct token_automaton_dense : std::integral_constant<bool,
+    is_byte_like<T>::value> {};
+
+} // namespace internal
+
+// Aho-Corasick automaton for finding many tokens in one pass.
+// Compile it once and reuse it for many inputs.
+template <typename Container>
+class token_automaton
+{
+public:
+    typedef typename Container::value_type T;
+
+    template <typename ContainerTokens>
+    explicit token_automaton(const ContainerTokens& tokens) :
+        tokens_(std::begin(tokens), std::end(tokens))
     {
-        if (std::equal(itInBegin, itInEnd, std::begin(token)))
+        static_assert(std::is_same<Container,
+            typename ContainerTokens::value_type>::value,
+            "Containers do not match.");
+        compile(internal::token_automaton_dense<T>());
+    }
+
+    std::size_t token_count() const { return tokens_.size(); }
+    const Container& token(std::size_t idx) const { return tokens_[idx]; }
+
+    // Calls f(token_idx, position) for every instance of every token,
+    // ordered by the position of its last element.
+    template <typename F>
+    void for_each_instance(const Container& xs, F f) const
+    {
+        report(0, 0, f);
+        std::size_t state = 0;
+        std::size_t end = 0;
+        for (const auto& x : xs)
         {
-            return just(idx);
+            state = step(state, x, internal::token_automaton_dense<T>());
+            ++end;
+            if (first_output_[state] != no_node())
+                report(state, end, f);
         }
-        ++itInBegin;
-        ++itInEnd;
-        ++idx;
     }
-    if (std::equal(itInBegin, itInEnd, std::begin(token)))
+
+private:
+    static std::size_t no_node() { return static_cast<std::size_t>(-1); }
+
+    typedef std::vector<std::map<T, std::size_t>> Trie;
+
+    // Builds the trie and sets fail and output links.
+    // Returns the nodes in breadth-first order.
+    std::vector<std::size_t> build(Trie& trie)
     {
-        return just(idx);
+        trie.assign(1, std::map<T, std::size_t>());
+        std::vector<std::vector<std::size_t>> node_tokens(1);
+        for (std::size_t idx = 0; idx < tokens_.size(); ++idx)
+        {
+            std::size_t state = 0;
+            for (const auto& x : tokens_[idx])
+            {
+                auto it = trie[state].find(x);
+                if (it == trie[state].end())
+                {
+                    trie.push_back(std::map<T, std::size_t>());
+                    node_tokens.push_back(std::vector<std::size_t>());
+                    it = trie[state].insert(
+                        std::make_pair(x, trie.size() - 1)).first;
+                }
+                state = it->second;
+            }
+            node_tokens[state].push_back(idx);
+        }
+        token_begin_.assign(1, 0);
+        for (const auto& idxs : node_tokens)
+        {
+            token_idxs_.insert(std::end(token_idxs_),
+                std::begin(idxs), std::end(idxs));
+            token_begin_.push_back(token_idxs_.size());
+        }
+        fail_.assign(trie.size(), 0);
+        first_output_.assign(trie.size(), no_node());
+        output_link_.assign(trie.size(), no_node());
+        if (!node_tokens[0].empty())
+            first_output_[0] = 0;
+        std::vector<std::size_t> order(1, 0);
+        for (std::size_t i = 0; i < order.size(); ++i)
+        {
+            const std::size_t u = order[i];
+            for (const auto& child : trie[u])
+            {
+                const std::size_t v = child.second;
+                std::size_t f = fail_[u];
+                while (f != 0 && trie[f].count(child.first) == 0)
+                    f = fail_[f];
+                const auto it = trie[f].find(child.first);
+                fail_[v] = u != 0 && it != trie[f].end() ? it->second : 0;
+                output_link_[v] = first_output_[fail_[v]];
+                first_output_[v] = node_tokens[v].empty()
+                    ? output_link_[v] : v;
+                order.push_back(v);
+            }
+        }
+        return order;
+    }
+
+    // Sorted children of all nodes in one array.
+    void compile(std::false_type)
+    {
+        Trie trie;
+        build(trie);
+        child_begin_.assign(1, 0);
+        for (const auto& children : trie)
+        {
+            for (const auto& child : children)
+            {
+                child_keys_.push_back(child.first);
+                child_nodes_.push_back(child.second);
+            }
+            child_begin_.push_back(child_keys_.size());
+        }
+        set_root_filter(std::is_integral<T>());
+    }
+
+    // Full transition table, 256 entries per node.
+    void compile(std::true_type)
+    {
+        Trie trie;
+        const auto order = build(trie);
+        assert(trie.size() <= std::numeric_limits<std::uint32_t>::max());
+        dense_.assign(trie.size() * 256, 0);
+        for (std::size_t u : order)
+        {
+            std::uint32_t* row = &dense_[u * 256];
+            if (u != 0)
+            {
+                const std::uint32_t* fail_row = &dense_[fail_[u] * 256];
+                std::copy(fail_row, fail_row + 256, row);
+            }
+            for (const auto& child : trie[u])
+                row[static_cast<unsigned char>(child.first)] =
+                    static_cast<std::uint32_t>(child.second);
+        }
     }
-    return nothing<std::size_t>();
+
+    static std::size_t root_filter_bit(const T& x, std::true_type)
+    {
+        return static_cast<std::size_t>(x) % root_filter_size;
+    }
+
+    bool may_leave_root(const T& x, std::true_type) const
+    {
+        return root_filter_[root_filter_bit(x, std::true_type())];
+    }
+
+    bool may_leave_root(const T&, std::false_type) const
+    {
+        return true;
+    }
+
+    void set_root_filter(std::true_type)
+    {
+        for (std::size_t i = child_begin_[0]; i != child_begin_[1]; ++i)
+            root_filter_.set(root_filter_bit(child_keys_[i],
+                std::true_type()));
+    }
+
+    void set_root_filter(std::false_type)
+    {
+    }
+
+    std::size_t step(std::size_t state, const T& x, std::false_type) const
+    {
+        if (state == 0 && !may_leave_root(x, std::is_integral<T>()))
+            return 0;
+        for (;;)
+        {
+            const auto keys_begin = std::begin(child_keys_) +
+                static_cast<std::ptrdiff_t>(child_begin_[state]);
+            const auto keys_end = std::begin(child_keys_) +
+                static_cast<std::ptrdiff_t>(child_begin_[state + 1]);
+            const auto it = std::lower_bound(keys_begin, keys_end, x);
+            if (it != keys_end && !(x < *it))
+                return child_nodes_[static_cast<std::size_t>(
+                    it - std::begin(child_keys_))];
+            if (state == 0)
+                return 0;
+            state = fail_[state];
+        }
+    }
+
+    std::size_t step(std::size_t state, const T& x, std::true_type) const
+    {
+        return dense_[state * 256 + static_cast<unsigned char>(x)];
+    }
+
+    template <typename F>
+    void report(std::size_t state, std::size_t end, F& f) const
+    {
+        for (state = first_output_[state]; state != no_node();
+            state = output_link_[state])
+        {
+            for (std::size_t i = token_begin_[state];
+                i != token_begin_[state + 1]; ++i)
+            {
+                const std::size_t idx = token_idxs_[i];
+                f(idx, end - size_of_cont(tokens_[idx]));
+            }
+        }
+    }
+
+    std::vector<Container> tokens_;
+    std::vector<std::size_t> token_begin_;
+    std::vector<std::size_t> token_idxs_;
+    std::vector<std::size_t> fail_;
+    // First node with tokens on the fail chain, starting with the node itself
+    std::vector<std::size_t> first_output_;
+    // First node with tokens on the fail chain, starting with the fail node
+    std::vector<std::size_t> output_link_;
+    std::vector<std::size_t> child_begin_;
+    std::vector<T> child_keys_;
+    std::vector<std::size_t> child_nodes_;
+    // Integral elements that can not leave the root are mostly
+    // rejected here, without searching the children.
+    static const std::size_t root_filter_size = 4096;
+    std::bitset<root_filter_size> root_filter_;
+    std::vector<std::uint32_t> dense_;
+};
+
+// make_token_automaton(["he", "she", "hers"])
+template <typename ContainerTokens,
+    typename Container = typename ContainerTokens::value_type>
+token_automaton<Container> make_token_automaton(const ContainerTokens& tokens)
+{
+    return token_automaton<Container>(tokens);
+}
+
+// Returns (token index, position) pairs sorted by position and token index.
+// find_all_instances_of_tokens(["he", "she", "hers"], "ushers")
+//     == [(1, 1), (0, 2), (2, 2)]
+template <typename Container,
+    typename ContainerOut =
+        std::vector<std::pair<std::size_t, std::size_t>>>
+ContainerOut find_all_instances_of_tokens(
+    const token_automaton<Container>& automaton, const Container& xs)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> instances;
+    automaton.for_each_instance(xs,
+        [&](std::size_t token_idx, std::size_t pos)
+    {
+        instances.push_back(std::make_pair(pos, token_idx));
+    });
+    std::sort(std::begin(instances), std::end(instances));
+    ContainerOut result;
+    prepare_container(result, instances.size());
+    auto itOut = get_back_inserter(result);
+    for (const auto& instance : instances)
+        *itOut = std::make_pair(instance.second, instance.first);
+    return result;
+}
+
+template <typename ContainerTokens,
+    typename Container = typename ContainerTokens::value_type,
+    typename ContainerOut =
+        std::vector<std::pair<std::size_t, std::size_t>>>
+ContainerOut find_all_instances_of_tokens(
+    const ContainerTokens& tokens, const Container& xs)
+{
+    return find_all_instances_of_tokens<Container, ContainerOut>(
+        make_token_automaton(tokens), xs);
 }
 
 } // namespace fplus
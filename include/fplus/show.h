@@ -6,23 +6,140 @@
 
 #pragma once
 
+#include "c_locale.h"
 #include "container_common.h"
 #include "maybe.h"
+#include "result.h"
 #include "transform.h"
 
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 namespace fplus
 {
 
-// 42 -> "42"
+// show_into(out, x) appends the textual representation of x to out.
+// show and show_cont* use it for every value, so overloading it
+// for own types (found via ADL) makes them showable without
+// creating a temporary string per value.
+// Types without an overload are written using their operator <<.
+
+// show_into(out, 42) appends "42"
 template <typename T>
-std::string show(const T& x)
+void show_into(std::string& out, const T& x)
 {
     std::ostringstream ss;
     ss << x;
-    return ss.str();
+    out += ss.str();
+}
+
+namespace internal
+{
+
+template <typename T>
+void show_integer_into(std::string& out, T x)
+{
+    typedef typename std::make_unsigned<T>::type U;
+    char buffer[std::numeric_limits<U>::digits10 + 3];
+    char* const end = buffer + sizeof(buffer);
+    char* begin = end;
+    const bool negative = x < 0;
+    // Negating in the unsigned domain avoids overflow for min().
+    U value = negative ? static_cast<U>(0 - static_cast<U>(x))
+        : static_cast<U>(x);
+    do
+    {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative)
+        *--begin = '-';
+    out.append(begin, end);
+}
+
+template <typename T>
+void parse_float(const char* str, T& x, T (*parse)(const char*, char**))
+{
+    parse_with_dot_decimal_point(str, str + std::strlen(str), parse, x);
+}
+inline void parse_float(const char* str, float& x) { parse_float(str, x, std::strtof); }
+inline void parse_float(const char* str, double& x) { parse_float(str, x, std::strtod); }
+inline void parse_float(const char* str, long double& x) { parse_float(str, x, std::strtold); }
+
+inline const char* printf_format(float) { return "%.*g"; }
+inline const char* printf_format(double) { return "%.*g"; }
+inline const char* printf_format(long double) { return "%.*Lg"; }
+
+// Same as std::ostream with its default precision of 6
+// and the classic locale, whatever C locale is set.
+template <typename T>
+void show_float_into(std::string& out, T x, int precision)
+{
+    char buffer[64];
+    const int length = std::snprintf(buffer, sizeof(buffer),
+        printf_format(x), precision, x);
+    if (length >= 0 && static_cast<std::size_t>(length) < sizeof(buffer))
+    {
+        out.append(buffer, to_dot_decimal_point(buffer,
+            static_cast<std::size_t>(length)));
+        return;
+    }
+    std::vector<char> big(static_cast<std::size_t>(length) + 1);
+    std::snprintf(big.data(), big.size(), printf_format(x), precision, x);
+    out.append(big.data(), to_dot_decimal_point(big.data(),
+        static_cast<std::size_t>(length)));
+}
+
+} // namespace internal
+
+inline void show_into(std::string& out, short x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, unsigned short x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, int x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, unsigned int x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, long x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, unsigned long x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, long long x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, unsigned long long x) { internal::show_integer_into(out, x); }
+inline void show_into(std::string& out, float x) { internal::show_float_into(out, x, 6); }
+inline void show_into(std::string& out, double x) { internal::show_float_into(out, x, 6); }
+inline void show_into(std::string& out, long double x) { internal::show_float_into(out, x, 6); }
+inline void show_into(std::string& out, char x) { out += x; }
+inline void show_into(std::string& out, const std::string& str) { out += str; }
+inline void show_into(std::string& out, const char* str) { out += str; }
+#if __cplusplus >= 201703L
+inline void show_into(std::string& out, std::string_view str) { out += str; }
+#endif
+
+// show_into(out, {1, "one"}) appends "(1, one)"
+template <typename X, typename Y>
+void show_into(std::string& out, const std::pair<X, Y>& p)
+{
+    out += '(';
+    show_into(out, p.first);
+    out += ", ";
+    show_into(out, p.second);
+    out += ')';
+}
+
+// 42 -> "42"
+template <typename T>
+std::string show(const T& x)
+{
+    std::string result;
+    show_into(result, x);
+    return result;
 }
 
 // "foo" -> "foo"
@@ -32,11 +149,34 @@ std::string show(const std::string& str)
     return str;
 }
 
-// {1, "one"} -> "(1, one)"
-template <typename X, typename Y>
-std::string show(const std::pair<X, Y>& p)
+// Shortest representation that reads back as the same value.
+// show_round_trip(0.1) == "0.1"
+// show_round_trip(1.0 / 3.0) == "0.3333333333333333"
+template <typename T>
+std::string show_round_trip(T x)
 {
-    return std::string("(") + show(p.first) + ", " + show(p.second) + ")";
+    static_assert(std::is_floating_point<T>::value,
+        "Floating point type required.");
+    std::string result;
+    // Values needing at most digits10 significant digits
+    // are printed in their shortest form at this precision.
+    // Subnormal numbers can need fewer digits.
+    const int min_precision = std::fabs(x) < std::numeric_limits<T>::min()
+        ? 1 : std::numeric_limits<T>::digits10;
+    for (int precision = min_precision;
+        precision < std::numeric_limits<T>::max_digits10; ++precision)
+    {
+        result.clear();
+        internal::show_float_into(result, x, precision);
+        T parsed = 0;
+        internal::parse_float(result.c_str(), parsed);
+        if (parsed == x)
+            return result;
+    }
+    result.clear();
+    internal::show_float_into(result, x,
+        std::numeric_limits<T>::max_digits10);
+    return result;
 }
 
 // show_cont_with_frame (" => ", "{", "}", [1, 2, 3]) == "{1 => 2 => 3}"
@@ -46,13 +186,17 @@ std::string show_cont_with_frame(
     const std::string& prefix, const std::string& sufix,
     const Container& xs)
 {
-    std::vector<std::string> elemStrs;
-    elemStrs.reserve(xs.size());
-    for(const auto& x : xs)
+    std::string result = prefix;
+    bool first = true;
+    for (const auto& x : xs)
     {
-        elemStrs.push_back(show(x));
+        if (!first)
+            result += separator;
+        first = false;
+        show_into(result, x);
     }
-    return prefix + join(separator, elemStrs) + sufix;
+    result += sufix;
+    return result;
 }
 
 // show_cont_with( " - ", [1, 2, 3]) == "[1 - 2 - 3]"
@@ -69,14 +213,41 @@ std::string show_cont(const Container& xs)
     return show_cont_with(", ", xs);
 }
 
+// show_into(out, Just 42) appends "Just 42"
+template <typename T>
+void show_into(std::string& out, const maybe<T>& maybe)
+{
+    if (is_nothing(maybe))
+    {
+        out += "Nothing";
+        return;
+    }
+    out += "Just ";
+    show_into(out, unsafe_get_just(maybe));
+}
+
+// show_into(out, Error "fail") appends "Error fail"
+template <typename Ok, typename Error>
+void show_into(std::string& out, const result<Ok, Error>& result)
+{
+    if (is_error(result))
+    {
+        out += "Error ";
+        show_into(out, unsafe_get_error(result));
+        return;
+    }
+    out += "Ok ";
+    show_into(out, unsafe_get_ok(result));
+}
+
 // show_maybe(Just 42) -> "Just 42"
+// show_maybe(Nothing) -> "Nothing"
 template <typename T>
 std::string show_maybe(const maybe<T>& maybe)
 {
-    if (is_nothing(maybe))
-        return "Nothing";
-    else
-        return std::string("Just " + show(unsafe_get_just(maybe)));
+    std::string result;
+    show_into(result, maybe);
+    return result;
 }
 
 // show_result(Ok 42) -> "Ok 42"
@@ -84,10 +255,9 @@ std::string show_maybe(const maybe<T>& maybe)
 template <typename Ok, typename Error>
 std::string show_result(const result<Ok, Error>& result)
 {
-    if (is_error(result))
-        return std::string("Error " + show(unsafe_get_error(result)));
-    else
-        return std::string("Ok " + show(unsafe_get_ok(result)));
+    std::string str;
+    show_into(str, result);
+    return str;
 }
 
 } // namespace fplus
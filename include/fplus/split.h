@@ -10,6 +10,17 @@
 #include "search.h"
 #include "pairs.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 namespace fplus
 {
 
@@ -55,7 +66,8 @@ ContainerOut group(const ContainerIn& xs)
 }
 
 // group_globally_by((==), [1,2,2,2,3,2,2,4,5,5]) == [[1],[2,2,2,2,2],[3],[4],[5,5]]
-// O(n^2)
+// O(n^2), see group_globally_on and group_globally_by_hash
+// for faster alternatives.
 template <typename BinaryPredicate, typename ContainerIn,
         typename ContainerOut = typename std::vector<ContainerIn>>
 ContainerOut group_globally_by(BinaryPredicate p, const ContainerIn& xs)
@@ -100,6 +112,171 @@ ContainerOut group_globally(const ContainerIn& xs)
     return group_globally_by(pred, xs);
 }
 
+namespace internal
+{
+
+template <typename T, typename Hash>
+struct indirect_hash
+{
+    Hash hash_;
+    std::size_t operator()(const T* x) const { return hash_(*x); }
+};
+
+template <typename T, typename BinaryPredicate>
+struct indirect_equal
+{
+    BinaryPredicate p_;
+    bool operator()(const T* x, const T* y) const { return p_(*x, *y); }
+};
+
+// Builds the groups from the group index of every element of xs,
+// with group_sizes[i] being the size of group i.
+template <typename ContainerOut, typename ContainerIn>
+ContainerOut groups_from_idxs(const ContainerIn& xs,
+    const std::vector<std::size_t>& group_idxs,
+    const std::vector<std::size_t>& group_sizes)
+{
+    typedef typename ContainerOut::value_type InnerContainerOut;
+    std::vector<InnerContainerOut> groups(group_sizes.size());
+    for (std::size_t i = 0; i < groups.size(); ++i)
+        prepare_container(groups[i], group_sizes[i]);
+    std::size_t idx = 0;
+    for (const auto& x : xs)
+        *get_back_inserter(groups[group_idxs[idx++]]) = x;
+    return ContainerOut(std::make_move_iterator(std::begin(groups)),
+        std::make_move_iterator(std::end(groups)));
+}
+
+} // namespace internal
+
+// group_globally_on(abs, [1,-2,3,2,-1]) == [[1,-1],[-2,2],[3]]
+// Groups are ordered by their first element, like in group_globally_by.
+// O(n) on average, the keys need std::hash and ==.
+template <typename F, typename ContainerIn,
+        typename ContainerOut = typename std::vector<ContainerIn>>
+ContainerOut group_globally_on(F f, const ContainerIn& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    static_assert(std::is_same<ContainerIn,
+        typename ContainerOut::value_type>::value,
+        "Containers do not match.");
+    typedef typename std::decay<
+        typename utils::function_traits<F>::result_type>::type Key;
+    std::unordered_map<Key, std::size_t> group_of_key;
+    std::vector<std::size_t> group_idxs;
+    group_idxs.reserve(size_of_cont(xs));
+    std::vector<std::size_t> group_sizes;
+    for (const auto& x : xs)
+    {
+        auto key = f(x);
+        // Looking up first avoids allocating a node for known keys.
+        auto it = group_of_key.find(key);
+        if (it == std::end(group_of_key))
+        {
+            it = group_of_key.insert(
+                std::make_pair(std::move(key), group_sizes.size())).first;
+            group_sizes.push_back(0);
+        }
+        ++group_sizes[it->second];
+        group_idxs.push_back(it->second);
+    }
+    return internal::groups_from_idxs<ContainerOut>(
+        xs, group_idxs, group_sizes);
+}
+
+// Groups the elements equal according to p,
+// with hash giving the same value for them.
+// group_globally_by_hash(hash, (==), [1,2,2,2,3,2,2,4,5,5])
+//     == [[1],[2,2,2,2,2],[3],[4],[5,5]]
+// O(n) on average.
+template <typename Hash, typename BinaryPredicate, typename ContainerIn,
+        typename ContainerOut = typename std::vector<ContainerIn>>
+ContainerOut group_globally_by_hash(Hash hash, BinaryPredicate p,
+    const ContainerIn& xs)
+{
+    check_binary_predicate_for_container<BinaryPredicate, ContainerIn>();
+    static_assert(std::is_same<ContainerIn,
+        typename ContainerOut::value_type>::value,
+        "Containers do not match.");
+    typedef typename ContainerIn::value_type T;
+    typedef internal::indirect_hash<T, Hash> IndirectHash;
+    typedef internal::indirect_equal<T, BinaryPredicate> IndirectEqual;
+    std::unordered_map<const T*, std::size_t, IndirectHash, IndirectEqual>
+        group_of_elem(16, IndirectHash{hash}, IndirectEqual{p});
+    std::vector<std::size_t> group_idxs;
+    group_idxs.reserve(size_of_cont(xs));
+    std::vector<std::size_t> group_sizes;
+    for (const auto& x : xs)
+    {
+        auto it = group_of_elem.find(&x);
+        if (it == std::end(group_of_elem))
+        {
+            it = group_of_elem.insert(
+                std::make_pair(&x, group_sizes.size())).first;
+            group_sizes.push_back(0);
+        }
+        ++group_sizes[it->second];
+        group_idxs.push_back(it->second);
+    }
+    return internal::groups_from_idxs<ContainerOut>(
+        xs, group_idxs, group_sizes);
+}
+
+// Same result as group_globally_on, for keys only providing <.
+// group_globally_on_ordered(abs, [1,-2,3,2,-1]) == [[1,-1],[-2,2],[3]]
+// O(n*log(n))
+template <typename F, typename ContainerIn,
+        typename ContainerOut = typename std::vector<ContainerIn>>
+ContainerOut group_globally_on_ordered(F f, const ContainerIn& xs)
+{
+    static_assert(utils::function_traits<F>::arity == 1, "Wrong arity.");
+    static_assert(std::is_same<ContainerIn,
+        typename ContainerOut::value_type>::value,
+        "Containers do not match.");
+    typedef typename std::decay<
+        typename utils::function_traits<F>::result_type>::type Key;
+    // (key, index) sorted by key, equal keys keep their order
+    std::vector<std::pair<Key, std::size_t>> keys;
+    keys.reserve(size_of_cont(xs));
+    for (const auto& x : xs)
+        keys.push_back(std::make_pair(f(x), keys.size()));
+    std::stable_sort(std::begin(keys), std::end(keys),
+        [](const std::pair<Key, std::size_t>& a,
+            const std::pair<Key, std::size_t>& b)
+        {
+            return a.first < b.first;
+        });
+    // Equal keys form runs. Groups are numbered
+    // in the order their runs are first seen in xs.
+    std::vector<std::size_t> run_of_idx(keys.size());
+    std::size_t runs = 0;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        if (i != 0 && keys[i - 1].first < keys[i].first)
+            ++runs;
+        run_of_idx[keys[i].second] = runs;
+    }
+    const std::size_t no_group = static_cast<std::size_t>(-1);
+    std::vector<std::size_t> group_of_run(keys.empty() ? 0 : runs + 1,
+        no_group);
+    std::vector<std::size_t> group_idxs(keys.size());
+    std::vector<std::size_t> group_sizes;
+    group_sizes.reserve(group_of_run.size());
+    for (std::size_t idx = 0; idx < keys.size(); ++idx)
+    {
+        std::size_t& group = group_of_run[run_of_idx[idx]];
+        if (group == no_group)
+        {
+            group = group_sizes.size();
+            group_sizes.push_back(0);
+        }
+        group_idxs[idx] = group;
+        ++group_sizes[group];
+    }
+    return internal::groups_from_idxs<ContainerOut>(
+        xs, group_idxs, group_sizes);
+}
+
 // split_by(is_even, true, [1,3,2,2,5,5,3,6,7,9]) == [[1,3],[],[5,5,3],[7,9]]
 template <typename UnaryPredicate, typename ContainerIn,
         typename ContainerOut = typename std::vector<ContainerIn>>
@@ -194,6 +371,117 @@ ContainerOut split_at_idxs(const ContainerIdxs& idxsIn, const ContainerIn& xs)
     return result;
 }
 
+namespace internal
+{
+
+// Calls f(first, position, length) for every group group_by would return,
+// with first pointing to the first element of the group.
+template <typename BinaryPredicate, typename Container, typename F>
+void group_by_spans_into(BinaryPredicate p, const Container& xs, F f)
+{
+    auto group_first = std::begin(xs);
+    std::size_t start = 0;
+    std::size_t idx = 0;
+    for (auto it = std::begin(xs); it != std::end(xs); ++it, ++idx)
+    {
+        if (idx != 0 && !p(*it, *group_first))
+        {
+            f(group_first, start, idx - start);
+            group_first = it;
+            start = idx;
+        }
+    }
+    if (idx != 0)
+        f(group_first, start, idx - start);
+}
+
+// Calls f(position, length) for every part split_by would return.
+template <typename UnaryPredicate, typename Container, typename F>
+void split_by_spans_into(UnaryPredicate pred, bool allowEmpty,
+    const Container& xs, F f)
+{
+    std::size_t start = 0;
+    std::size_t idx = 0;
+    for (const auto& x : xs)
+    {
+        if (pred(x))
+        {
+            if (idx != start || allowEmpty)
+                f(start, idx - start);
+            start = idx + 1;
+        }
+        ++idx;
+    }
+    if (idx != 0 && (idx != start || allowEmpty))
+        f(start, idx - start);
+}
+
+// Calls f(position, length) for every part split_by_token would return.
+template <typename Container, typename F>
+void split_by_token_spans_into(const Container& token, bool allowEmpty,
+    const Container& xs, F f)
+{
+    const std::size_t token_size = size_of_cont(token);
+    std::size_t last_end = 0;
+    auto add_part = [&](std::size_t idx)
+    {
+        if (idx != last_end || allowEmpty)
+            f(last_end, idx - last_end);
+        last_end = idx + token_size;
+    };
+    for_each_instance_of_token(token, xs, false,
+        [&](std::size_t idx) -> bool
+    {
+        add_part(idx);
+        return true;
+    });
+    add_part(size_of_cont(xs));
+}
+
+} // namespace internal
+
+// Like group_by, but returns (position, length) pairs
+// instead of copying the groups.
+// group_by_spans((==), [1,2,2,2,3,2,2,4,5,5])
+//     == [(0,1),(1,3),(4,1),(5,2),(7,1),(8,2)]
+template <typename BinaryPredicate, typename ContainerIn,
+        typename ContainerOut =
+            std::vector<std::pair<std::size_t, std::size_t>>>
+ContainerOut group_by_spans(BinaryPredicate p, const ContainerIn& xs)
+{
+    check_binary_predicate_for_container<BinaryPredicate, ContainerIn>();
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::group_by_spans_into(p, xs,
+        [&](typename ContainerIn::const_iterator, std::size_t pos,
+            std::size_t length)
+    {
+        *itOut = std::make_pair(pos, length);
+    });
+    return result;
+}
+
+// Like split_by, but returns (position, length) pairs
+// instead of copying the parts.
+// split_by_spans(is_even, true, [1,3,2,2,5,5,3,6,7,9])
+//     == [(0,2),(3,0),(4,3),(8,2)]
+template <typename UnaryPredicate, typename ContainerIn,
+        typename ContainerOut =
+            std::vector<std::pair<std::size_t, std::size_t>>>
+ContainerOut split_by_spans
+        (UnaryPredicate pred, bool allowEmpty, const ContainerIn& xs)
+{
+    check_unary_predicate_for_container<UnaryPredicate, ContainerIn>();
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::split_by_spans_into(pred, allowEmpty, xs,
+        [&](std::size_t pos, std::size_t length)
+    {
+        *itOut = std::make_pair(pos, length);
+    });
+    return result;
+}
+
 // split_by_token(", ", "foo, bar, baz") == ["foo", "bar", "baz"]
 template <typename ContainerIn,
         typename ContainerOut = typename std::vector<ContainerIn>>
@@ -201,26 +489,90 @@ ContainerOut split_by_token(const ContainerIn& token,
         bool allowEmpty, const ContainerIn& xs)
 {
     static_assert(std::is_same<ContainerIn, typename ContainerOut::value_type>::value, "Containers do not match.");
-    auto instances = find_all_instances_of_token_non_overlapping(token, xs);
-    *get_back_inserter(instances) = size_of_cont(xs);
     ContainerOut result;
     auto itOut = get_back_inserter(result);
-    std::size_t lastEnd = 0;
-    for (std::size_t idx : instances)
+    internal::split_by_token_spans_into(token, allowEmpty, xs,
+        [&](std::size_t pos, std::size_t length)
     {
-        if (idx != lastEnd || allowEmpty)
-        {
-            *itOut = get_range(lastEnd, idx, xs);
-            lastEnd = idx + size_of_cont(token);
-        }
-    }
+        *itOut = get_range(pos, pos + length, xs);
+    });
     return result;
 }
 
-// count_occurrences([1,2,2,3,2)) == [(1, 1), (2, 3), (3, 1)]
+// Like split_by_token, but returns (position, length) pairs
+// instead of copying the parts.
+// split_by_token_spans(", ", "foo, bar, baz") == [(0,3),(5,3),(10,3)]
 template <typename ContainerIn,
-        typename MapOut = typename std::map<typename ContainerIn::value_type, std::size_t>>
-MapOut count_occurrences(const ContainerIn& xs)
+        typename ContainerOut =
+            std::vector<std::pair<std::size_t, std::size_t>>>
+ContainerOut split_by_token_spans(const ContainerIn& token,
+        bool allowEmpty, const ContainerIn& xs)
+{
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::split_by_token_spans_into(token, allowEmpty, xs,
+        [&](std::size_t pos, std::size_t length)
+    {
+        *itOut = std::make_pair(pos, length);
+    });
+    return result;
+}
+
+namespace internal
+{
+
+template <typename T>
+std::size_t small_integral_domain_size()
+{
+    return std::size_t(1) << (8 * sizeof(T));
+}
+
+template <typename T>
+std::size_t small_integral_idx(T x)
+{
+    return static_cast<typename std::make_unsigned<T>::type>(x);
+}
+
+// Counting into an array beats a map,
+// unless the input is small compared to the number of possible values.
+template <typename T>
+bool use_counting_array(std::size_t size)
+{
+    return sizeof(T) == 1 || size >= small_integral_domain_size<T>() / 16;
+}
+
+template <typename MapOut, typename T>
+struct can_count_in_array : std::integral_constant<bool,
+    is_small_integral<T>::value &&
+    std::is_same<typename MapOut::key_type, T>::value> {};
+
+template <typename Iterator>
+void add_counts(std::vector<std::size_t>& counts,
+    Iterator first, Iterator last)
+{
+    for (; first != last; ++first)
+        ++counts[small_integral_idx(*first)];
+}
+
+// Inserts the non-zero counts in ascending order of their values.
+template <typename T, typename MapOut>
+MapOut map_from_counts(const std::vector<std::size_t>& counts)
+{
+    MapOut result;
+    for (long long v = std::numeric_limits<T>::min();
+        v <= std::numeric_limits<T>::max(); ++v)
+    {
+        const T x = static_cast<T>(v);
+        const std::size_t count = counts[small_integral_idx(x)];
+        if (count != 0)
+            result.insert(std::end(result),
+                typename MapOut::value_type(x, count));
+    }
+    return result;
+}
+
+template <typename MapOut, typename ContainerIn>
+MapOut count_occurrences(const ContainerIn& xs, std::false_type)
 {
     MapOut result;
     for (const auto& x : xs)
@@ -230,6 +582,151 @@ MapOut count_occurrences(const ContainerIn& xs)
     return result;
 }
 
+template <typename MapOut, typename ContainerIn>
+MapOut count_occurrences(const ContainerIn& xs, std::true_type)
+{
+    typedef typename ContainerIn::value_type T;
+    if (!use_counting_array<T>(size_of_cont(xs)))
+        return count_occurrences<MapOut>(xs, std::false_type());
+    std::vector<std::size_t> counts(small_integral_domain_size<T>(), 0);
+    add_counts(counts, std::begin(xs), std::end(xs));
+    return map_from_counts<T, MapOut>(counts);
+}
+
+// Open addressing hash table with linear probing.
+// The entries are kept in one vector in order of their insertion,
+// the slots only hold their indices.
+template <typename T>
+class flat_counter
+{
+public:
+    typedef std::vector<std::pair<T, std::size_t>> entries_type;
+    flat_counter() :
+        slots_(16, 0),
+        shift_(std::numeric_limits<std::size_t>::digits - 4)
+    {
+    }
+    void add(const T& x, std::size_t count)
+    {
+        const std::size_t hash = hasher_(x);
+        std::size_t slot = slot_of(hash);
+        for (; slots_[slot] != 0; slot = (slot + 1) & (slots_.size() - 1))
+        {
+            const std::size_t idx = slots_[slot] - 1;
+            if (hashes_[idx] == hash && entries_[idx].first == x)
+            {
+                entries_[idx].second += count;
+                return;
+            }
+        }
+        entries_.push_back(std::make_pair(x, count));
+        hashes_.push_back(hash);
+        slots_[slot] = entries_.size();
+        if (2 * entries_.size() > slots_.size())
+            grow();
+    }
+    const entries_type& entries() const { return entries_; }
+    entries_type& entries() { return entries_; }
+private:
+    // Fibonacci hashing spreads weak hashes, like the identity
+    // std::hash<int> often is, over the whole table.
+    // The multiplier is 2^N divided by the golden ratio
+    // for the N bits of std::size_t.
+    std::size_t slot_of(std::size_t hash) const
+    {
+        const std::size_t multiplier = sizeof(std::size_t) >= 8
+            ? static_cast<std::size_t>(0x9E3779B97F4A7C15ull)
+            : static_cast<std::size_t>(0x9E3779B9u);
+        return (hash * multiplier) >> shift_;
+    }
+    void grow()
+    {
+        slots_.assign(2 * slots_.size(), 0);
+        --shift_;
+        for (std::size_t idx = 0; idx < hashes_.size(); ++idx)
+        {
+            std::size_t slot = slot_of(hashes_[idx]);
+            while (slots_[slot] != 0)
+                slot = (slot + 1) & (slots_.size() - 1);
+            slots_[slot] = idx + 1;
+        }
+    }
+    std::hash<T> hasher_;
+    entries_type entries_;
+    std::vector<std::size_t> hashes_;
+    std::vector<std::size_t> slots_;
+    int shift_;
+};
+
+template <typename ContainerIn, typename ContainerOut>
+ContainerOut count_occurrences_flat(const ContainerIn& xs, std::false_type)
+{
+    flat_counter<typename ContainerIn::value_type> counter;
+    for (const auto& x : xs)
+        counter.add(x, 1);
+    return ContainerOut(
+        std::make_move_iterator(std::begin(counter.entries())),
+        std::make_move_iterator(std::end(counter.entries())));
+}
+
+template <typename ContainerIn, typename ContainerOut>
+ContainerOut count_occurrences_flat(const ContainerIn& xs, std::true_type)
+{
+    typedef typename ContainerIn::value_type T;
+    if (!use_counting_array<T>(size_of_cont(xs)))
+        return count_occurrences_flat<ContainerIn, ContainerOut>(
+            xs, std::false_type());
+    std::vector<std::size_t> counts(small_integral_domain_size<T>(), 0);
+    std::vector<T> firsts;
+    for (const auto& x : xs)
+        if (counts[small_integral_idx(x)]++ == 0)
+            firsts.push_back(x);
+    ContainerOut result;
+    prepare_container(result, firsts.size());
+    auto itOut = get_back_inserter(result);
+    for (const auto& x : firsts)
+        *itOut = std::make_pair(x, counts[small_integral_idx(x)]);
+    return result;
+}
+
+} // namespace internal
+
+// count_occurrences([1,2,2,3,2)) == [(1, 1), (2, 3), (3, 1)]
+// Integral types of up to 16 bits are counted in an array.
+template <typename ContainerIn,
+        typename MapOut = typename std::map<typename ContainerIn::value_type, std::size_t>>
+MapOut count_occurrences(const ContainerIn& xs)
+{
+    typedef typename ContainerIn::value_type T;
+    return internal::count_occurrences<MapOut>(xs,
+        internal::can_count_in_array<MapOut, T>());
+}
+
+// Like count_occurrences, but unordered.
+// The elements need std::hash.
+// count_occurrences_hash([1,2,2,3,2)) == {(3, 1), (1, 1), (2, 3)}
+template <typename ContainerIn,
+        typename MapOut = typename std::unordered_map<
+            typename ContainerIn::value_type, std::size_t>>
+MapOut count_occurrences_hash(const ContainerIn& xs)
+{
+    return count_occurrences<ContainerIn, MapOut>(xs);
+}
+
+// Counts in a flat open addressing hash table,
+// which only allocates when growing.
+// The elements need std::hash.
+// The counts are returned in order of the first occurrences.
+// count_occurrences_flat([2,1,2,3,2)) == [(2, 3), (1, 1), (3, 1)]
+template <typename ContainerIn,
+        typename T = typename ContainerIn::value_type,
+        typename ContainerOut = std::vector<std::pair<T, std::size_t>>>
+ContainerOut count_occurrences_flat(const ContainerIn& xs)
+{
+    return internal::count_occurrences_flat<ContainerIn, ContainerOut>(xs,
+        internal::is_small_integral<T>());
+}
+
 // run_length_encode_by((==),[1,2,2,2,2,3,3,2)) == [(1,1),(4,2),(2,3),(1,2)]
 template <typename BinaryPredicate,
         typename ContainerIn,
@@ -239,12 +736,14 @@ ContainerOut run_length_encode_by(BinaryPredicate pred, const ContainerIn& xs)
 {
     check_binary_predicate_for_container<BinaryPredicate, ContainerIn>();
     ContainerOut result;
-    auto groups = group_by(pred, xs);
-    auto group_to_pair = [](const ContainerIn& group )
+    auto itOut = get_back_inserter(result);
+    internal::group_by_spans_into(pred, xs,
+        [&](typename ContainerIn::const_iterator first, std::size_t,
+            std::size_t length)
     {
-        return std::make_pair(size_of_cont(group), group.front());
-    };
-    return transform(group_to_pair, groups);
+        *itOut = std::make_pair(length, *first);
+    });
+    return result;
 }
 
 // run_length_encode([1,2,2,2,2,3,3,2)) == [(1,1),(4,2),(2,3),(1,2)]
@@ -265,8 +764,16 @@ template <typename ContainerIn,
 ContainerOut run_length_decode(const ContainerIn& pairs)
 {
     static_assert(std::is_convertible<Cnt, std::size_t>::value, "Count type must be convertible to std::size_t.");
-    auto pair_to_vec = apply_to_pair(replicate<T>);
-    return concat(transform(pair_to_vec, pairs));
+    std::size_t size = 0;
+    for (const auto& p : pairs)
+        size += static_cast<std::size_t>(p.first);
+    ContainerOut result;
+    prepare_container(result, size);
+    auto itOut = get_back_inserter(result);
+    for (const auto& p : pairs)
+        itOut = std::fill_n(itOut, static_cast<std::size_t>(p.first),
+            p.second);
+    return result;
 }
 
 // take_while(is_even, [0,2,4,5,6,7,8]) == [0,2,4]
@@ -6,11 +6,19 @@
 
 #pragma once
 
+#include "char_kernels.h"
 #include "replace.h"
 #include "split.h"
 #include "transform.h"
 
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
 
 namespace fplus
 {
@@ -19,18 +27,14 @@ namespace fplus
 template <typename String>
 bool is_letter_or_digit(const typename String::value_type& c)
 {
-    auto IsDigit = is_in_range(48, 58);
-    auto IsLowerLetter = is_in_range(65, 91);
-    auto IsUpperLetter = is_in_range(97, 123);
-    auto IsLetter = logical_or(IsLowerLetter, IsUpperLetter);
-    return IsDigit(c) || IsLetter(c);
+    return (c >= 48 && c < 58) || (c >= 65 && c < 91) || (c >= 97 && c < 123);
 }
 
 // Is character a whitespace.
 template <typename String>
 bool is_whitespace(const typename String::value_type& c)
 {
-    return (c == 32 || is_in_range(9, 14)(c));
+    return c == 32 || (c >= 9 && c < 14);
 }
 
 // Newline character ('\n')?
@@ -40,12 +44,268 @@ bool is_line_break(const typename String::value_type& c)
     return c == '\n';
 }
 
+namespace internal
+{
+
+template <typename String>
+struct is_one_of_chars
+{
+    typedef typename String::value_type CharType;
+    explicit is_one_of_chars(const String& delims) : delims_(delims) {}
+    bool operator()(const CharType ch) const
+    {
+        return std::any_of(std::begin(delims_), std::end(delims_),
+            [ch](const CharType delim) { return ch == delim; });
+    }
+private:
+    const String& delims_;
+};
+
+// Strings of single-byte characters are classified
+// by the kernels in char_kernels.h.
+template <typename String>
+struct has_byte_chars : is_contiguous_byte_container<String> {};
+
+template <typename String>
+const unsigned char* bytes_of(const String& str)
+{
+    return reinterpret_cast<const unsigned char*>(str.data());
+}
+
+template <typename String>
+String substr_of(const String& str, std::size_t pos, std::size_t length,
+    std::true_type)
+{
+    const auto itBegin = std::begin(str) + static_cast<std::ptrdiff_t>(pos);
+    return String(itBegin, itBegin + static_cast<std::ptrdiff_t>(length));
+}
+
+template <typename String>
+String substr_of(const String& str, std::size_t pos, std::size_t length,
+    std::false_type)
+{
+    return get_range(pos, pos + length, str);
+}
+
+template <typename ByteClass, typename F>
+void split_bytes_spans_into(const ByteClass& bytes, bool allowEmpty,
+    const unsigned char* p, std::size_t n, F f)
+{
+    std::size_t start = 0;
+    for_each_byte_in_class(p, n, bytes, [&](std::size_t idx)
+    {
+        if (idx != start || allowEmpty)
+            f(start, idx - start);
+        start = idx + 1;
+    });
+    if (n != 0 && (n != start || allowEmpty))
+        f(start, n - start);
+}
+
+template <typename String, typename F>
+void split_words_spans_into(const String& str, bool allowEmpty, F f,
+    std::true_type)
+{
+    split_bytes_spans_into(non_alnum_bytes(), allowEmpty,
+        bytes_of(str), size_of_cont(str), f);
+}
+
+template <typename String, typename F>
+void split_words_spans_into(const String& str, bool allowEmpty, F f,
+    std::false_type)
+{
+    split_by_spans_into(logical_not(is_letter_or_digit<String>),
+        allowEmpty, str, f);
+}
+
+template <typename String, typename F>
+void split_words_by_spans_into(const String& str,
+    const typename String::value_type delim, bool allowEmpty, F f,
+    std::true_type)
+{
+    split_bytes_spans_into(one_of_bytes(std::vector<unsigned char>(1,
+            static_cast<unsigned char>(delim))),
+        allowEmpty, bytes_of(str), size_of_cont(str), f);
+}
+
+template <typename String, typename F>
+void split_words_by_spans_into(const String& str,
+    const typename String::value_type delim, bool allowEmpty, F f,
+    std::false_type)
+{
+    split_by_spans_into(is_equal_to(delim), allowEmpty, str, f);
+}
+
+template <typename String, typename F>
+void split_words_by_many_spans_into(const String& str, const String& delims,
+    bool allowEmpty, F f, std::true_type)
+{
+    split_bytes_spans_into(one_of_bytes(delims), allowEmpty,
+        bytes_of(str), size_of_cont(str), f);
+}
+
+template <typename String, typename F>
+void split_words_by_many_spans_into(const String& str, const String& delims,
+    bool allowEmpty, F f, std::false_type)
+{
+    split_by_spans_into(is_one_of_chars<String>(delims), allowEmpty, str, f);
+}
+
+// Calls f(position, length) for every line split_lines would return,
+// treating "\r\n", "\r" and "\n" as line breaks.
+template <typename String, typename F>
+void split_lines_spans_into(const String& str, bool allowEmpty, F f,
+    std::true_type)
+{
+    const unsigned char* p = bytes_of(str);
+    const std::size_t n = size_of_cont(str);
+    std::size_t start = 0;
+    for_each_byte_in_class(p, n, line_break_bytes(), [&](std::size_t idx)
+    {
+        // second half of "\r\n"
+        if (p[idx] == '\n' && idx != 0 && p[idx - 1] == '\r')
+        {
+            start = idx + 1;
+            return;
+        }
+        if (idx != start || allowEmpty)
+            f(start, idx - start);
+        start = idx + 1;
+    });
+    if (n != 0 && (n != start || allowEmpty))
+        f(start, n - start);
+}
+
+template <typename String, typename F>
+void split_lines_spans_into(const String& str, bool allowEmpty, F f,
+    std::false_type)
+{
+    std::size_t start = 0;
+    std::size_t idx = 0;
+    auto it = std::begin(str);
+    const auto itEnd = std::end(str);
+    while (it != itEnd)
+    {
+        const auto c = *it;
+        ++it;
+        ++idx;
+        if (c != '\n' && c != '\r')
+            continue;
+        if (idx - 1 != start || allowEmpty)
+            f(start, idx - 1 - start);
+        if (c == '\r' && it != itEnd && *it == '\n')
+        {
+            ++it;
+            ++idx;
+        }
+        start = idx;
+    }
+    if (idx != 0 && (idx != start || allowEmpty))
+        f(start, idx - start);
+}
+
+template <typename String>
+String trim_whitespace_left(const String& str, std::true_type)
+{
+    const std::size_t n = size_of_cont(str);
+    const std::size_t first =
+        find_first_byte_not_in_class(bytes_of(str), n, whitespace_bytes());
+    return substr_of(str, first, n - first, std::true_type());
+}
+
+template <typename String>
+String trim_whitespace_left(const String& str, std::false_type)
+{
+    return trim_left_by(is_whitespace<String>, str);
+}
+
+template <typename String>
+String trim_whitespace_right(const String& str, std::true_type)
+{
+    return substr_of(str, 0, find_end_of_bytes_not_in_class(
+        bytes_of(str), size_of_cont(str), whitespace_bytes()),
+        std::true_type());
+}
+
+template <typename String>
+String trim_whitespace_right(const String& str, std::false_type)
+{
+    return trim_right_by(is_whitespace<String>, str);
+}
+
+template <typename String>
+String trim_whitespace(const String& str, std::true_type)
+{
+    const unsigned char* p = bytes_of(str);
+    const std::size_t n = size_of_cont(str);
+    const std::size_t first =
+        find_first_byte_not_in_class(p, n, whitespace_bytes());
+    if (first == n)
+        return String();
+    return substr_of(str, first, find_end_of_bytes_not_in_class(
+        p + first, n - first, whitespace_bytes()), std::true_type());
+}
+
+template <typename String>
+String trim_whitespace(const String& str, std::false_type)
+{
+    return trim_by(is_whitespace<String>, str);
+}
+
+template <typename String>
+String clean_newlines(const String& str, std::true_type)
+{
+    const unsigned char* p = bytes_of(str);
+    const std::size_t n = size_of_cont(str);
+    const auto itBegin = std::begin(str);
+    String result;
+    result.reserve(n);
+    std::size_t start = 0;
+    for_each_byte_in_class(p, n, one_of_bytes(std::string(1, '\r')),
+        [&](std::size_t idx)
+    {
+        result.insert(std::end(result),
+            itBegin + static_cast<std::ptrdiff_t>(start),
+            itBegin + static_cast<std::ptrdiff_t>(idx));
+        result.push_back('\n');
+        start = idx + 1 < n && p[idx + 1] == '\n' ? idx + 2 : idx + 1;
+    });
+    result.insert(std::end(result),
+        itBegin + static_cast<std::ptrdiff_t>(start), std::end(str));
+    return result;
+}
+
+template <typename String>
+String clean_newlines(const String& str, std::false_type)
+{
+    String result;
+    prepare_container(result, size_of_cont(str));
+    auto itOut = get_back_inserter(result);
+    const auto itEnd = std::end(str);
+    for (auto it = std::begin(str); it != itEnd; ++it)
+    {
+        if (*it != '\r')
+        {
+            *itOut = *it;
+            continue;
+        }
+        *itOut = '\n';
+        const auto itNext = std::next(it);
+        if (itNext != itEnd && *itNext == '\n')
+            it = itNext;
+    }
+    return result;
+}
+
+} // namespace internal
+
 // Replaces windows and mac newlines with linux newlines.
+// clean_newlines("a\r\nb\rc\n") == "a\nb\nc\n"
 template <typename String>
 String clean_newlines(const String& str)
 {
-    return replace_elems('\r', '\n',
-        replace_tokens(String("\r\n"), String("\n"), str));
+    return internal::clean_newlines(str,
+        typename internal::has_byte_chars<String>::type());
 }
 
 // Splits a string by non-letter and non-digit characters.
@@ -53,7 +313,15 @@ String clean_newlines(const String& str)
 template <typename String, typename ContainerOut = std::vector<String>>
 ContainerOut split_words(const String& str, const bool allowEmpty)
 {
-    return split_by(logical_not(is_letter_or_digit<String>), allowEmpty, str);
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::split_words_spans_into(str, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
+    {
+        *itOut = internal::substr_of(str, pos, length,
+            typename internal::has_byte_chars<String>::type());
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
 }
 
 // Splits a string by non-letter and non-digit characters.
@@ -63,11 +331,15 @@ ContainerOut split_words_by
         (const String& str, const typename String::value_type delim,
          const bool allowEmpty)
 {
-    const auto comparator = [delim](const typename String::value_type ch)
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::split_words_by_spans_into(str, delim, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
     {
-        return ch == delim;
-    };
-    return split_by(comparator, allowEmpty, str);
+        *itOut = internal::substr_of(str, pos, length,
+            typename internal::has_byte_chars<String>::type());
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
 }
 
 // Splits a string by the given delimiter(s).
@@ -76,42 +348,294 @@ template <typename String, typename ContainerOut = std::vector<String>>
 ContainerOut split_words_by_many
         (const String& str, const String& delims, const bool allowEmpty)
 {
-    typedef typename String::value_type CharType;
-    const auto comparator = [&delims](const CharType ch)
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::split_words_by_many_spans_into(str, delims, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
     {
-        return std::any_of(std::begin(delims), std::end(delims),
-                    [ch](const CharType delim) { return ch == delim; });
-    };
-    return split_by(comparator, allowEmpty, str);
+        *itOut = internal::substr_of(str, pos, length,
+            typename internal::has_byte_chars<String>::type());
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
 }
 
-// Splits a string by the found newlines.
+// Splits a string by the found newlines ("\n", "\r\n" or "\r").
 // split_lines("Hi,\nhow are you?", false) == ["Hi,", "How are you"]
 template <typename String, typename ContainerOut = std::vector<String>>
 ContainerOut split_lines(const String& str, bool allowEmpty)
 {
-    return split_by(is_line_break<String>, allowEmpty, clean_newlines(str));
+    ContainerOut result;
+    auto itOut = get_back_inserter(result);
+    internal::split_lines_spans_into(str, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
+    {
+        *itOut = internal::substr_of(str, pos, length,
+            typename internal::has_byte_chars<String>::type());
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
+}
+
+// The following functions return (position, length) pairs
+// referring to str instead of copying the parts.
+
+// split_words_spans("How are you?", false) == [(0,3),(4,3),(8,3)]
+template <typename String>
+std::vector<std::pair<std::size_t, std::size_t>> split_words_spans
+        (const String& str, const bool allowEmpty)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> result;
+    internal::split_words_spans_into(str, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
+    {
+        result.push_back(std::make_pair(pos, length));
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
+}
+
+// split_words_by_spans("How-are you?", ' ', false) == [(0,7),(8,4)]
+template <typename String>
+std::vector<std::pair<std::size_t, std::size_t>> split_words_by_spans
+        (const String& str, const typename String::value_type delim,
+         const bool allowEmpty)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> result;
+    internal::split_words_by_spans_into(str, delim, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
+    {
+        result.push_back(std::make_pair(pos, length));
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
+}
+
+// split_words_by_many_spans("How are you?", "- o", false)
+//     == [(0,1),(2,1),(4,3),(8,1),(10,2)]
+template <typename String>
+std::vector<std::pair<std::size_t, std::size_t>> split_words_by_many_spans
+        (const String& str, const String& delims, const bool allowEmpty)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> result;
+    internal::split_words_by_many_spans_into(str, delims, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
+    {
+        result.push_back(std::make_pair(pos, length));
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
+}
+
+// split_lines_spans("Hi,\r\nhow are you?", false) == [(0,3),(5,12)]
+template <typename String>
+std::vector<std::pair<std::size_t, std::size_t>> split_lines_spans
+        (const String& str, bool allowEmpty)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> result;
+    internal::split_lines_spans_into(str, allowEmpty,
+        [&](std::size_t pos, std::size_t length)
+    {
+        result.push_back(std::make_pair(pos, length));
+    }, typename internal::has_byte_chars<String>::type());
+    return result;
+}
+
+// Splits text arriving in chunks into lines, with the same results
+// as split_lines on the concatenation of all chunks.
+// Lines are passed to f as a reference to a reused buffer,
+// so the caller must copy them if they should be kept.
+// line_splitter<std::string> splitter(false);
+// splitter.feed("Hi,\r", f); splitter.feed("\nhow are", f);
+// splitter.feed(" you?", f); splitter.finish(f);
+// calls f("Hi,") and f("how are you?")
+template <typename String = std::string>
+class line_splitter
+{
+public:
+    explicit line_splitter(bool allowEmpty) :
+        allowEmpty_(allowEmpty), seen_input_(false), after_cr_(false)
+    {
+    }
+
+    // Calls f(line) for every line completed by chunk.
+    template <typename F>
+    void feed(const String& chunk, F f)
+    {
+        const auto itBegin = std::begin(chunk);
+        std::size_t start = 0;
+        if (!chunk.empty())
+        {
+            seen_input_ = true;
+            // "\r\n" split between two chunks
+            if (after_cr_ && *itBegin == '\n')
+                start = 1;
+            after_cr_ = false;
+        }
+        internal::split_lines_spans_into(chunk, true,
+            [&](std::size_t pos, std::size_t length)
+        {
+            if (pos < start)
+                return;
+            const auto itLine = itBegin + static_cast<std::ptrdiff_t>(pos);
+            const auto itLineEnd = itLine + static_cast<std::ptrdiff_t>(length);
+            if (itLineEnd == std::end(chunk))
+            {
+                // unterminated last line of the chunk
+                pending_.insert(std::end(pending_), itLine, itLineEnd);
+                after_cr_ = last_is_cr(chunk);
+                return;
+            }
+            emit(itLine, itLineEnd, f);
+        }, typename internal::has_byte_chars<String>::type());
+    }
+
+    // Calls f(line) for the remaining line, if any,
+    // and resets the splitter.
+    template <typename F>
+    void finish(F f)
+    {
+        if (seen_input_ && (!pending_.empty() || allowEmpty_))
+            f(static_cast<const String&>(pending_));
+        pending_.clear();
+        seen_input_ = false;
+        after_cr_ = false;
+    }
+
+private:
+    static bool last_is_cr(const String& chunk)
+    {
+        return !chunk.empty() && *std::prev(std::end(chunk)) == '\r';
+    }
+
+    template <typename Iterator, typename F>
+    void emit(Iterator first, Iterator last, F& f)
+    {
+        if (pending_.empty())
+            line_.assign(first, last);
+        else
+        {
+            line_.swap(pending_);
+            line_.insert(std::end(line_), first, last);
+            pending_.clear();
+        }
+        if (!line_.empty() || allowEmpty_)
+            f(static_cast<const String&>(line_));
+    }
+
+    bool allowEmpty_;
+    bool seen_input_;
+    bool after_cr_;
+    String pending_;
+    String line_;
+};
+
+#if __cplusplus >= 201703L
+
+// The following functions return views into str instead of copies.
+// str must outlive the returned views.
+
+namespace internal
+{
+
+template <typename String>
+using string_view_of = std::basic_string_view<
+    typename String::value_type, typename String::traits_type>;
+
+template <typename String, typename SplitSpans>
+std::vector<string_view_of<String>> views_of_splits(const String& str,
+    SplitSpans split_spans)
+{
+    std::vector<string_view_of<String>> result;
+    split_spans([&](std::size_t pos, std::size_t length)
+    {
+        result.emplace_back(str.data() + pos, length);
+    });
+    return result;
+}
+
+} // namespace internal
+
+// split_words_views("How are you?", false) == ["How", "are", "you"]
+template <typename String>
+std::vector<internal::string_view_of<String>> split_words_views
+        (const String& str, const bool allowEmpty)
+{
+    return internal::views_of_splits(str, [&](auto f)
+    {
+        internal::split_words_spans_into(str, allowEmpty, f,
+            typename internal::has_byte_chars<String>::type());
+    });
 }
 
+// split_words_by_views("How-are you?", ' ', false) == ["How-are", "you?"]
+template <typename String>
+std::vector<internal::string_view_of<String>> split_words_by_views
+        (const String& str, const typename String::value_type delim,
+         const bool allowEmpty)
+{
+    return internal::views_of_splits(str, [&](auto f)
+    {
+        internal::split_words_by_spans_into(str, delim, allowEmpty, f,
+            typename internal::has_byte_chars<String>::type());
+    });
+}
+
+// split_words_by_many_views("How are you?", "- o", false)
+//     == ["H","w","are","y","u?"]
+template <typename String>
+std::vector<internal::string_view_of<String>> split_words_by_many_views
+        (const String& str, const String& delims, const bool allowEmpty)
+{
+    return internal::views_of_splits(str, [&](auto f)
+    {
+        internal::split_words_by_many_spans_into(str, delims, allowEmpty, f,
+            typename internal::has_byte_chars<String>::type());
+    });
+}
+
+// split_lines_views("Hi,\r\nhow are you?", false) == ["Hi,", "how are you?"]
+template <typename String>
+std::vector<internal::string_view_of<String>> split_lines_views
+        (const String& str, bool allowEmpty)
+{
+    return internal::views_of_splits(str, [&](auto f)
+    {
+        internal::split_lines_spans_into(str, allowEmpty, f,
+            typename internal::has_byte_chars<String>::type());
+    });
+}
+
+// split_by_token_views(", ", "foo, bar, baz") == ["foo", "bar", "baz"]
+template <typename String>
+std::vector<internal::string_view_of<String>> split_by_token_views
+        (const String& token, bool allowEmpty, const String& str)
+{
+    return internal::views_of_splits(str, [&](auto f)
+    {
+        internal::split_by_token_spans_into(token, allowEmpty, str, f);
+    });
+}
+
+#endif
+
 // trim_whitespace_left("    text  ") == "text  "
 template <typename String>
 String trim_whitespace_left(const String& str)
 {
-    return trim_left_by(is_whitespace<String>, str);
+    return internal::trim_whitespace_left(str,
+        typename internal::has_byte_chars<String>::type());
 }
 
 // trim_whitespace_right("    text  ") == "    text"
 template <typename String>
 String trim_whitespace_right(const String& str)
 {
-    return trim_right_by(is_whitespace<String>, str);
+    return internal::trim_whitespace_right(str,
+        typename internal::has_byte_chars<String>::type());
 }
 
 // trim_whitespace("    text  ") == "text"
 template <typename String>
 String trim_whitespace(const String& str)
 {
-    return trim_by(is_whitespace<String>, str);
+    return internal::trim_whitespace(str,
+        typename internal::has_byte_chars<String>::type());
 }
 
 // to_string_fill_left('0', 5, 42) == "00042"
@@ -0,0 +1,2182 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+// Benchmark suite for the functions in include/fplus/*.h.
+//
+// Every function is timed with std::chrono::steady_clock over
+// std::vector, std::list, std::deque and std::string inputs
+// of the sizes 1e2, 1e3, ... 1e7 (as far as the function supports
+// the container and its complexity allows for the size).
+// Median, p90 and minimum over the repetitions are reported,
+// together with a hand-written baseline where one exists.
+// The heap allocations and bytes allocated by one call are counted too.
+// Results are printed to stdout and written as JSON.
+//
+// Usage: benchmark [--min-size N] [--max-size N] [--filter SUBSTRING]
+//                  [--containers vector,list,deque,string]
+//                  [--min-reps N] [--min-time SECONDS] [--json FILE]
+
+#include "fplus.h"
+#include "count_allocations.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+typedef std::chrono::steady_clock bench_clock;
+
+// Keeps the compiler from optimizing away a result that is not used.
+template <typename T>
+void do_not_optimize(const T& x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : : "r"(&x) : "memory");
+#else
+    static const void* volatile sink = nullptr;
+    sink = &x;
+#endif
+}
+
+// How the running time of a benchmarked call grows with the input size.
+// Sizes above the limit of a class are skipped.
+enum class scaling
+{
+    linear, // also n*log(n), no limit
+    quadratic, // up to 1e4 elements
+    quadratic_memory, // output grows quadratically, up to 1e3 elements
+    combinatorial // only run on the smallest size
+};
+
+std::size_t max_size_for(scaling s)
+{
+    switch (s)
+    {
+        case scaling::quadratic: return 10000;
+        case scaling::quadratic_memory: return 1000;
+        case scaling::combinatorial: return 100;
+        default: return static_cast<std::size_t>(-1);
+    }
+}
+
+struct config
+{
+    config() :
+        min_size(100),
+        max_size(10000000),
+        filter(),
+        containers({"vector", "list", "deque", "string"}),
+        min_reps(5),
+        min_time(0.05),
+        min_sample_time(0.00002),
+        json_path("benchmark.json")
+        {}
+    std::size_t min_size;
+    std::size_t max_size;
+    std::string filter;
+    std::vector<std::string> containers;
+    std::size_t min_reps;
+    double min_time;
+    double min_sample_time;
+    std::string json_path;
+};
+
+struct sample_stats
+{
+    sample_stats() :
+        reps(0), calls_per_rep(0), min(0), median(0), p90(0),
+        allocations(0), bytes(0) {}
+    std::size_t reps;
+    std::size_t calls_per_rep;
+    double min; // ns per call
+    double median; // ns per call
+    double p90; // ns per call
+    std::size_t allocations; // per call
+    std::size_t bytes; // allocated per call
+};
+
+struct benchmark_result
+{
+    std::string header;
+    std::string function;
+    std::string container;
+    std::size_t size;
+    sample_stats fplus;
+    bool has_baseline;
+    sample_stats baseline;
+};
+
+template <typename F>
+double time_calls(F& f, std::size_t calls)
+{
+    auto start = bench_clock::now();
+    for (std::size_t i = 0; i < calls; ++i)
+    {
+        do_not_optimize(f());
+    }
+    auto end = bench_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+// The first timed batch serves as warmup and calibrates
+// how many calls are needed for a sample to be measurable.
+template <typename F>
+sample_stats measure(F f, const config& cfg)
+{
+    std::size_t calls = 1;
+    while (time_calls(f, calls) < cfg.min_sample_time && calls < (1u << 24))
+    {
+        calls *= 2;
+    }
+    std::vector<double> samples;
+    auto start = bench_clock::now();
+    double elapsed = 0;
+    while (samples.size() < cfg.min_reps ||
+        (elapsed < cfg.min_time && samples.size() < 1000))
+    {
+        samples.push_back(1e9 * time_calls(f, calls) / calls);
+        elapsed = std::chrono::duration<double>(
+            bench_clock::now() - start).count();
+    }
+    std::sort(std::begin(samples), std::end(samples));
+    sample_stats result;
+    result.reps = samples.size();
+    result.calls_per_rep = calls;
+    result.min = samples.front();
+    result.median = samples[samples.size() / 2];
+    std::size_t p90_idx = (samples.size() * 9 + 9) / 10 - 1;
+    result.p90 = samples[std::min(p90_idx, samples.size() - 1)];
+    const alloc_count::stats allocs = alloc_count::measure(f);
+    result.allocations = allocs.allocations;
+    result.bytes = allocs.bytes;
+    return result;
+}
+
+class runner
+{
+public:
+    explicit runner(const config& cfg) : cfg_(cfg), container_(), size_(0) {}
+    void set_input(const std::string& container, std::size_t size)
+    {
+        container_ = container;
+        size_ = size;
+    }
+    std::size_t size() const { return size_; }
+
+    template <typename F>
+    void run(const std::string& header, const std::string& function,
+        scaling s, F f)
+    {
+        if (!selected(header, function, s))
+            return;
+        benchmark_result r = make_result(header, function);
+        r.fplus = measure(f, cfg_);
+        report(r);
+    }
+
+    template <typename F, typename G>
+    void run_vs(const std::string& header, const std::string& function,
+        scaling s, F f, G baseline)
+    {
+        if (!selected(header, function, s))
+            return;
+        benchmark_result r = make_result(header, function);
+        r.fplus = measure(f, cfg_);
+        r.has_baseline = true;
+        r.baseline = measure(baseline, cfg_);
+        report(r);
+    }
+
+    const std::vector<benchmark_result>& results() const { return results_; }
+
+private:
+    bool selected(const std::string& header, const std::string& function,
+        scaling s) const
+    {
+        if (size_ > max_size_for(s))
+            return false;
+        if (s == scaling::combinatorial && size_ != cfg_.min_size)
+            return false;
+        if (cfg_.filter.empty())
+            return true;
+        return (header + "::" + function).find(cfg_.filter)
+            != std::string::npos;
+    }
+    benchmark_result make_result(const std::string& header,
+        const std::string& function) const
+    {
+        benchmark_result r;
+        r.header = header;
+        r.function = function;
+        r.container = container_;
+        r.size = size_;
+        r.has_baseline = false;
+        return r;
+    }
+    void report(const benchmark_result& r)
+    {
+        std::cout << std::left << std::setw(24) << r.header
+            << std::setw(40) << r.function
+            << std::setw(18) << r.container
+            << std::right << std::setw(9) << r.size
+            << std::fixed << std::setprecision(1)
+            << "  median " << std::setw(14) << r.fplus.median << " ns"
+            << "  p90 " << std::setw(14) << r.fplus.p90 << " ns"
+            << "  min " << std::setw(14) << r.fplus.min << " ns"
+            << "  allocs " << std::setw(8) << r.fplus.allocations;
+        if (r.has_baseline)
+        {
+            std::cout << "  baseline median " << std::setw(14)
+                << r.baseline.median << " ns  allocs " << std::setw(8)
+                << r.baseline.allocations << "  ratio "
+                << std::setprecision(2)
+                << r.fplus.median / r.baseline.median;
+        }
+        std::cout << std::endl;
+        results_.push_back(r);
+    }
+    const config& cfg_;
+    std::string container_;
+    std::size_t size_;
+    std::vector<benchmark_result> results_;
+};
+
+std::string json_escape(const std::string& str)
+{
+    std::string result;
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c;
+    }
+    return result;
+}
+
+void write_stats_json(std::ostream& out, const sample_stats& s)
+{
+    out << "{\"repetitions\": " << s.reps
+        << ", \"calls_per_repetition\": " << s.calls_per_rep
+        << ", \"min_ns\": " << s.min
+        << ", \"median_ns\": " << s.median
+        << ", \"p90_ns\": " << s.p90
+        << ", \"allocations\": " << s.allocations
+        << ", \"bytes_allocated\": " << s.bytes << "}";
+}
+
+void write_json(std::ostream& out, const std::vector<benchmark_result>& rs)
+{
+    out << std::setprecision(6) << std::fixed;
+    out << "{\n  \"clock\": \"std::chrono::steady_clock\",\n"
+        << "  \"benchmarks\": [";
+    bool first = true;
+    for (const auto& r : rs)
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        out << "    {\"header\": \"" << json_escape(r.header)
+            << "\", \"function\": \"" << json_escape(r.function)
+            << "\", \"container\": \"" << json_escape(r.container)
+            << "\", \"size\": " << r.size << ", \"fplus\": ";
+        write_stats_json(out, r.fplus);
+        out << ", \"baseline\": ";
+        if (r.has_baseline)
+        {
+            write_stats_json(out, r.baseline);
+            out << ", \"median_ratio_to_baseline\": "
+                << r.fplus.median / r.baseline.median;
+        }
+        else
+        {
+            out << "null";
+        }
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Input data
+
+template <typename T>
+struct elem_gen {};
+
+template <>
+struct elem_gen<int>
+{
+    static int random(std::mt19937& gen)
+    {
+        return std::uniform_int_distribution<int>(0, 999)(gen);
+    }
+    static int absent() { return -1; }
+};
+
+template <>
+struct elem_gen<char>
+{
+    static char random(std::mt19937& gen)
+    {
+        static const std::string alphabet =
+            "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+            "   0123456789 .,;:!?-\n\r\t\n";
+        return alphabet[std::uniform_int_distribution<std::size_t>(
+            0, alphabet.size() - 1)(gen)];
+    }
+    static char absent() { return '#'; }
+};
+
+template <typename Container>
+Container make_input(std::size_t n)
+{
+    typedef typename Container::value_type T;
+    std::mt19937 gen(42);
+    std::vector<T> xs;
+    xs.reserve(n);
+    for (std::size_t i = 0; i < n; ++i)
+        xs.push_back(elem_gen<T>::random(gen));
+    return Container(std::begin(xs), std::end(xs));
+}
+
+// Applies f to every element and accumulates the results,
+// so scalar functions can be measured inside a loop.
+template <typename F, typename Container>
+long long accumulate_with(F f, const Container& xs)
+{
+    long long acc = 0;
+    for (const auto& x : xs)
+        acc += static_cast<long long>(f(x));
+    return acc;
+}
+
+// Applies the binary function f to all neighbouring pairs
+// and accumulates the results.
+template <typename F, typename Container>
+long long accumulate_adjacent_with(F f, const Container& xs)
+{
+    long long acc = 0;
+    if (xs.empty())
+        return acc;
+    auto it1 = std::begin(xs);
+    auto it2 = std::next(it1);
+    for (; it2 != std::end(xs); ++it1, ++it2)
+        acc += static_cast<long long>(f(*it1, *it2));
+    return acc;
+}
+
+template <typename Container>
+struct is_random_access : public std::is_base_of<
+    std::random_access_iterator_tag,
+    typename std::iterator_traits<
+        typename Container::iterator>::iterator_category> {};
+
+// Benchmarks, one function per header.
+// Functions that need a particular kind of container
+// (random access, numbers as elements, strings)
+// are dispatched by the suites at the end of this section.
+
+template <typename Container>
+void bench_container_common(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "container_common.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const scaling quad = scaling::quadratic;
+    const Container ones(n, T(1));
+    const Container token = fplus::get_range(n / 2, n / 2 + 3, xs);
+    Container mutable_xs = xs;
+    const T absent = elem_gen<T>::absent();
+    std::vector<Container> chunks;
+    for (std::size_t i = 0; i + 10 <= n; i += 10)
+        chunks.push_back(fplus::get_range(i, i + 10, xs));
+    std::vector<std::size_t> some_idxs;
+    for (std::size_t i = 0; i < 100; ++i)
+        some_idxs.push_back(i * n / 100);
+    auto times_3 = [](T x) -> T { return static_cast<T>(x * 3); };
+    auto is_even = [](T x) { return x % 2 == 0; };
+    auto is_absent = [absent](T x) { return x == absent; };
+    auto is_not_absent = [absent](T x) { return x != absent; };
+    auto plus = [](T a, T b) -> T { return static_cast<T>(a + b); };
+    auto add_to_acc = [](long long acc, T x) { return acc + x; };
+    auto add_to_acc_r = [](T x, long long acc) { return acc + x; };
+    auto eq_by_parity = [](T a, T b) { return a % 2 == b % 2; };
+    auto eq = [](T a, T b) { return a == b; };
+
+    r.run(h, "is_empty", lin, [&]{ return fplus::is_empty(xs); });
+    r.run(h, "is_not_empty", lin, [&]{ return fplus::is_not_empty(xs); });
+    r.run(h, "size_of_cont", lin, [&]{ return fplus::size_of_cont(xs); });
+    r.run(h, "convert_elems", lin,
+        [&]{ return fplus::convert_elems<T>(xs); });
+    r.run_vs(h, "convert_container", lin,
+        [&]{ return fplus::convert_container<std::vector<T>>(xs); },
+        [&]{ return std::vector<T>(std::begin(xs), std::end(xs)); });
+    r.run(h, "convert_container_and_elems", lin,
+        [&]{ return fplus::convert_container_and_elems<
+            std::vector<long long>>(xs); });
+    r.run(h, "get_range", lin,
+        [&]{ return fplus::get_range(n / 4, n / 2, xs); });
+    r.run(h, "set_range", lin,
+        [&]{ return fplus::set_range(n / 2, token, xs); });
+    r.run(h, "remove_range", lin,
+        [&]{ return fplus::remove_range(n / 4, n / 2, xs); });
+    r.run(h, "insert_at", lin,
+        [&]{ return fplus::insert_at(n / 2, token, xs); });
+    r.run(h, "replace_range", lin,
+        [&]{ return fplus::replace_range(n / 2, token, xs); });
+    r.run(h, "elem_at_idx", lin,
+        [&]{ return fplus::elem_at_idx(n / 2, xs); });
+    r.run(h, "elems_at_idxs", lin,
+        [&]{ return fplus::elems_at_idxs(some_idxs, xs); });
+    r.run(h, "nth_element", lin,
+        [&]{ return fplus::nth_element<Container>(n / 2)(xs); });
+    r.run(h, "nth_element_flipped", lin,
+        [&]{ return fplus::nth_element_flipped(xs)(n / 2); });
+    r.run_vs(h, "transform", lin,
+        [&]{ return fplus::transform(times_3, xs); },
+        [&]
+        {
+            Container ys;
+            std::transform(std::begin(xs), std::end(xs),
+                std::inserter(ys, std::end(ys)), times_3);
+            return ys;
+        });
+    r.run_vs(h, "reverse", lin,
+        [&]{ return fplus::reverse(xs); },
+        [&]{ return Container(xs.rbegin(), xs.rend()); });
+    r.run(h, "take", lin, [&]{ return fplus::take(n / 2, xs); });
+    r.run(h, "drop", lin, [&]{ return fplus::drop(n / 2, xs); });
+    r.run_vs(h, "fold_left", lin,
+        [&]{ return fplus::fold_left(add_to_acc, 0ll, xs); },
+        [&]{ return std::accumulate(std::begin(xs), std::end(xs), 0ll); });
+    r.run(h, "fold_left_1", lin,
+        [&]{ return fplus::fold_left_1(plus, xs); });
+    r.run(h, "fold_right", lin,
+        [&]{ return fplus::fold_right(add_to_acc_r, 0ll, xs); });
+    r.run(h, "fold_right_1", lin,
+        [&]{ return fplus::fold_right_1(plus, xs); });
+    r.run(h, "scan_left", lin,
+        [&]{ return fplus::scan_left(plus, T(0), xs); });
+    r.run(h, "scan_left_1", lin,
+        [&]{ return fplus::scan_left_1(plus, xs); });
+    r.run(h, "scan_right", lin,
+        [&]{ return fplus::scan_right(plus, T(0), xs); });
+    r.run(h, "scan_right_1", lin,
+        [&]{ return fplus::scan_right_1(plus, xs); });
+    r.run_vs(h, "sum", lin,
+        [&]{ return fplus::sum(xs); },
+        [&]{ return std::accumulate(std::begin(xs), std::end(xs), T()); });
+    r.run(h, "append", lin, [&]{ return fplus::append(xs, xs); });
+    r.run(h, "concat", lin, [&]{ return fplus::concat(chunks); });
+    r.run(h, "sort_by", lin,
+        [&]{ return fplus::sort_by(std::greater<T>(), xs); });
+    r.run(h, "sort", lin, [&]{ return fplus::sort(xs); });
+    r.run(h, "unique_by", lin,
+        [&]{ return fplus::unique_by(eq_by_parity, xs); });
+    r.run(h, "unique", lin, [&]{ return fplus::unique(xs); });
+    r.run(h, "intersperse", lin,
+        [&]{ return fplus::intersperse(T(0), xs); });
+    r.run(h, "join", lin, [&]{ return fplus::join(token, chunks); });
+    r.run_vs(h, "is_elem_of_by", lin,
+        [&]{ return fplus::is_elem_of_by(is_absent, xs); },
+        [&]{ return std::find_if(std::begin(xs), std::end(xs), is_absent)
+            != std::end(xs); });
+    r.run_vs(h, "is_elem_of", lin,
+        [&]{ return fplus::is_elem_of(absent, xs); },
+        [&]{ return std::find(std::begin(xs), std::end(xs), absent)
+            != std::end(xs); });
+    r.run(h, "nub_by", quad, [&]{ return fplus::nub_by(eq, xs); });
+    r.run_vs(h, "nub_vs_nub_by", quad,
+        [&]{ return fplus::nub(xs); },
+        [&]{ return fplus::nub_by(eq, xs); });
+    r.run(h, "nub", lin, [&]{ return fplus::nub(xs); });
+    r.run(h, "nub_hash", lin, [&]{ return fplus::nub_hash(xs); });
+    auto identity = [](T x) { return x; };
+    r.run(h, "nub_on", lin, [&]{ return fplus::nub_on(identity, xs); });
+    r.run(h, "all_unique_by_eq", quad,
+        [&]{ return fplus::all_unique_by_eq(eq, xs); });
+    r.run_vs(h, "all_unique_vs_all_unique_by_eq", quad,
+        [&]{ return fplus::all_unique(xs); },
+        [&]{ return fplus::all_unique_by_eq(eq, xs); });
+    r.run(h, "all_unique", lin, [&]{ return fplus::all_unique(xs); });
+    r.run(h, "all_unique_hash", lin,
+        [&]{ return fplus::all_unique_hash(xs); });
+    r.run(h, "is_prefix_of", lin,
+        [&]{ return fplus::is_prefix_of(token, mutable_xs); });
+    r.run(h, "is_suffix_of", lin,
+        [&]{ return fplus::is_suffix_of(token, mutable_xs); });
+    r.run_vs(h, "all_by", lin,
+        [&]{ return fplus::all_by(is_not_absent, xs); },
+        [&]{ return std::all_of(std::begin(xs), std::end(xs),
+            is_not_absent); });
+    r.run(h, "all", lin, [&]{ return fplus::all(ones); });
+    r.run(h, "all_the_same_by", lin,
+        [&]{ return fplus::all_the_same_by(eq, ones); });
+    r.run(h, "all_the_same", lin,
+        [&]{ return fplus::all_the_same(ones); });
+    r.run(h, "init", lin, [&]{ return fplus::init(xs); });
+    r.run(h, "tail", lin, [&]{ return fplus::tail(xs); });
+    do_not_optimize(is_even);
+}
+
+template <typename Container>
+void bench_container_common_random_access(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "container_common.h";
+    const scaling lin = scaling::linear;
+    const Container sorted = fplus::sort(xs);
+    const Container strictly_sorted = fplus::unique(sorted);
+    auto less = [](T a, T b) { return a < b; };
+
+    r.run_vs(h, "is_strictly_sorted_by", lin,
+        [&]{ return fplus::is_strictly_sorted_by(less, strictly_sorted); },
+        [&]{ return std::adjacent_find(std::begin(strictly_sorted),
+            std::end(strictly_sorted), std::greater_equal<T>())
+            == std::end(strictly_sorted); });
+    r.run_vs(h, "is_sorted_by", lin,
+        [&]{ return fplus::is_sorted_by(less, sorted); },
+        [&]{ return std::is_sorted(std::begin(sorted), std::end(sorted)); });
+    r.run(h, "is_strictly_sorted", lin,
+        [&]{ return fplus::is_strictly_sorted(strictly_sorted); });
+    r.run(h, "is_sorted", lin, [&]{ return fplus::is_sorted(sorted); });
+}
+
+template <typename Container>
+void bench_container_common_numbers(runner& r, const Container&)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "container_common.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    r.run(h, "generate_range_step", lin,
+        [&]{ return fplus::generate_range_step<Container, T>(
+            0, static_cast<T>(2 * n), 2); });
+    r.run(h, "generate_range", lin,
+        [&]{ return fplus::generate_range<Container, T>(
+            0, static_cast<T>(n)); });
+    r.run(h, "all_idxs", lin, [&]{ return fplus::all_idxs(
+        std::vector<T>(n)); });
+}
+
+template <typename Container>
+void bench_filter(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "filter.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const Container token = fplus::take(2, xs);
+    const Container padded = fplus::append(fplus::append(
+        fplus::repeat(n / 20, token), xs), fplus::repeat(n / 20, token));
+    std::vector<std::size_t> every_other_idx;
+    for (std::size_t i = 0; i < n; i += 2)
+        every_other_idx.push_back(i);
+    auto is_odd = [](T x) { return x % 2 == 1; };
+    auto idx_and_x_even = [](std::size_t i, T x)
+        { return (i + static_cast<std::size_t>(x)) % 2 == 0; };
+    auto idx_even = [](std::size_t i) { return i % 2 == 0; };
+    const T front = xs.front();
+    auto is_front = [front](T x) { return x == front; };
+
+    r.run_vs(h, "keep_if", lin,
+        [&]{ return fplus::keep_if(is_odd, xs); },
+        [&]
+        {
+            Container odds;
+            for (T x : xs)
+                if (is_odd(x))
+                    odds.push_back(x);
+            return odds;
+        });
+    r.run_vs(h, "drop_if", lin,
+        [&]{ return fplus::drop_if(is_odd, xs); },
+        [&]
+        {
+            Container evens;
+            for (T x : xs)
+                if (!is_odd(x))
+                    evens.push_back(x);
+            return evens;
+        });
+    r.run(h, "without", lin, [&]{ return fplus::without(front, xs); });
+    r.run(h, "keep_if_with_idx", lin,
+        [&]{ return fplus::keep_if_with_idx(idx_and_x_even, xs); });
+    r.run(h, "drop_if_with_idx", lin,
+        [&]{ return fplus::drop_if_with_idx(idx_and_x_even, xs); });
+    r.run(h, "keep_by_idx", lin,
+        [&]{ return fplus::keep_by_idx(idx_even, xs); });
+    r.run(h, "drop_by_idx", lin,
+        [&]{ return fplus::drop_by_idx(idx_even, xs); });
+    r.run(h, "keep_idxs", lin,
+        [&]{ return fplus::keep_idxs(every_other_idx, xs); });
+    r.run(h, "drop_idxs", lin,
+        [&]{ return fplus::drop_idxs(every_other_idx, xs); });
+    r.run(h, "trim_left_by", lin,
+        [&]{ return fplus::trim_left_by(is_front, xs); });
+    r.run(h, "trim_left", lin, [&]{ return fplus::trim_left(front, xs); });
+    r.run(h, "trim_token_left", lin,
+        [&]{ return fplus::trim_token_left(token, padded); });
+    r.run(h, "trim_right_by", lin,
+        [&]{ return fplus::trim_right_by(is_front, xs); });
+    r.run(h, "trim_right", lin,
+        [&]{ return fplus::trim_right(front, xs); });
+    r.run(h, "trim_token_right", lin,
+        [&]{ return fplus::trim_token_right(token, padded); });
+    r.run(h, "trim_by", lin, [&]{ return fplus::trim_by(is_front, xs); });
+    r.run(h, "trim", lin, [&]{ return fplus::trim(front, xs); });
+    r.run(h, "trim_token", lin,
+        [&]{ return fplus::trim_token(token, padded); });
+}
+
+template <typename Container>
+void bench_generate(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "generate.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const scaling quad = scaling::quadratic;
+    const scaling quad_mem = scaling::quadratic_memory;
+    const scaling comb = scaling::combinatorial;
+    const Container few = fplus::take(8, xs);
+    const Container sixteen = fplus::take(16, xs);
+    // power_set builds its combinations from an n-ary carthesian product,
+    // so it needs a much smaller input than the other functions.
+    const Container six = fplus::take(6, xs);
+    auto seven = []() { return T(7); };
+    auto idx_to_t = [](std::size_t i) { return static_cast<T>(i % 100); };
+    auto combine = [](T x, T y) { return x + y; };
+    auto sum_is_even = [](T x, T y) { return (x + y) % 2 == 0; };
+    auto times_3 = [](T x) -> T { return static_cast<T>(x * 3); };
+
+    r.run(h, "generate", lin,
+        [&]{ return fplus::generate<Container>(seven, n); });
+    r.run(h, "generate_by_idx", lin,
+        [&]{ return fplus::generate_by_idx<Container>(idx_to_t, n); });
+    r.run(h, "repeat", lin, [&]{ return fplus::repeat(3, xs); });
+    r.run_vs(h, "replicate", lin,
+        [&]{ return fplus::replicate<T, Container>(n, T(7)); },
+        [&]{ return Container(n, T(7)); });
+    r.run(h, "infixes", quad, [&]{ return fplus::infixes(3, xs); });
+    r.run(h, "carthesian_product_with_where", lin,
+        [&]{ return fplus::carthesian_product_with_where(
+            combine, sum_is_even, xs, few); });
+    r.run(h, "carthesian_product_with", lin,
+        [&]{ return fplus::carthesian_product_with(combine, xs, few); });
+    r.run(h, "carthesian_product_where", lin,
+        [&]{ return fplus::carthesian_product_where(sum_is_even, xs, few); });
+    r.run(h, "carthesian_product", lin,
+        [&]{ return fplus::carthesian_product(xs, few); });
+    r.run(h, "carthesian_product_n", comb,
+        [&]{ return fplus::carthesian_product_n(2, sixteen); });
+    r.run(h, "permutations", comb,
+        [&]{ return fplus::permutations(2, sixteen); });
+    r.run(h, "combinations", comb,
+        [&]{ return fplus::combinations(3, sixteen); });
+    r.run(h, "combinations_with_replacement", comb,
+        [&]{ return fplus::combinations_with_replacement(2, sixteen); });
+    r.run(h, "power_set", comb, [&]{ return fplus::power_set(six); });
+    r.run(h, "iterate", lin,
+        [&]{ return fplus::iterate(times_3, n, T(1)); });
+    r.run(h, "rotate_left", lin, [&]{ return fplus::rotate_left(xs); });
+    r.run(h, "rotate_right", lin, [&]{ return fplus::rotate_right(xs); });
+    r.run(h, "rotations_left", quad_mem,
+        [&]{ return fplus::rotations_left(xs); });
+    r.run(h, "rotations_right", quad_mem,
+        [&]{ return fplus::rotations_right(xs); });
+    r.run(h, "fill_left", lin,
+        [&]{ return fplus::fill_left(T(0), n + n / 2, xs); });
+    r.run(h, "fill_right", lin,
+        [&]{ return fplus::fill_right(T(0), n + n / 2, xs); });
+    r.run(h, "inits", quad_mem, [&]{ return fplus::inits(xs); });
+    r.run(h, "tails", quad_mem, [&]{ return fplus::tails(xs); });
+}
+
+template <typename Container>
+void bench_container_properties(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "container_properties.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const T absent = elem_gen<T>::absent();
+    const Container absent_token(3, absent);
+    const Container subsequence = fplus::keep_by_idx(
+        [n](std::size_t i) { return i % (n / 10) == 0; }, xs);
+    const Container zeros(n, T(0));
+    auto is_absent = [absent](T x) { return x == absent; };
+    auto is_even = [](T x) { return x % 2 == 0; };
+    auto less = [](T a, T b) { return a < b; };
+
+    r.run_vs(h, "any_by", lin,
+        [&]{ return fplus::any_by(is_absent, xs); },
+        [&]{ return std::any_of(std::begin(xs), std::end(xs), is_absent); });
+    r.run(h, "any", lin, [&]{ return fplus::any(zeros); });
+    r.run(h, "none_by", lin,
+        [&]{ return fplus::none_by(is_absent, xs); });
+    r.run(h, "none", lin, [&]{ return fplus::none(zeros); });
+    r.run(h, "minimum_by", lin, [&]{ return fplus::minimum_by(less, xs); });
+    r.run(h, "maximum_by", lin, [&]{ return fplus::maximum_by(less, xs); });
+    r.run_vs(h, "minimum", lin,
+        [&]{ return fplus::minimum(xs); },
+        [&]{ return *std::min_element(std::begin(xs), std::end(xs)); });
+    r.run_vs(h, "maximum", lin,
+        [&]{ return fplus::maximum(xs); },
+        [&]{ return *std::max_element(std::begin(xs), std::end(xs)); });
+    r.run(h, "minimum_idx_by", lin,
+        [&]{ return fplus::minimum_idx_by(less, xs); });
+    r.run(h, "maximum_idx_by", lin,
+        [&]{ return fplus::maximum_idx_by(less, xs); });
+    r.run(h, "minimum_idx", lin, [&]{ return fplus::minimum_idx(xs); });
+    r.run(h, "maximum_idx", lin, [&]{ return fplus::maximum_idx(xs); });
+    r.run(h, "mean", lin, [&]{ return fplus::mean<double>(xs); });
+    r.run(h, "median", lin, [&]{ return fplus::median(xs); });
+    r.run(h, "all_unique_by_less", lin,
+        [&]{ return fplus::all_unique_by_less(less, xs); });
+    r.run(h, "all_unique_less", lin,
+        [&]{ return fplus::all_unique_less(xs); });
+    r.run(h, "is_infix_of", lin,
+        [&]{ return fplus::is_infix_of(absent_token, xs); });
+    r.run(h, "is_subsequence_of", lin,
+        [&]{ return fplus::is_subsequence_of(subsequence, xs); });
+    r.run_vs(h, "count_if", lin,
+        [&]{ return fplus::count_if(is_even, xs); },
+        [&]{ return std::count_if(std::begin(xs), std::end(xs), is_even); });
+    r.run_vs(h, "count", lin,
+        [&]{ return fplus::count(T(7), xs); },
+        [&]{ return std::count(std::begin(xs), std::end(xs), T(7)); });
+}
+
+template <typename Container>
+void bench_search(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "search.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const T absent = elem_gen<T>::absent();
+    const Container token = fplus::get_range(n / 2, n / 2 + 3, xs);
+    const Container absent_token = fplus::append(Container(1, absent), token);
+    auto is_absent = [absent](T x) { return x == absent; };
+    auto is_even = [](T x) { return x % 2 == 0; };
+
+    r.run_vs(h, "find_first_by", lin,
+        [&]{ return fplus::find_first_by(is_absent, xs); },
+        [&]{ return std::find_if(std::begin(xs), std::end(xs), is_absent)
+            != std::end(xs); });
+    r.run(h, "find_last_by", lin,
+        [&]{ return fplus::find_last_by(is_absent, xs); });
+    r.run(h, "find_first_idx_by", lin,
+        [&]{ return fplus::find_first_idx_by(is_absent, xs); });
+    r.run(h, "find_last_idx_by", lin,
+        [&]{ return fplus::find_last_idx_by(is_absent, xs); });
+    r.run_vs(h, "find_first_idx", lin,
+        [&]{ return fplus::find_first_idx(absent, xs); },
+        [&]{ return std::distance(std::begin(xs),
+            std::find(std::begin(xs), std::end(xs), absent)); });
+    r.run(h, "find_last_idx", lin,
+        [&]{ return fplus::find_last_idx(absent, xs); });
+    r.run(h, "find_all_idxs_by", lin,
+        [&]{ return fplus::find_all_idxs_by(is_even, xs); });
+    r.run(h, "find_all_idxs_of", lin,
+        [&]{ return fplus::find_all_idxs_of(T(7), xs); });
+    r.run_vs(h, "find_all_instances_of_token", lin,
+        [&]{ return fplus::find_all_instances_of_token(token, xs); },
+        [&]
+        {
+            std::vector<std::size_t> result;
+            auto it = std::search(std::begin(xs), std::end(xs),
+                std::begin(token), std::end(token));
+            while (it != std::end(xs))
+            {
+                result.push_back(static_cast<std::size_t>(
+                    std::distance(std::begin(xs), it)));
+                it = std::search(std::next(it), std::end(xs),
+                    std::begin(token), std::end(token));
+            }
+            return result;
+        });
+    r.run(h, "find_all_instances_of_token_non_overlapping", lin,
+        [&]{ return fplus::find_all_instances_of_token_non_overlapping(
+            token, xs); });
+    std::vector<Container> tokens;
+    for (std::size_t k = 1; k <= 8; ++k)
+        tokens.push_back(fplus::get_range(k * n / 16, k * n / 16 + 3, xs));
+    const auto automaton = fplus::make_token_automaton(tokens);
+    r.run_vs(h, "find_all_instances_of_tokens", lin,
+        [&]{ return fplus::find_all_instances_of_tokens(automaton, xs); },
+        [&]
+        {
+            std::vector<std::vector<std::size_t>> result;
+            for (const auto& t : tokens)
+                result.push_back(fplus::find_all_instances_of_token(t, xs));
+            return result;
+        });
+    r.run_vs(h, "find_first_instance_of_token", lin,
+        [&]{ return fplus::find_first_instance_of_token(absent_token, xs); },
+        [&]{ return std::search(std::begin(xs), std::end(xs),
+            std::begin(absent_token), std::end(absent_token))
+            != std::end(xs); });
+}
+
+template <typename Container>
+void bench_replace(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "replace.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const Container source = fplus::get_range(n / 2, n / 2 + 2, xs);
+    const Container dest(3, T(0));
+    auto is_even = [](T x) { return x % 2 == 0; };
+
+    r.run_vs(h, "replace_if", lin,
+        [&]{ return fplus::replace_if(is_even, T(0), xs); },
+        [&]
+        {
+            Container ys = xs;
+            std::replace_if(std::begin(ys), std::end(ys), is_even, T(0));
+            return ys;
+        });
+    r.run(h, "replace_elems", lin,
+        [&]{ return fplus::replace_elems(T(7), T(0), xs); });
+    r.run_vs(h, "replace_tokens", lin,
+        [&]{ return fplus::replace_tokens(source, dest, xs); },
+        [&]
+        {
+            return fplus::join(dest, fplus::split_by_token(source, true, xs));
+        });
+    const Container same_size_dest(2, T(0));
+    r.run_vs(h, "replace_tokens_in_place", lin,
+        [&]
+        {
+            Container ys = xs;
+            return fplus::replace_tokens(source, same_size_dest,
+                std::move(ys));
+        },
+        [&]
+        {
+            Container ys = xs;
+            return fplus::replace_tokens(source, same_size_dest, ys);
+        });
+    std::vector<std::pair<Container, Container>> mapping;
+    for (std::size_t k = 1; k <= 8; ++k)
+        mapping.push_back(std::make_pair(
+            fplus::get_range(k * n / 16, k * n / 16 + 2, xs), dest));
+    r.run_vs(h, "replace_tokens_many", lin,
+        [&]{ return fplus::replace_tokens_many(mapping, xs); },
+        [&]
+        {
+            Container ys = xs;
+            for (const auto& source_and_dest : mapping)
+                ys = fplus::replace_tokens(
+                    source_and_dest.first, source_and_dest.second, ys);
+            return ys;
+        });
+}
+
+template <typename Container>
+void bench_split(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "split.h";
+    const std::size_t n = r.size();
+    const scaling lin = scaling::linear;
+    const scaling quad = scaling::quadratic;
+    const Container token = fplus::get_range(n / 2, n / 2 + 2, xs);
+    const std::vector<std::size_t> split_idxs = {n / 4, n / 2, 3 * n / 4};
+    const auto encoded = fplus::run_length_encode(xs);
+    Container runs;
+    for (const auto& x : fplus::take(n / 3, xs))
+        for (std::size_t i = 0; i < static_cast<std::size_t>(x % 5 + 1); ++i)
+            runs.push_back(x);
+    auto same_parity = [](T a, T b) { return a % 2 == b % 2; };
+    auto same_mod_7 = [](T a, T b) { return a % 7 == b % 7; };
+    auto is_multiple_of_7 = [](T x) { return x % 7 == 0; };
+    auto is_even = [](T x) { return x % 2 == 0; };
+    auto is_not_absent = [](T x) { return x != elem_gen<T>::absent(); };
+    auto eq = [](T a, T b) { return a == b; };
+
+    r.run(h, "group_by", lin, [&]{ return fplus::group_by(same_parity, xs); });
+    r.run(h, "group", lin, [&]{ return fplus::group(runs); });
+    r.run_vs(h, "group_by_spans", lin,
+        [&]{ return fplus::group_by_spans(eq, runs); },
+        [&]{ return fplus::group_by(eq, runs); });
+    r.run(h, "group_globally_by", lin,
+        [&]{ return fplus::group_globally_by(same_mod_7, xs); });
+    r.run(h, "group_globally", quad,
+        [&]{ return fplus::group_globally(xs); });
+    auto identity = [](T x) { return x; };
+    auto hash = [](T x) { return std::hash<T>()(x); };
+    r.run_vs(h, "group_globally_on_vs_group_globally", quad,
+        [&]{ return fplus::group_globally_on(identity, xs); },
+        [&]{ return fplus::group_globally(xs); });
+    r.run(h, "group_globally_on", lin,
+        [&]{ return fplus::group_globally_on(identity, xs); });
+    r.run(h, "group_globally_by_hash", lin,
+        [&]{ return fplus::group_globally_by_hash(hash, eq, xs); });
+    r.run(h, "group_globally_on_ordered", lin,
+        [&]{ return fplus::group_globally_on_ordered(identity, xs); });
+    r.run(h, "split_by", lin,
+        [&]{ return fplus::split_by(is_multiple_of_7, true, xs); });
+    r.run(h, "split", lin, [&]{ return fplus::split(T(7), true, xs); });
+    r.run(h, "split_at_idx", lin,
+        [&]{ return fplus::split_at_idx(n / 2, xs); });
+    r.run(h, "partition", lin, [&]{ return fplus::partition(is_even, xs); });
+    r.run(h, "split_at_idxs", lin,
+        [&]{ return fplus::split_at_idxs(split_idxs, xs); });
+    r.run(h, "split_by_token", lin,
+        [&]{ return fplus::split_by_token(token, true, xs); });
+    r.run_vs(h, "count_occurrences", lin,
+        [&]{ return fplus::count_occurrences(xs); },
+        [&]
+        {
+            std::map<T, std::size_t> result;
+            for (const auto& x : xs)
+                ++result[x];
+            return result;
+        });
+    r.run_vs(h, "count_occurrences_hash", lin,
+        [&]{ return fplus::count_occurrences_hash(xs); },
+        [&]
+        {
+            std::unordered_map<T, std::size_t> result;
+            for (const auto& x : xs)
+                ++result[x];
+            return result;
+        });
+    r.run(h, "count_occurrences_flat", lin,
+        [&]{ return fplus::count_occurrences_flat(xs); });
+    r.run(h, "run_length_encode_by", lin,
+        [&]{ return fplus::run_length_encode_by(eq, runs); });
+    r.run(h, "run_length_encode", lin,
+        [&]{ return fplus::run_length_encode(runs); });
+    r.run(h, "run_length_decode", lin,
+        [&]{ return fplus::run_length_decode(encoded); });
+    r.run(h, "take_while", lin,
+        [&]{ return fplus::take_while(is_not_absent, xs); });
+    r.run(h, "drop_while", lin,
+        [&]{ return fplus::drop_while(is_not_absent, xs); });
+}
+
+template <typename Container>
+void bench_lazy(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "lazy.h";
+    const scaling lin = scaling::linear;
+    const T absent = elem_gen<T>::absent();
+    auto times_3 = [](T x) -> T { return static_cast<T>(x * 3); };
+    auto plus_1 = [](T x) -> T { return static_cast<T>(x + 1); };
+    auto is_even = [](T x) { return x % 2 == 0; };
+
+    // The baselines are the eager equivalents.
+    r.run_vs(h, "transform_keep_if", lin,
+        [&]
+        {
+            return fplus::lazy::materialize(fplus::lazy::transform(times_3,
+                fplus::lazy::keep_if(is_even, xs)));
+        },
+        [&]{ return fplus::transform(times_3, fplus::keep_if(is_even, xs)); });
+    r.run_vs(h, "take_keep_if", lin,
+        [&]
+        {
+            return fplus::lazy::materialize(
+                fplus::lazy::take(10, fplus::lazy::keep_if(is_even, xs)));
+        },
+        [&]{ return fplus::take(10, fplus::keep_if(is_even, xs)); });
+    r.run_vs(h, "is_elem_of_transform", lin,
+        [&]
+        {
+            return fplus::lazy::is_elem_of(absent,
+                fplus::lazy::transform(plus_1, xs));
+        },
+        [&]{ return fplus::is_elem_of(absent, fplus::transform(plus_1, xs)); });
+}
+
+template <typename Container>
+void bench_transform(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "transform.h";
+    const scaling lin = scaling::linear;
+    auto times_3 = [](T x) -> T { return static_cast<T>(x * 3); };
+    auto plus_idx = [](std::size_t i, T x) -> T
+        { return static_cast<T>(x + i); };
+
+    r.run(h, "transform_convert", lin,
+        [&]{ return fplus::transform_convert<std::vector<T>>(times_3, xs); });
+    r.run(h, "transform_with_idx", lin,
+        [&]{ return fplus::transform_with_idx(plus_idx, xs); });
+}
+
+template <typename Container>
+void bench_transform_numbers(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "transform.h";
+    const scaling lin = scaling::linear;
+    auto to_pair_vec = [](T x) { return std::vector<T>(2, x); };
+
+    r.run(h, "transform_and_concat", lin,
+        [&]{ return fplus::transform_and_concat(to_pair_vec, xs); });
+}
+
+template <typename Container>
+void bench_par(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "par.h";
+    const scaling lin = scaling::linear;
+    auto times_3 = [](T x) -> T { return static_cast<T>(x * 3); };
+    auto plus_idx = [](std::size_t i, T x) -> T
+        { return static_cast<T>(x + i); };
+    auto is_even = [](T x) { return x % 2 == 0; };
+    auto plus = [](T x, T y) -> T { return static_cast<T>(x + y); };
+
+    // The baselines are the sequential versions.
+    r.run_vs(h, "transform", lin,
+        [&]{ return fplus::par::transform(times_3, xs); },
+        [&]{ return fplus::transform(times_3, xs); });
+    r.run_vs(h, "transform_with_idx", lin,
+        [&]{ return fplus::par::transform_with_idx(plus_idx, xs); },
+        [&]{ return fplus::transform_with_idx(plus_idx, xs); });
+    r.run_vs(h, "keep_if", lin,
+        [&]{ return fplus::par::keep_if(is_even, xs); },
+        [&]{ return fplus::keep_if(is_even, xs); });
+    r.run_vs(h, "count_if", lin,
+        [&]{ return fplus::par::count_if(is_even, xs); },
+        [&]{ return fplus::count_if(is_even, xs); });
+    r.run_vs(h, "all_by", lin,
+        [&]{ return fplus::par::all_by(is_even, xs); },
+        [&]{ return fplus::all_by(is_even, xs); });
+    r.run_vs(h, "sum", lin,
+        [&]{ return fplus::par::sum(xs); },
+        [&]{ return fplus::sum(xs); });
+    r.run_vs(h, "fold_left", lin,
+        [&]{ return fplus::par::fold_left(plus, T(0), xs); },
+        [&]{ return fplus::fold_left(plus, T(0), xs); });
+    r.run_vs(h, "sort_by", lin,
+        [&]{ return fplus::par::sort_by(std::less<T>(), xs); },
+        [&]{ return fplus::sort_by(std::less<T>(), xs); });
+    r.run_vs(h, "count_occurrences", lin,
+        [&]{ return fplus::par::count_occurrences(xs); },
+        [&]{ return fplus::count_occurrences(xs); });
+}
+
+template <typename Container>
+void bench_transform_random_access(runner& r, const Container& xs)
+{
+    const std::string h = "transform.h";
+    const std::size_t n = r.size();
+    r.run(h, "sample", scaling::linear,
+        [&]{ return fplus::sample(n / 2, xs); });
+}
+
+template <typename Container>
+void bench_pairs(runner& r, const Container& xs)
+{
+    typedef typename Container::value_type T;
+    const std::string h = "pairs.h";
+    const scaling lin = scaling::linear;
+    typedef std::pair<T, T> Pair;
+    const auto pairs = fplus::zip(xs, xs);
+    auto plus = [](T a, T b) { return a + b; };
+    auto times_3 = [](T x) { return x * 3; };
+
+    r.run_vs(h, "zip_with", lin,
+        [&]{ return fplus::zip_with(plus, xs, xs); },
+        [&]
+        {
+            std::vector<T> result;
+            result.reserve(xs.size());
+            std::transform(std::begin(xs), std::end(xs), std::begin(xs),
+                std::back_inserter(result), plus);
+            return result;
+        });
+    r.run(h, "zip", lin, [&]{ return fplus::zip(xs, xs); });
+    r.run(h, "unzip", lin, [&]{ return fplus::unzip(pairs); });
+    r.run(h, "fst", lin,
+        [&]{ return accumulate_with(fplus::fst<T, T>, pairs); });
+    r.run(h, "snd", lin,
+        [&]{ return accumulate_with(fplus::snd<T, T>, pairs); });
+    r.run(h, "transform_fst", lin, [&]
+        {
+            return accumulate_with([&](const Pair& p)
+                { return fplus::transform_fst(times_3, p).first; }, pairs);
+        });
+    r.run(h, "transform_snd", lin, [&]
+        {
+            return accumulate_with([&](const Pair& p)
+                { return fplus::transform_snd(times_3, p).second; }, pairs);
+        });
+    r.run(h, "swap_pair_elems", lin, [&]
+        {
+            return accumulate_with([](const Pair& p)
+                { return fplus::swap_pair_elems(p).first; }, pairs);
+        });
+    r.run(h, "overlapping_pairs", lin,
+        [&]{ return fplus::overlapping_pairs<std::vector<Pair>>(xs); });
+}
+
+template <typename Container>
+void bench_show(runner& r, const Container& xs)
+{
+    const std::string h = "show.h";
+    const scaling lin = scaling::linear;
+    r.run(h, "show_cont_with_frame", lin,
+        [&]{ return fplus::show_cont_with_frame(", ", "{", "}", xs); });
+    r.run(h, "show_cont_with", lin,
+        [&]{ return fplus::show_cont_with(" - ", xs); });
+    r.run(h, "show_cont", lin, [&]{ return fplus::show_cont(xs); });
+}
+
+// Functions working on single values are measured
+// by applying them to every element of a std::vector<int>.
+
+void bench_numeric(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "numeric.h";
+    const scaling lin = scaling::linear;
+    std::vector<double> ds = fplus::transform(
+        [](int x) { return (x - 500) * 0.37; }, xs);
+    auto mod_7 = [](int x) { return x % 7; };
+
+    r.run_vs(h, "is_in_range", lin,
+        [&]{ return accumulate_with(fplus::is_in_range(100, 500), xs); },
+        [&]{ return accumulate_with(
+            [](int x) { return 100 <= x && x < 500; }, xs); });
+    r.run_vs(h, "clamp", lin,
+        [&]{ return accumulate_with(fplus::clamp(100, 500), xs); },
+        [&]{ return accumulate_with(
+            [](int x) { return std::max(100, std::min(500, x)); }, xs); });
+    r.run(h, "is_negative", lin,
+        [&]{ return accumulate_with(fplus::is_negative<double>, ds); });
+    r.run(h, "is_positive", lin,
+        [&]{ return accumulate_with(fplus::is_positive<double>, ds); });
+    r.run(h, "round", lin,
+        [&]{ return accumulate_with(fplus::round<int, double>, ds); });
+    r.run(h, "floor", lin,
+        [&]{ return accumulate_with(fplus::floor<int, double>, ds); });
+    r.run(h, "ceil", lin,
+        [&]{ return accumulate_with(fplus::ceil<int, double>, ds); });
+    r.run(h, "int_power", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::int_power(x % 8, 3); }, xs);
+        });
+    r.run(h, "min_2_by", lin, [&]
+        { return accumulate_adjacent_with(fplus::min_2_by(mod_7), xs); });
+    r.run(h, "max_2_by", lin, [&]
+        { return accumulate_adjacent_with(fplus::max_2_by(mod_7), xs); });
+    r.run(h, "min_2", lin,
+        [&]{ return accumulate_adjacent_with(fplus::min_2<int>, xs); });
+    r.run(h, "min_3", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::min_3(x, 300, 700); }, xs);
+        });
+    r.run(h, "min_4", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::min_4(x, 300, 700, 500); }, xs);
+        });
+    r.run(h, "min_5", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::min_5(x, 300, 700, 500, 9); }, xs);
+        });
+    r.run(h, "max_2", lin,
+        [&]{ return accumulate_adjacent_with(fplus::max_2<int>, xs); });
+    r.run(h, "max_3", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::max_3(x, 300, 700); }, xs);
+        });
+    r.run(h, "max_4", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::max_4(x, 300, 700, 500); }, xs);
+        });
+    r.run(h, "max_5", lin, [&]
+        {
+            return accumulate_with(
+                [](int x) { return fplus::max_5(x, 300, 700, 500, 9); }, xs);
+        });
+}
+
+void bench_compare(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "compare.h";
+    const scaling lin = scaling::linear;
+    auto mod_7 = [](int x) { return x % 7; };
+    auto less = [](int x, int y) { return x < y; };
+    auto less_eq = [](int x, int y) { return x <= y; };
+
+    r.run(h, "identity", lin,
+        [&]{ return accumulate_with(fplus::identity<int>, xs); });
+    r.run_vs(h, "is_equal", lin,
+        [&]{ return accumulate_adjacent_with(fplus::is_equal<int>, xs); },
+        [&]{ return accumulate_adjacent_with(std::equal_to<int>(), xs); });
+    r.run(h, "always", lin,
+        [&]{ return accumulate_with(fplus::always<int>(1), xs); });
+    r.run(h, "is_equal_by_and_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_equal_by_and_by(mod_7, mod_7), xs);
+        });
+    r.run(h, "is_equal_by", lin, [&]
+        { return accumulate_adjacent_with(fplus::is_equal_by(mod_7), xs); });
+    r.run(h, "is_equal_by_to", lin, [&]
+        { return accumulate_with(fplus::is_equal_by_to(mod_7, 3), xs); });
+    r.run_vs(h, "is_equal_to", lin,
+        [&]{ return accumulate_with(fplus::is_equal_to(7), xs); },
+        [&]{ return accumulate_with([](int x) { return x == 7; }, xs); });
+    r.run(h, "is_not_equal", lin, [&]
+        { return accumulate_adjacent_with(fplus::is_not_equal<int>, xs); });
+    r.run(h, "is_not_equal_by_and_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_not_equal_by_and_by(mod_7, mod_7), xs);
+        });
+    r.run(h, "is_not_equal_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_not_equal_by(mod_7), xs);
+        });
+    r.run(h, "is_not_equal_by_to", lin, [&]
+        { return accumulate_with(fplus::is_not_equal_by_to(mod_7, 3), xs); });
+    r.run(h, "is_not_equal_to", lin,
+        [&]{ return accumulate_with(fplus::is_not_equal_to(7), xs); });
+    r.run(h, "is_less", lin,
+        [&]{ return accumulate_adjacent_with(fplus::is_less<int>, xs); });
+    r.run(h, "is_less_by_and_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_less_by_and_by(mod_7, mod_7), xs);
+        });
+    r.run(h, "is_less_by", lin, [&]
+        { return accumulate_adjacent_with(fplus::is_less_by(mod_7), xs); });
+    r.run(h, "is_less_by_than", lin, [&]
+        { return accumulate_with(fplus::is_less_by_than(mod_7, 3), xs); });
+    r.run_vs(h, "is_less_than", lin,
+        [&]{ return accumulate_with(fplus::is_less_than(500), xs); },
+        [&]{ return accumulate_with([](int x) { return x < 500; }, xs); });
+    r.run(h, "is_less_or_equal", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_less_or_equal<int>, xs);
+        });
+    r.run(h, "is_less_or_equal_by_and_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_less_or_equal_by_and_by(mod_7, mod_7), xs);
+        });
+    r.run(h, "is_less_or_equal_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_less_or_equal_by(mod_7), xs);
+        });
+    r.run(h, "is_less_or_equal_by_than", lin, [&]
+        {
+            return accumulate_with(
+                fplus::is_less_or_equal_by_than(mod_7, 3), xs);
+        });
+    r.run(h, "is_less_or_equal_than", lin,
+        [&]{ return accumulate_with(fplus::is_less_or_equal_than(500), xs); });
+    r.run(h, "is_greater", lin,
+        [&]{ return accumulate_adjacent_with(fplus::is_greater<int>, xs); });
+    r.run(h, "is_greater_by_and_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_greater_by_and_by(mod_7, mod_7), xs);
+        });
+    r.run(h, "is_greater_by", lin, [&]
+        { return accumulate_adjacent_with(fplus::is_greater_by(mod_7), xs); });
+    r.run(h, "is_greater_by_than", lin, [&]
+        { return accumulate_with(fplus::is_greater_by_than(mod_7, 3), xs); });
+    r.run_vs(h, "is_greater_than", lin,
+        [&]{ return accumulate_with(fplus::is_greater_than(500), xs); },
+        [&]{ return accumulate_with([](int x) { return x > 500; }, xs); });
+    r.run(h, "is_greater_or_equal", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_greater_or_equal<int>, xs);
+        });
+    r.run(h, "is_greater_or_equal_by_and_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_greater_or_equal_by_and_by(mod_7, mod_7), xs);
+        });
+    r.run(h, "is_greater_or_equal_by", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::is_greater_or_equal_by(mod_7), xs);
+        });
+    r.run(h, "is_greater_or_equal_by_than", lin, [&]
+        {
+            return accumulate_with(
+                fplus::is_greater_or_equal_by_than(mod_7, 3), xs);
+        });
+    r.run(h, "is_greater_or_equal_than", lin, [&]
+        {
+            return accumulate_with(
+                fplus::is_greater_or_equal_than(500), xs);
+        });
+    r.run(h, "xor_bools", lin,
+        [&]{ return accumulate_adjacent_with(fplus::xor_bools<int>, xs); });
+    r.run(h, "ord_to_eq", lin,
+        [&]{ return accumulate_adjacent_with(fplus::ord_to_eq(less), xs); });
+    r.run(h, "ord_to_not_eq", lin, [&]
+        { return accumulate_adjacent_with(fplus::ord_to_not_eq(less), xs); });
+    r.run(h, "ord_eq_to_eq", lin, [&]
+        { return accumulate_adjacent_with(fplus::ord_eq_to_eq(less_eq), xs); });
+    r.run(h, "ord_eq_to_not_eq", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                fplus::ord_eq_to_not_eq(less_eq), xs);
+        });
+}
+
+int add_3(int x, int y, int z) { return x + y + z; }
+
+void bench_composition(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "composition.h";
+    const scaling lin = scaling::linear;
+    typedef std::pair<int, int> Pair;
+    const auto pairs = fplus::zip(xs, xs);
+    auto plus = [](int x, int y) { return x + y; };
+    auto minus = [](int x, int y) { return x - y; };
+    auto inc = [](int x) { return x + 1; };
+    auto times_3 = [](int x) { return x * 3; };
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto is_small = [](int x) { return x < 500; };
+
+    r.run_vs(h, "bind_1st_of_2", lin,
+        [&]{ return accumulate_with(fplus::bind_1st_of_2(plus, 3), xs); },
+        [&]{ return accumulate_with([&](int x) { return plus(3, x); }, xs); });
+    r.run(h, "bind_1st_of_3", lin, [&]
+        {
+            auto f = fplus::bind_1st_of_3(add_3, 3);
+            return accumulate_with([&](int x) { return f(x, x); }, xs);
+        });
+    r.run(h, "bind_1st_and_2nd_of_3", lin, [&]
+        {
+            return accumulate_with(
+                fplus::bind_1st_and_2nd_of_3(add_3, 3, 4), xs);
+        });
+    r.run(h, "flip", lin,
+        [&]{ return accumulate_adjacent_with(fplus::flip(minus), xs); });
+    r.run(h, "apply_to_pair", lin,
+        [&]{ return accumulate_with(fplus::apply_to_pair(plus), pairs); });
+    r.run_vs(h, "compose", lin,
+        [&]{ return accumulate_with(fplus::compose(inc, times_3), xs); },
+        [&]{ return accumulate_with(
+            [&](int x) { return times_3(inc(x)); }, xs); });
+    r.run_vs(h, "compose_5", lin,
+        [&]
+        {
+            return accumulate_with(fplus::compose(
+                inc, times_3, inc, times_3, inc), xs);
+        },
+        [&]
+        {
+            return accumulate_with([&](int x)
+                { return inc(times_3(inc(times_3(inc(x))))); }, xs);
+        });
+    r.run(h, "forward_apply", lin, [&]
+        {
+            return accumulate_with(
+                [&](int x) { return fplus::forward_apply(x, inc); }, xs);
+        });
+    r.run_vs(h, "logical_not", lin,
+        [&]{ return accumulate_with(fplus::logical_not(is_even), xs); },
+        [&]{ return accumulate_with(
+            [&](int x) { return !is_even(x); }, xs); });
+    r.run(h, "logical_or", lin, [&]
+        { return accumulate_with(fplus::logical_or(is_even, is_small), xs); });
+    r.run(h, "logical_and", lin, [&]
+        { return accumulate_with(fplus::logical_and(is_even, is_small), xs); });
+    r.run(h, "logical_xor", lin, [&]
+        { return accumulate_with(fplus::logical_xor(is_even, is_small), xs); });
+    do_not_optimize(Pair());
+}
+
+void bench_maybe(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "maybe.h";
+    const scaling lin = scaling::linear;
+    typedef fplus::maybe<int> Maybe;
+    auto to_maybe = [](int x)
+        { return x % 2 == 0 ? fplus::just(x) : fplus::nothing<int>(); };
+    const std::vector<Maybe> maybes = fplus::transform(to_maybe, xs);
+    const std::vector<Maybe> justs = fplus::transform(fplus::just<int>, xs);
+    auto half_if_even = [](int x)
+        { return x % 2 == 0 ? fplus::just(x / 2) : fplus::nothing<int>(); };
+    auto times_3 = [](int x) { return x * 3; };
+
+    r.run(h, "just", lin, [&]{ return fplus::transform(fplus::just<int>, xs); });
+    r.run(h, "nothing", lin,
+        [&]{ return accumulate_with([](int) {
+            return fplus::is_nothing(fplus::nothing<int>()); }, xs); });
+    r.run(h, "is_just", lin,
+        [&]{ return accumulate_with(fplus::is_just<int>, maybes); });
+    r.run(h, "is_nothing", lin,
+        [&]{ return accumulate_with(fplus::is_nothing<int>, maybes); });
+    r.run(h, "unsafe_get_just", lin,
+        [&]{ return accumulate_with(fplus::unsafe_get_just<int>, justs); });
+    r.run(h, "just_with_default", lin, [&]
+        {
+            return accumulate_with([](const Maybe& m)
+                { return fplus::just_with_default(0, m); }, maybes);
+        });
+    r.run(h, "throw_on_nothing", lin, [&]
+        {
+            return accumulate_with([](const Maybe& m)
+                {
+                    return fplus::throw_on_nothing(
+                        std::invalid_argument("nothing"), m);
+                }, justs);
+        });
+    r.run(h, "operator==", lin, [&]
+        { return accumulate_adjacent_with(std::equal_to<Maybe>(), maybes); });
+    r.run(h, "operator!=", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                std::not_equal_to<Maybe>(), maybes);
+        });
+    r.run(h, "lift_maybe", lin,
+        [&]{ return fplus::transform(fplus::lift_maybe(times_3), maybes); });
+    r.run(h, "and_then_maybe", lin, [&]
+        {
+            return fplus::transform(
+                fplus::and_then_maybe(half_if_even, half_if_even), xs);
+        });
+}
+
+void bench_result(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "result.h";
+    const scaling lin = scaling::linear;
+    typedef fplus::result<int, std::string> Result;
+    auto to_result = [](int x)
+    {
+        return x % 2 == 0 ? fplus::ok<int, std::string>(x)
+            : fplus::error<int, std::string>("odd");
+    };
+    const std::vector<Result> results = fplus::transform(to_result, xs);
+    const std::vector<Result> oks = fplus::transform(
+        fplus::ok<int, std::string>, xs);
+    const std::vector<Result> errors = fplus::keep_if(
+        fplus::is_error<int, std::string>, results);
+    const std::vector<fplus::maybe<int>> maybes = fplus::transform(
+        fplus::just<int>, xs);
+    auto half_if_even = [](int x)
+    {
+        return x % 2 == 0 ? fplus::ok<int, std::string>(x / 2)
+            : fplus::error<int, std::string>("odd");
+    };
+    auto times_3 = [](int x) { return x * 3; };
+
+    r.run(h, "ok", lin,
+        [&]{ return fplus::transform(fplus::ok<int, std::string>, xs); });
+    r.run(h, "error", lin, [&]
+        {
+            return fplus::transform([](int)
+                { return fplus::error<int, std::string>("fail"); }, xs);
+        });
+    r.run(h, "is_ok", lin,
+        [&]{ return accumulate_with(fplus::is_ok<int, std::string>, results); });
+    r.run(h, "is_error", lin, [&]
+        { return accumulate_with(fplus::is_error<int, std::string>, results); });
+    r.run(h, "unsafe_get_ok", lin, [&]
+        { return accumulate_with(fplus::unsafe_get_ok<int, std::string>, oks); });
+    r.run(h, "unsafe_get_error", lin, [&]
+        {
+            return accumulate_with([](const Result& x)
+                { return fplus::unsafe_get_error(x).size(); }, errors);
+        });
+    r.run(h, "ok_with_default", lin, [&]
+        {
+            return accumulate_with([](const Result& x)
+                { return fplus::ok_with_default(0, x); }, results);
+        });
+    r.run(h, "to_maybe", lin, [&]
+        { return fplus::transform(fplus::to_maybe<int, std::string>, results); });
+    r.run(h, "from_maybe", lin, [&]
+        {
+            return fplus::transform([](const fplus::maybe<int>& m)
+                {
+                    return fplus::from_maybe<int, std::string>(m, "nothing");
+                }, maybes);
+        });
+    r.run(h, "throw_on_error", lin, [&]
+        {
+            return accumulate_with([](const Result& x)
+                {
+                    return fplus::throw_on_error(
+                        std::invalid_argument("error"), x);
+                }, oks);
+        });
+    r.run(h, "throw_type_on_error", lin, [&]
+        {
+            return accumulate_with([](const Result& x)
+                {
+                    return fplus::throw_type_on_error<std::invalid_argument>(
+                        x);
+                }, oks);
+        });
+    r.run(h, "operator==", lin, [&]
+        { return accumulate_adjacent_with(std::equal_to<Result>(), results); });
+    r.run(h, "operator!=", lin, [&]
+        {
+            return accumulate_adjacent_with(
+                std::not_equal_to<Result>(), results);
+        });
+    r.run(h, "lift_result", lin, [&]
+        {
+            return fplus::transform(
+                fplus::lift_result<std::string>(times_3), results);
+        });
+    r.run(h, "and_then_result", lin, [&]
+        {
+            return fplus::transform(
+                fplus::and_then_result(half_if_even, half_if_even), xs);
+        });
+}
+
+void bench_maps(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "maps.h";
+    const scaling lin = scaling::linear;
+    typedef std::map<int, int> IntMap;
+    std::vector<int> keys = fplus::generate_range<std::vector<int>>(
+        0, static_cast<int>(xs.size()));
+    std::shuffle(std::begin(keys), std::end(keys), std::mt19937(42));
+    const auto pairs = fplus::zip(keys, xs);
+    const auto grouping_pairs = fplus::zip(xs, keys);
+    const IntMap map = fplus::pairs_to_map<IntMap>(pairs);
+    auto times_3 = [](int x) { return x * 3; };
+
+    r.run(h, "pairs_to_map", lin,
+        [&]{ return fplus::pairs_to_map<IntMap>(pairs); });
+    r.run(h, "pairs_to_map_grouped", lin,
+        [&]{ return fplus::pairs_to_map_grouped(grouping_pairs); });
+    r.run(h, "map_to_pairs", lin, [&]{ return fplus::map_to_pairs(map); });
+    r.run(h, "get_map_keys", lin, [&]{ return fplus::get_map_keys(map); });
+    r.run(h, "get_map_values", lin,
+        [&]{ return fplus::get_map_values(map); });
+    r.run(h, "swap_keys_and_values", lin,
+        [&]{ return fplus::swap_keys_and_values(map); });
+    r.run(h, "create_map", lin, [&]{ return fplus::create_map(keys, xs); });
+    r.run(h, "create_unordered_map", lin,
+        [&]{ return fplus::create_unordered_map(keys, xs); });
+    r.run_vs(h, "get_from_map", lin,
+        [&]
+        {
+            return accumulate_with([&](int k)
+                { return fplus::is_just(fplus::get_from_map(map, k)); }, xs);
+        },
+        [&]
+        {
+            return accumulate_with([&](int k)
+                { return map.find(k) != std::end(map); }, xs);
+        });
+    r.run(h, "get_from_map_with_def", lin, [&]
+        {
+            return accumulate_with([&](int k)
+                { return fplus::get_from_map_with_def(map, 0, k); }, xs);
+        });
+    r.run(h, "map_contains", lin, [&]
+        {
+            return accumulate_with([&](int k)
+                { return fplus::map_contains(map, k); }, xs);
+        });
+    r.run(h, "transform_map_values", lin,
+        [&]{ return fplus::transform_map_values(times_3, map); });
+}
+
+void bench_read(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "read.h";
+    const scaling lin = scaling::linear;
+    const std::vector<std::string> ints = fplus::transform(
+        [](int x) { return std::to_string(x - 500); }, xs);
+    const std::vector<std::string> floats = fplus::transform(
+        [](int x) { return std::to_string((x - 500) * 0.37); }, xs);
+    const std::vector<std::string> garbage = fplus::transform(
+        [](int x) { return std::to_string(x) + "x"; }, xs);
+    auto read_int = [](const std::string& str)
+        { return fplus::is_just(fplus::read_value<int>(str)); };
+
+    r.run_vs(h, "read_value<int>", lin,
+        [&]{ return accumulate_with(read_int, ints); },
+        [&]{ return accumulate_with([](const std::string& str)
+            { return std::atoi(str.c_str()); }, ints); });
+    r.run(h, "read_value<long long>", lin, [&]
+        {
+            return accumulate_with([](const std::string& str)
+                { return fplus::is_just(fplus::read_value<long long>(str)); },
+                ints);
+        });
+    r.run(h, "read_value<unsigned long>", lin, [&]
+        {
+            return accumulate_with([](const std::string& str)
+                {
+                    return fplus::is_just(
+                        fplus::read_value<unsigned long>(str));
+                }, ints);
+        });
+    r.run(h, "read_value<float>", lin, [&]
+        {
+            return accumulate_with([](const std::string& str)
+                { return fplus::is_just(fplus::read_value<float>(str)); },
+                floats);
+        });
+    r.run_vs(h, "read_value<double>", lin,
+        [&]
+        {
+            return accumulate_with([](const std::string& str)
+                { return fplus::is_just(fplus::read_value<double>(str)); },
+                floats);
+        },
+        [&]{ return accumulate_with([](const std::string& str)
+            { return std::atof(str.c_str()); }, floats); });
+    r.run(h, "read_value_result<int>", lin, [&]
+        {
+            return accumulate_with([](const std::string& str)
+                { return fplus::is_ok(fplus::read_value_result<int>(str)); },
+                ints);
+        });
+    r.run(h, "read_value_result<int>_bad_data", lin, [&]
+        {
+            return accumulate_with([](const std::string& str)
+                { return fplus::is_ok(fplus::read_value_result<int>(str)); },
+                garbage);
+        });
+    r.run(h, "read_value<int>_bad_data", lin,
+        [&]{ return accumulate_with(read_int, garbage); });
+    r.run(h, "read_values<int>", lin,
+        [&]{ return fplus::read_values<int>(ints); });
+    r.run(h, "read_values<double>", lin,
+        [&]{ return fplus::read_values<double>(floats); });
+}
+
+void bench_show_values(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "show.h";
+    const scaling lin = scaling::linear;
+    const auto pairs = fplus::zip(xs, xs);
+    const auto maybes = fplus::transform(fplus::just<int>, xs);
+    const auto results = fplus::transform(fplus::ok<int, std::string>, xs);
+
+    r.run_vs(h, "show", lin,
+        [&]{ return fplus::transform(fplus::show<int>, xs); },
+        [&]
+        {
+            return fplus::transform(
+                [](int x) { return std::to_string(x); }, xs);
+        });
+    r.run(h, "show_pair", lin, [&]
+        {
+            return fplus::transform(
+                [](const std::pair<int, int>& p) { return fplus::show(p); },
+                pairs);
+        });
+    r.run(h, "show_maybe", lin,
+        [&]{ return fplus::transform(fplus::show_maybe<int>, maybes); });
+    r.run(h, "show_result", lin, [&]
+        {
+            return fplus::transform(
+                fplus::show_result<int, std::string>, results);
+        });
+    r.run_vs(h, "show_cont", lin,
+        [&]{ return fplus::show_cont(xs); },
+        [&]
+        {
+            std::ostringstream ss;
+            ss << "[";
+            for (std::size_t i = 0; i < xs.size(); ++i)
+                ss << (i == 0 ? "" : ", ") << xs[i];
+            ss << "]";
+            return ss.str();
+        });
+    const auto doubles = fplus::transform(
+        [](int x) { return static_cast<double>(x) / 7.0; }, xs);
+    r.run_vs(h, "show_double", lin,
+        [&]{ return fplus::transform(fplus::show<double>, doubles); },
+        [&]
+        {
+            return fplus::transform([](double x)
+                {
+                    std::ostringstream ss;
+                    ss << x;
+                    return ss.str();
+                }, doubles);
+        });
+    r.run(h, "show_round_trip", lin, [&]
+        {
+            return fplus::transform(fplus::show_round_trip<double>, doubles);
+        });
+}
+
+void bench_filter_values(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "filter.h";
+    const scaling lin = scaling::linear;
+    const auto maybes = fplus::transform([](int x)
+        { return x % 2 == 0 ? fplus::just(x) : fplus::nothing<int>(); }, xs);
+    const auto results = fplus::transform([](int x)
+        {
+            return x % 2 == 0 ? fplus::ok<int, std::string>(x)
+                : fplus::error<int, std::string>("odd");
+        }, xs);
+    r.run(h, "justs", lin, [&]{ return fplus::justs(maybes); });
+    r.run(h, "oks", lin, [&]{ return fplus::oks(results); });
+}
+
+void bench_transform_values(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "transform.h";
+    auto even_to_just = [](int x)
+        { return x % 2 == 0 ? fplus::just(x) : fplus::nothing<int>(); };
+    auto even_to_ok = [](int x)
+    {
+        return x % 2 == 0 ? fplus::ok<int, std::string>(x)
+            : fplus::error<int, std::string>("odd");
+    };
+    r.run(h, "transform_and_keep_justs", scaling::linear,
+        [&]{ return fplus::transform_and_keep_justs(even_to_just, xs); });
+    r.run(h, "transform_and_keep_oks", scaling::linear,
+        [&]{ return fplus::transform_and_keep_oks(even_to_ok, xs); });
+    std::size_t side = 1;
+    while ((side + 1) * (side + 1) <= xs.size())
+        ++side;
+    std::vector<std::vector<int>> grid;
+    for (std::size_t y = 0; y < side; ++y)
+        grid.push_back(fplus::get_range(y * side, (y + 1) * side, xs));
+    r.run(h, "transpose", scaling::linear,
+        [&]{ return fplus::transpose(grid); });
+}
+
+// Sensor-like data, where 95% of the values repeat their predecessor.
+void bench_rle_vector(runner& r, const std::vector<int>& xs)
+{
+    const std::string h = "rle_vector.h";
+    const scaling lin = scaling::linear;
+    std::vector<int> ys;
+    ys.reserve(xs.size());
+    for (std::size_t i = 0; i < xs.size(); ++i)
+        ys.push_back(ys.empty() || xs[i] % 20 == 0 ? xs[i] % 100 : ys.back());
+    const auto runs = fplus::run_length_encode(ys);
+    const auto rle = fplus::rle_vector<int>(runs);
+    auto is_odd = [](int x) { return x % 2 != 0; };
+    auto times_3 = [](int x) { return 3 * x; };
+    r.run_vs(h, "run_length_decode", lin,
+        [&]{ return fplus::run_length_decode(runs); },
+        [&]
+        {
+            return fplus::concat(fplus::transform(
+                fplus::apply_to_pair(fplus::replicate<int>), runs));
+        });
+    r.run(h, "to_rle_vector", lin, [&]{ return fplus::to_rle_vector(ys); });
+    r.run_vs(h, "elem_at_idx", lin,
+        [&]
+        {
+            long long acc = 0;
+            for (std::size_t i = 0; i < ys.size(); i += 97)
+                acc += fplus::elem_at_idx(i, rle);
+            return acc;
+        },
+        [&]
+        {
+            long long acc = 0;
+            for (std::size_t i = 0; i < ys.size(); i += 97)
+                acc += fplus::elem_at_idx(i, ys);
+            return acc;
+        });
+    r.run_vs(h, "sum", lin,
+        [&]{ return fplus::sum(rle); },
+        [&]{ return fplus::sum(ys); });
+    r.run_vs(h, "count", lin,
+        [&]{ return fplus::count(7, rle); },
+        [&]{ return fplus::count(7, ys); });
+    r.run_vs(h, "find_first_idx", lin,
+        [&]{ return fplus::find_first_idx(-1, rle); },
+        [&]{ return fplus::find_first_idx(-1, ys); });
+    r.run_vs(h, "transform", lin,
+        [&]{ return fplus::transform(times_3, rle); },
+        [&]{ return fplus::transform(times_3, ys); });
+    r.run_vs(h, "keep_if", lin,
+        [&]{ return fplus::keep_if(is_odd, rle); },
+        [&]{ return fplus::keep_if(is_odd, ys); });
+    r.run_vs(h, "iterate", lin,
+        [&]{ return std::accumulate(std::begin(rle), std::end(rle), 0ll); },
+        [&]{ return std::accumulate(std::begin(ys), std::end(ys), 0ll); });
+}
+
+// Functions only meaningful for strings.
+void bench_file(runner& r, const std::string& text)
+{
+    const std::string h = "file.h";
+    const scaling lin = scaling::linear;
+    const std::string path = "fplus_benchmark_input.txt";
+    const std::string out_path = "fplus_benchmark_output.txt";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+    }
+    r.run_vs(h, "read_file_mapped", lin,
+        [&]
+        {
+            const auto file = fplus::read_file_mapped(path);
+            return fplus::count('\n', file.unsafe_get_ok());
+        },
+        [&]
+        {
+            std::ifstream file(path, std::ios::binary);
+            const std::string contents(
+                (std::istreambuf_iterator<char>(file)),
+                std::istreambuf_iterator<char>());
+            return fplus::count('\n', contents);
+        });
+    auto is_long = [](const std::string& line) { return line.size() > 40; };
+    r.run_vs(h, "read_split_filter_write", lin,
+        [&]
+        {
+            return fplus::write_lines(out_path, fplus::lazy::keep_if(is_long,
+                fplus::lazy::split_lines(
+                    fplus::read_file_mapped(path).unsafe_get_ok(), false)))
+                .unsafe_get_ok();
+        },
+        [&]
+        {
+            std::ifstream in(path, std::ios::binary);
+            std::ofstream out(out_path, std::ios::binary);
+            std::size_t count = 0;
+            std::string line;
+            while (std::getline(in, line))
+            {
+                if (!line.empty() && line.back() == '\r')
+                    line.pop_back();
+                if (is_long(line))
+                {
+                    out << line << '\n';
+                    ++count;
+                }
+            }
+            return count;
+        });
+    std::remove(path.c_str());
+    std::remove(out_path.c_str());
+
+    std::string csv;
+    for (std::size_t i = 0; i < text.size() / 16; ++i)
+        csv += std::to_string(i) + "," + std::to_string(i * 0.25) +
+            ",name" + std::to_string(i % 100) + "\n";
+    r.run_vs("csv.h", "read_csv_columns", lin,
+        [&]
+        {
+            return std::get<0>(fplus::read_csv_columns<int, double,
+                std::string>(',', false, csv)).values.size();
+        },
+        [&]
+        {
+            std::vector<int> ints;
+            std::vector<double> doubles;
+            std::vector<std::string> names;
+            for (const auto& line : fplus::split_lines(csv, false))
+            {
+                const auto fields = fplus::split_words_by(line, ',', true);
+                ints.push_back(fplus::just_with_default(0,
+                    fplus::read_value<int>(fields[0])));
+                doubles.push_back(fplus::just_with_default(0.0,
+                    fplus::read_value<double>(fields[1])));
+                names.push_back(fields[2]);
+            }
+            return ints.size();
+        });
+}
+
+void bench_string_tools(runner& r, const std::string& text)
+{
+    const std::string h = "string_tools.h";
+    const scaling lin = scaling::linear;
+    const std::string padded = std::string(100, ' ') + text
+        + std::string(100, '\t');
+    const std::vector<int> numbers =
+        fplus::convert_container_and_elems<std::vector<int>>(text);
+
+    r.run(h, "is_letter_or_digit", lin, [&]
+        {
+            return accumulate_with(
+                fplus::is_letter_or_digit<std::string>, text);
+        });
+    r.run(h, "is_whitespace", lin,
+        [&]{ return accumulate_with(fplus::is_whitespace<std::string>, text); });
+    r.run(h, "is_line_break", lin,
+        [&]{ return accumulate_with(fplus::is_line_break<std::string>, text); });
+    r.run(h, "clean_newlines", lin,
+        [&]{ return fplus::clean_newlines(text); });
+    r.run(h, "split_words", lin,
+        [&]{ return fplus::split_words(text, false); });
+    r.run_vs("lazy.h", "is_elem_of_split_words", lin,
+        [&]
+        {
+            return fplus::lazy::is_elem_of(std::string("I"),
+                fplus::lazy::split_words(text, false));
+        },
+        [&]
+        {
+            return fplus::is_elem_of(std::string("I"),
+                fplus::split_words(text, false));
+        });
+    r.run_vs(h, "split_words_spans", lin,
+        [&]{ return fplus::split_words_spans(text, false); },
+        [&]{ return fplus::split_words(text, false); });
+    r.run(h, "split_words_by", lin,
+        [&]{ return fplus::split_words_by(text, ' ', false); });
+    r.run_vs(h, "split_words_by_spans", lin,
+        [&]{ return fplus::split_words_by_spans(text, ' ', false); },
+        [&]{ return fplus::split_words_by(text, ' ', false); });
+    r.run(h, "split_words_by_many", lin, [&]
+        {
+            return fplus::split_words_by_many(text, std::string(" ,.\n"),
+                false);
+        });
+    r.run_vs(h, "split_words_by_many_spans", lin,
+        [&]
+        {
+            return fplus::split_words_by_many_spans(text,
+                std::string(" ,.\n"), false);
+        },
+        [&]
+        {
+            return fplus::split_words_by_many(text, std::string(" ,.\n"),
+                false);
+        });
+    r.run_vs(h, "line_splitter", lin,
+        [&]
+        {
+            fplus::line_splitter<std::string> splitter(true);
+            std::size_t count = 0;
+            auto count_line = [&](const std::string&) { ++count; };
+            const std::size_t chunk_size = 65536;
+            for (std::size_t pos = 0; pos < text.size(); pos += chunk_size)
+                splitter.feed(text.substr(pos, chunk_size), count_line);
+            splitter.finish(count_line);
+            return count;
+        },
+        [&]{ return fplus::split_lines(text, true).size(); });
+    r.run_vs(h, "split_lines_spans", lin,
+        [&]{ return fplus::split_lines_spans(text, true); },
+        [&]{ return fplus::split_lines(text, true); });
+    r.run_vs("split.h", "split_by_token_spans", lin,
+        [&]{ return fplus::split_by_token_spans(std::string(", "), true, text); },
+        [&]{ return fplus::split_by_token(std::string(", "), true, text); });
+    r.run_vs(h, "split_lines", lin,
+        [&]{ return fplus::split_lines(text, true); },
+        [&]
+        {
+            std::vector<std::string> result;
+            std::istringstream stream(text);
+            std::string line;
+            while (std::getline(stream, line))
+                result.push_back(line);
+            return result;
+        });
+    r.run(h, "trim_whitespace_left", lin,
+        [&]{ return fplus::trim_whitespace_left(padded); });
+    r.run(h, "trim_whitespace_right", lin,
+        [&]{ return fplus::trim_whitespace_right(padded); });
+    r.run(h, "trim_whitespace", lin,
+        [&]{ return fplus::trim_whitespace(padded); });
+    r.run(h, "to_string_fill_left", lin, [&]
+        {
+            return fplus::transform([](int x)
+                { return fplus::to_string_fill_left('0', 8, x); }, numbers);
+        });
+    r.run(h, "to_string_fill_right", lin, [&]
+        {
+            return fplus::transform([](int x)
+                { return fplus::to_string_fill_right(' ', 8, x); }, numbers);
+        });
+}
+
+// Suites combining the benchmarks that are applicable
+// to a particular kind of container.
+
+template <typename Container>
+void run_generic_suite(runner& r, const Container& xs)
+{
+    bench_container_common(r, xs);
+    bench_filter(r, xs);
+    bench_generate(r, xs);
+    bench_container_properties(r, xs);
+    bench_search(r, xs);
+    bench_replace(r, xs);
+    bench_split(r, xs);
+    bench_transform(r, xs);
+    bench_show(r, xs);
+    bench_lazy(r, xs);
+}
+
+template <typename Container>
+void run_random_access_suite(runner&, const Container&, std::false_type)
+{
+}
+
+template <typename Container>
+void run_random_access_suite(runner& r, const Container& xs, std::true_type)
+{
+    bench_container_common_random_access(r, xs);
+    bench_transform_random_access(r, xs);
+    bench_par(r, xs);
+}
+
+template <typename Container>
+void run_numbers_suite(runner& r, const Container& xs)
+{
+    bench_container_common_numbers(r, xs);
+    bench_transform_numbers(r, xs);
+    bench_pairs(r, xs);
+}
+
+void run_values_suite(runner& r, const std::vector<int>& xs)
+{
+    bench_numeric(r, xs);
+    bench_compare(r, xs);
+    bench_composition(r, xs);
+    bench_maybe(r, xs);
+    bench_result(r, xs);
+    bench_maps(r, xs);
+    bench_read(r, xs);
+    bench_show_values(r, xs);
+    bench_filter_values(r, xs);
+    bench_transform_values(r, xs);
+    bench_rle_vector(r, xs);
+}
+
+std::vector<std::size_t> sizes(const config& cfg)
+{
+    std::vector<std::size_t> result;
+    for (std::size_t n = 100; n <= 10000000; n *= 10)
+        if (n >= cfg.min_size && n <= cfg.max_size)
+            result.push_back(n);
+    return result;
+}
+
+bool container_selected(const config& cfg, const std::string& name)
+{
+    return fplus::is_elem_of(name, cfg.containers);
+}
+
+void run_all(runner& r, const config& cfg)
+{
+    for (std::size_t n : sizes(cfg))
+    {
+        if (container_selected(cfg, "vector"))
+        {
+            typedef std::vector<int> Ints;
+            const auto xs = make_input<Ints>(n);
+            r.set_input("std::vector<int>", n);
+            run_generic_suite(r, xs);
+            run_random_access_suite(r, xs, is_random_access<Ints>());
+            run_numbers_suite(r, xs);
+            run_values_suite(r, xs);
+        }
+        if (container_selected(cfg, "list"))
+        {
+            typedef std::list<int> Ints;
+            const auto xs = make_input<Ints>(n);
+            r.set_input("std::list<int>", n);
+            run_generic_suite(r, xs);
+            run_random_access_suite(r, xs, is_random_access<Ints>());
+            run_numbers_suite(r, xs);
+        }
+        if (container_selected(cfg, "deque"))
+        {
+            typedef std::deque<int> Ints;
+            const auto xs = make_input<Ints>(n);
+            r.set_input("std::deque<int>", n);
+            run_generic_suite(r, xs);
+            run_random_access_suite(r, xs, is_random_access<Ints>());
+            run_numbers_suite(r, xs);
+        }
+        if (container_selected(cfg, "string"))
+        {
+            const auto text = make_input<std::string>(n);
+            r.set_input("std::string", n);
+            run_generic_suite(r, text);
+            run_random_access_suite(r, text,
+                is_random_access<std::string>());
+            bench_string_tools(r, text);
+            bench_file(r, text);
+        }
+    }
+}
+
+config parse_args(int argc, char* argv[])
+{
+    config cfg;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string key = argv[i];
+        const std::string value = argv[i + 1];
+        if (key == "--min-size")
+            cfg.min_size = std::stoul(value);
+        else if (key == "--max-size")
+            cfg.max_size = std::stoul(value);
+        else if (key == "--filter")
+            cfg.filter = value;
+        else if (key == "--containers")
+            cfg.containers = fplus::split_words_by(value, ',', false);
+        else if (key == "--min-reps")
+            cfg.min_reps = std::stoul(value);
+        else if (key == "--min-time")
+            cfg.min_time = std::stod(value);
+        else if (key == "--json")
+            cfg.json_path = value;
+        else
+            std::cerr << "Unknown option: " << key << std::endl;
+    }
+    std::vector<std::size_t> selected_sizes = sizes(cfg);
+    if (!selected_sizes.empty())
+        cfg.min_size = selected_sizes.front();
+    return cfg;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    const config cfg = parse_args(argc, argv);
+    runner r(cfg);
+    run_all(r, cfg);
+    std::ofstream json_file(cfg.json_path);
+    write_json(json_file, r.results());
+    std::cout << r.results().size() << " benchmarks written to "
+        << cfg.json_path << std::endl;
+}
@@ -0,0 +1,174 @@
+// Copyright Tobias Hermann 2015.
+// https://github.com/Dobiasd/FunctionalPlus
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at
+//  http://www.boost.org/LICENSE_1_0.txt)
+
+// Heap allocation accounting for the tests and the benchmark.
+//
+// Including this header replaces the global operator new and delete
+// of the program with versions that count the calls and the bytes
+// requested, so it must be included in exactly one translation unit.
+// The library itself is not affected.
+//
+// alloc_count::scope s;
+// auto ys = fplus::keep_if(is_odd, xs);
+// s.get().allocations == 1
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace alloc_count
+{
+
+struct stats
+{
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytes;
+};
+
+namespace
+{
+    std::atomic<std::size_t> allocations_counter(0);
+    std::atomic<std::size_t> deallocations_counter(0);
+    std::atomic<std::size_t> bytes_counter(0);
+} // anonymous namespace
+
+// Counts since program start.
+inline stats total()
+{
+    return {
+        allocations_counter.load(std::memory_order_relaxed),
+        deallocations_counter.load(std::memory_order_relaxed),
+        bytes_counter.load(std::memory_order_relaxed)};
+}
+
+// Counts the allocations happening during its lifetime.
+class scope
+{
+public:
+    scope() : start_(total()) {}
+    stats get() const
+    {
+        const stats now = total();
+        return {
+            now.allocations - start_.allocations,
+            now.deallocations - start_.deallocations,
+            now.bytes - start_.bytes};
+    }
+    std::size_t allocations() const { return get().allocations; }
+    std::size_t bytes() const { return get().bytes; }
+private:
+    stats start_;
+};
+
+// Calls f once and returns the allocations it made,
+// including the ones of its result.
+template <typename F>
+stats measure(F f)
+{
+    scope s;
+    {
+        auto result = f();
+        static_cast<void>(result);
+    }
+    return s.get();
+}
+
+inline void* allocate(std::size_t size)
+{
+    allocations_counter.fetch_add(1, std::memory_order_relaxed);
+    bytes_counter.fetch_add(size, std::memory_order_relaxed);
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+// After inlining the replaced operators GCC sees memory
+// obtained from operator new being released with std::free.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+inline void deallocate(void* ptr)
+{
+    if (!ptr)
+        return;
+    deallocations_counter.fetch_add(1, std::memory_order_relaxed);
+    std::free(ptr);
+}
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace alloc_count
+
+void* operator new(std::size_t size)
+{
+    return alloc_count::allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return alloc_count::allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return alloc_count::allocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try
+    {
+        return alloc_count::allocate(size);
+    }
+    catch (const std::bad_alloc&)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    alloc_count::deallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    alloc_count::deallocate(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    alloc_count::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    alloc_count::deallocate(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+    alloc_count::deallocate(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+    alloc_count::deallocate(ptr);
+}
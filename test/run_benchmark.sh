@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+
+g++ -std=c++11 -O3 -DNDEBUG -Wall -Wextra -pedantic -Werror -pthread -o ./temp_FunctionalPlus_benchmark__gcc -I./../include benchmark.cpp
+
+if [ -f ./temp_FunctionalPlus_benchmark__gcc ];
+then
+    ./temp_FunctionalPlus_benchmark__gcc "$@"
+    rm ./temp_FunctionalPlus_benchmark__gcc
+fi
@@ -5,16 +5,31 @@
 //  http://www.boost.org/LICENSE_1_0.txt)
 
 #include "fplus.h"
+#include "count_allocations.h"
 
 #include <cassert>
-#include <chrono>
-#include <ctime>
+#include <cerrno>
+#include <clocale>
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <deque>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 void Test_Numeric()
@@ -73,6 +88,16 @@ void Test_Numeric()
     assert(min_2_by(str_length)(str1, str2) == "hi");
 }
 
+// n values drawn uniformly from [-range, range].
+std::vector<int> random_ints(std::mt19937& gen, int range, std::size_t n)
+{
+    std::uniform_int_distribution<int> dis(-range, range);
+    std::vector<int> result;
+    for (std::size_t i = 0; i < n; ++i)
+        result.push_back(dis(gen));
+    return result;
+}
+
 int APlusTwoTimesBFunc(int a, int b) { return a + 2 * b; }
 
 std::string CcI2SFree(const std::string& str, int x)
@@ -131,6 +156,12 @@ void Test_Composition()
     assert((compose(square, square, square)(2)) == 256);
     assert((compose(square, square, square, square)(2)) == 65536);
     assert((compose(square, square, square, square, square)(1)) == 1);
+    assert((compose(square, square, square, square, square, square)(1)) == 1);
+    auto squareTwice = compose(square, square);
+    static_assert(utils::function_traits<decltype(squareTwice)>::arity == 1,
+        "Composed functions must work with function_traits.");
+    std::function<int(int)> squareTwiceFunction = squareTwice;
+    assert(squareTwiceFunction(3) == 81);
 
     auto add3 = [](int x, int y, int z) { return x + y + z; };
     assert(bind_1st_and_2nd_of_3(add3, 3, 5)(7) == 15);
@@ -317,8 +348,47 @@ void Test_Maybe()
         thrown_str = e.what();
     }
     assert(thrown_str == "raised");
+
+    static_assert(std::is_trivially_copyable<maybe<int>>::value,
+        "maybe of a trivially copyable type must be trivially copyable.");
+    static_assert(
+        std::is_nothrow_move_constructible<maybe<std::string>>::value &&
+        std::is_nothrow_move_assignable<maybe<std::string>>::value,
+        "Vectors of maybes must move them when growing.");
+    auto maybeStr = just<std::string>("a string too long for inline storage");
+    auto maybeStrCopy = maybeStr;
+    auto maybeStrMoved = std::move(maybeStrCopy);
+    assert(maybeStrMoved == maybeStr);
+    maybe<std::string> maybeStrAssigned = nothing<std::string>();
+    maybeStrAssigned = maybeStr;
+    assert(maybeStrAssigned == maybeStr);
+    maybeStrAssigned = nothing<std::string>();
+    assert(is_nothing(maybeStrAssigned));
+    maybeStrAssigned.emplace(3, 'x');
+    assert(maybeStrAssigned == just<std::string>("xxx"));
+    maybeStrAssigned.emplace("y");
+    assert(maybeStrAssigned == just<std::string>("y"));
 }
 
+// Counts its live instances. Copying it throws while throw_on_copy is set.
+// Having no move constructor, it is copied when moved.
+struct ThrowingCopy
+{
+    static int live;
+    static bool throw_on_copy;
+    ThrowingCopy() { ++live; }
+    ThrowingCopy(const ThrowingCopy&)
+    {
+        if (throw_on_copy)
+            throw std::runtime_error("copy");
+        ++live;
+    }
+    ThrowingCopy& operator = (const ThrowingCopy&) = default;
+    ~ThrowingCopy() { --live; }
+};
+int ThrowingCopy::live = 0;
+bool ThrowingCopy::throw_on_copy = false;
+
 void Test_Result()
 {
     using namespace fplus;
@@ -403,6 +473,48 @@ void Test_Result()
     }
     assert(thrown_str == "failed");
     thrown_str.clear();
+
+    typedef result<std::string, std::string> StrResult;
+    static_assert(std::is_nothrow_move_constructible<StrResult>::value &&
+        std::is_nothrow_move_assignable<StrResult>::value,
+        "Vectors of results must move them when growing.");
+    StrResult okStr = ok<std::string, std::string>(std::string(40, 'o'));
+    StrResult errStr = error<std::string, std::string>(std::string(40, 'e'));
+    StrResult assigned = okStr;
+    assert(assigned == okStr);
+    assigned = errStr;
+    assert(assigned == errStr);
+    assigned = std::move(okStr);
+    assert(is_ok(assigned));
+    assert(unsafe_get_ok(assigned) == std::string(40, 'o'));
+    StrResult moved = std::move(errStr);
+    assert(unsafe_get_error(moved) == std::string(40, 'e'));
+    moved = assigned;
+    assert(moved == assigned);
+
+    typedef result<ThrowingCopy, std::string> ThrowingResult;
+    {
+        ThrowingResult okThrowing = ok<ThrowingCopy, std::string>(ThrowingCopy());
+        ThrowingResult errThrowing = error<ThrowingCopy, std::string>("e");
+        ThrowingCopy::throw_on_copy = true;
+        bool thrown = false;
+        try
+        {
+            errThrowing = std::move(okThrowing);
+        }
+        catch (const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(unsafe_get_error(errThrowing) == "e");
+        ThrowingCopy::throw_on_copy = false;
+        errThrowing = std::move(okThrowing);
+        assert(is_ok(errThrowing));
+        okThrowing = error<ThrowingCopy, std::string>("e");
+        assert(ThrowingCopy::live == 1);
+    }
+    assert(ThrowingCopy::live == 0);
 }
 
 
@@ -455,6 +567,16 @@ void Test_Compare()
     assert(ord_to_not_eq(int_less)(1, 2) == true);
     assert(ord_to_not_eq(int_less)(2, 2) == false);
     assert(ord_to_not_eq(int_less)(2, 1) == true);
+
+    // The predicates are plain function objects, not std::function.
+    static_assert(!std::is_same<decltype(is_equal_to(2)),
+        std::function<bool(const int&)>>::value, "Must not be boxed.");
+    static_assert(utils::function_traits<decltype(is_less_than(2))>::arity
+        == 1, "Wrong arity.");
+    static_assert(utils::function_traits<decltype(ord_to_eq(int_less))>::arity
+        == 2, "Wrong arity.");
+    const std::function<bool(int)> is_two = is_equal_to(2);
+    assert(is_two(2) && !is_two(3));
     assert(ord_eq_to_eq(int_less_eq)(1, 2) == false);
     assert(ord_eq_to_eq(int_less_eq)(2, 2) == true);
     assert(ord_eq_to_eq(int_less_eq)(2, 1) == false);
@@ -480,6 +602,25 @@ struct squareStruct
     int operator()(int x) { return x*x; }
 };
 
+template <typename Container>
+void check_count_occurrences(const Container& xs)
+{
+    using namespace fplus;
+    typedef typename Container::value_type T;
+    std::map<T, std::size_t> expected;
+    for (const auto& x : xs)
+        ++expected[x];
+    assert(count_occurrences(xs) == expected);
+    assert(count_occurrences_hash(xs) ==
+        (std::unordered_map<T, std::size_t>(
+            std::begin(expected), std::end(expected))));
+    const auto flat = count_occurrences_flat(xs);
+    assert((std::map<T, std::size_t>(std::begin(flat), std::end(flat))) ==
+        expected);
+    assert(transform(fst<T, std::size_t>, flat) == nub(xs));
+    assert(par::count_occurrences(xs) == expected);
+}
+
 void Test_ContainerTools()
 {
     using namespace fplus;
@@ -513,6 +654,42 @@ void Test_ContainerTools()
     assert(drop_if(is_even, intList) == IntList({ 1,3 }));
     assert(group(xs) == IntVectors({IntVector({1}),IntVector({2,2}),IntVector({3}),IntVector({2})}));
     assert(group_globally(xs) == IntVectors({IntVector({1}),IntVector({2,2,2}),IntVector({3})}));
+    auto abs_int = [](int x) { return std::abs(x); };
+    auto abs_equal = [](int x, int y) { return std::abs(x) == std::abs(y); };
+    auto abs_hash = [](int x) { return std::hash<int>()(std::abs(x)); };
+    const IntVector signedXs = {1,-2,3,2,-1};
+    const IntVectors absGroups = {{1,-1},{-2,2},{3}};
+    assert(group_globally_on(abs_int, signedXs) == absGroups);
+    assert(group_globally_by_hash(abs_hash, abs_equal, signedXs) == absGroups);
+    assert(group_globally_on_ordered(abs_int, signedXs) == absGroups);
+    assert(group_globally_on(abs_int, IntVector()) == IntVectors());
+    assert(group_globally_on_ordered(abs_int, IntVector()) == IntVectors());
+    assert(group_globally_on(abs_int, IntList({2,-1,-2})) ==
+        IntLists({{2,-2},{-1}}));
+    assert(group_globally_on_ordered(abs_int, IntList({2,-1,-2})) ==
+        IntLists({{2,-2},{-1}}));
+    {
+        auto first_char = [](const std::string& str) { return str.front(); };
+        const std::vector<std::string> words = {"b1", "a1", "b2", "c1", "a2"};
+        const std::vector<std::vector<std::string>> wordGroups =
+            {{"b1", "b2"}, {"a1", "a2"}, {"c1"}};
+        assert(group_globally_on(first_char, words) == wordGroups);
+        assert(group_globally_on_ordered(first_char, words) == wordGroups);
+        auto to_upper = [](char c) { return static_cast<char>(c & ~0x20); };
+        assert(group_globally_on(to_upper, std::string("abCAB")) ==
+            std::vector<std::string>({"aA", "bB", "C"}));
+    }
+    {
+        std::mt19937 gen(17);
+        for (int range : {1, 3, 50, 1000})
+        {
+            const IntVector ys = random_ints(gen, range, 500);
+            const auto expected = group_globally_by(abs_equal, ys);
+            assert(group_globally_on(abs_int, ys) == expected);
+            assert(group_globally_by_hash(abs_hash, abs_equal, ys) == expected);
+            assert(group_globally_on_ordered(abs_int, ys) == expected);
+        }
+    }
     assert(trim_left(1, intList) == IntList({2,2,3,2}));
     assert(trim_right(2, intList) == IntList({1,2,2,3}));
     assert(trim(0, IntVector({0,2,4,5,6,7,8,0,0})) == IntVector({2,4,5,6,7,8}));
@@ -521,6 +698,23 @@ void Test_ContainerTools()
     assert(trim_token_right(IntVector({3,2}), xs) == IntVector({1,2,2}));
     assert(trim_token(IntVector({0,1}), IntVector({0,1,7,8,9,0,1})) == IntVector({7,8,9}));
 
+    assert(keep_if(is_even, IntVector(xs)) == IntVector({2,2,2}));
+    assert(drop_if(is_even, IntList(intList)) == IntList({1,3}));
+    assert(transform(squareLambda, IntList(intList)) == IntList({1,4,4,9,4}));
+    assert(reverse(IntVector(xs)) == IntVector({2,3,2,2,1}));
+    assert(sort(IntList(intList)) == intListSorted);
+    assert(sort_by(std::greater<int>(), IntVector(xs)) == IntVector({3,2,2,2,1}));
+    assert(unique(IntList(intList)) == IntList({1,2,3,2}));
+    assert(replace_if(is_even, 0, IntVector(xs)) == IntVector({1,0,0,3,0}));
+    assert(append(IntList(intList), intList) == IntList({1,2,2,3,2,1,2,2,3,2}));
+    assert(trim_left(1, IntList(intList)) == IntList({2,2,3,2}));
+    assert(trim_right(2, IntList(intList)) == IntList({1,2,2,3}));
+    assert(trim_by(is_even, IntVector({0,2,4,5,6,7,8,6,4})) == IntVector({5,6,7}));
+    assert(trim_token_right(IntVector({3,2}), IntVector(xs)) == IntVector({1,2,2}));
+    assert(trim_token(IntVector({0,1}), IntVector({0,1,0,1})) == IntVector());
+    assert(trim_token_left(IntVector(), IntVector(xs)) == xs);
+    assert(trim(' ', std::string("  ab c ")) == "ab c");
+
     typedef std::pair<std::size_t, int> rle_pair_int;
     typedef std::vector<rle_pair_int> rle_list_int;
     IntVector rle_input = {1,2,2,2,2,3,3,2};
@@ -531,8 +725,23 @@ void Test_ContainerTools()
             std::make_pair(1, 2)};
     assert(run_length_encode(rle_input) == rle_result);
     assert(run_length_decode(rle_result) == rle_input);
+    assert(run_length_encode(IntVector()) == rle_list_int());
+    assert(run_length_encode(IntList({1,2,2,2,2,3,3,2})) == rle_result);
+    assert(run_length_encode(std::string("aaab")) ==
+        (std::vector<std::pair<std::size_t, char>>({{3, 'a'}, {1, 'b'}})));
+    // Elements are compared to the first one of their group.
+    auto differ_by_at_most_1 = [](int x, int y) { return std::abs(x - y) <= 1; };
+    assert(run_length_encode_by(differ_by_at_most_1, IntVector({1,2,3,4,1}))
+        == rle_list_int({{2, 1}, {2, 3}, {1, 1}}));
+    assert(run_length_encode_by(differ_by_at_most_1, IntVector({1,2,3,4,1}))
+        == transform([](const IntVector& group)
+            { return std::make_pair(group.size(), group.front()); },
+            group_by(differ_by_at_most_1, IntVector({1,2,3,4,1}))));
 
     assert(without(2, intList) == IntList({ 1,3 }));
+    assert(drop_if_with_idx(
+        [](std::size_t idx, int x) { return idx == 0 || x == 3; },
+        intList) == IntList({ 2,2,2 }));
 
     assert(keep_idxs(IdxVector({1, 3}), xs) == IntVector({2,3}));
     assert(keep_idxs(IdxVector({3, 1}), xs) == IntVector({2,3}));
@@ -690,6 +899,7 @@ void Test_ContainerTools()
     assert(median(IntVector({ 3, 5 })) == 4);
     assert(is_in_range(3.49f, 3.51f)(median<IntVector, float>(IntVector({ 3, 4 }))));
     assert(median(IntVector({ 3, 9, 5 })) == 5);
+    assert(median(IntList({ 3, 9, 5, 1 })) == 4);
     assert(median(xs) == 2);
     assert(sort(reverse(xs)) == xsSorted);
     assert(sort(reverse(intList)) == intListSorted);
@@ -848,6 +1058,56 @@ void Test_ContainerTools()
     assert(nub(xs) == IntVector({ 1,2,3 }));
     auto bothEven = is_equal_by(is_even);
     assert(nub_by(bothEven, xs) == IntVector({ 1,2 }));
+    assert(nub_hash(xs) == IntVector({ 1,2,3 }));
+    assert(nub_hash(IntList({ 3,1,3 })) == IntList({ 3,1 }));
+    assert(nub_hash(std::string("mississippi")) == "misp");
+    auto mod3 = [](int x) { return x % 3; };
+    assert(nub_on(mod3, IntVector({ 1,4,2,7,5,3 })) == IntVector({ 1,2,3 }));
+    assert(all_unique_hash(IntVector()) == true);
+    assert(all_unique_hash(IntVector({ 1,2,3 })) == true);
+    assert(all_unique_hash(xs) == false);
+    assert(all_unique_hash(std::string("abc")) == true);
+    assert(all_unique_hash(std::string("abca")) == false);
+    assert(nub(std::vector<std::string>({ "b","a","b" })) ==
+        std::vector<std::string>({ "b","a" }));
+    {
+        // Types without std::hash fall back to the quadratic version.
+        typedef std::vector<std::pair<int, int>> IntPairs;
+        IntPairs ps;
+        for (int i = 0; i < 40; ++i)
+            ps.push_back(std::make_pair(i % 7, i % 2));
+        assert(nub(ps) == nub_by(std::equal_to<std::pair<int, int>>(), ps));
+        assert(size_of_cont(nub(ps)) == 14);
+        assert(all_unique(ps) == false);
+    }
+    {
+        std::mt19937 gen(19);
+        for (int range : {1, 3, 50, 1000})
+        {
+            for (std::size_t n : {0, 1, 10, 17, 500})
+            {
+                const IntVector ys = random_ints(gen, range, n);
+                const auto bytes = convert_container_and_elems<
+                    std::vector<std::int8_t>>(ys);
+                const auto shorts = convert_container_and_elems<
+                    std::vector<std::uint16_t>>(ys);
+                const auto expected = nub_by(std::equal_to<int>(), ys);
+                assert(nub(ys) == expected);
+                assert(nub_hash(ys) == expected);
+                assert(nub_on(abs_int, ys) ==
+                    nub_by(is_equal_by(abs_int), ys));
+                assert(nub_hash(bytes) ==
+                    nub_by(std::equal_to<std::int8_t>(), bytes));
+                assert(nub(shorts) ==
+                    nub_by(std::equal_to<std::uint16_t>(), shorts));
+                const bool unique = expected.size() == ys.size();
+                assert(all_unique(ys) == unique);
+                assert(all_unique_hash(ys) == unique);
+                assert(all_unique_hash(shorts) ==
+                    (nub_hash(shorts).size() == shorts.size()));
+            }
+        }
+    }
 
     typedef std::map<int, std::string> IntStringMap;
     typedef std::map<std::string, int> StringIntMap;
@@ -903,6 +1163,35 @@ void Test_ContainerTools()
     typedef std::map<int, std::size_t> IntSizeTMap;
     IntSizeTMap OccurrencesResult = {{1, 1}, {2, 3}, {3, 1}};
     assert(count_occurrences(xs) == OccurrencesResult);
+    assert(count_occurrences_hash(xs) ==
+        (std::unordered_map<int, std::size_t>(
+            std::begin(OccurrencesResult), std::end(OccurrencesResult))));
+    typedef std::vector<std::pair<int, std::size_t>> IntSizeTPairs;
+    assert(count_occurrences_flat(IntVector({2,1,2,3,2})) ==
+        IntSizeTPairs({{2, 3}, {1, 1}, {3, 1}}));
+    assert(count_occurrences_flat(IntVector()) == IntSizeTPairs());
+    assert(count_occurrences(std::string("abba")) ==
+        (std::map<char, std::size_t>({{'a', 2}, {'b', 2}})));
+    assert(count_occurrences_flat(std::string("abca")) ==
+        (std::vector<std::pair<char, std::size_t>>(
+            {{'a', 2}, {'b', 1}, {'c', 1}})));
+    {
+        std::mt19937 gen(23);
+        for (int range : {1, 3, 200, 40000})
+        {
+            for (std::size_t n : {0, 1, 10, 5000})
+            {
+                const IntVector ys = random_ints(gen, range, n);
+                check_count_occurrences(ys);
+                check_count_occurrences(convert_container_and_elems<
+                    std::vector<std::int8_t>>(ys));
+                check_count_occurrences(convert_container_and_elems<
+                    std::vector<std::int16_t>>(ys));
+                check_count_occurrences(transform(
+                    [](int x) { return std::to_string(x); }, ys));
+            }
+        }
+    }
 
     assert(replace_range(2, IntVector({8,9}), xs) == IntVector({1,2,8,9,2}));
     assert(insert_at(2, IntVector({8,9}), xs) == IntVector({1,2,8,9,2,3,2}));
@@ -922,6 +1211,105 @@ void Test_ContainerTools()
     assert(iterate(times_two, 5, 3) == IntVector({3,6,12,24,48}));
 }
 
+template <typename String>
+void check_line_splitter(const String& text, std::mt19937& gen)
+{
+    for (bool allowEmpty : {false, true})
+    {
+        fplus::line_splitter<String> splitter(allowEmpty);
+        std::vector<String> lines;
+        auto add_line = [&](const String& line) { lines.push_back(line); };
+        std::size_t pos = 0;
+        while (pos < text.size())
+        {
+            std::uniform_int_distribution<std::size_t> dis(0, 4);
+            const std::size_t length = std::min(dis(gen), text.size() - pos);
+            splitter.feed(text.substr(pos, length), add_line);
+            pos += length;
+        }
+        splitter.finish(add_line);
+        assert(lines == fplus::split_lines(text, allowEmpty));
+    }
+}
+
+std::wstring widen_bytes(const std::string& str)
+{
+    std::wstring result;
+    for (char c : str)
+        result.push_back(static_cast<wchar_t>(static_cast<unsigned char>(c)));
+    return result;
+}
+
+std::vector<std::wstring> widen_bytes(const std::vector<std::string>& strs)
+{
+    std::vector<std::wstring> result;
+    for (const auto& str : strs)
+        result.push_back(widen_bytes(str));
+    return result;
+}
+
+// Compares the byte kernels with the generic path used for wide strings.
+void check_char_kernels()
+{
+    using namespace fplus;
+    const std::string alphabet = std::string(" \t\v\r\n,.-aZz09\x80\xff") +
+        std::string(1, '\0');
+    const std::string many_delims = " ,.-\t\r\n\v9\x80";
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<std::size_t> dis(0, alphabet.size() - 1);
+    for (std::size_t n = 0; n < 100; ++n)
+    {
+        for (int round = 0; round < 5; ++round)
+        {
+            std::string str;
+            for (std::size_t i = 0; i < n; ++i)
+                str.push_back(alphabet[dis(gen)]);
+            if (round == 0)
+                str = std::string(n / 2, ' ') + str + std::string(n / 2, '\t');
+            const std::wstring wstr = widen_bytes(str);
+            for (bool allowEmpty : {false, true})
+            {
+                assert(widen_bytes(split_words(str, allowEmpty))
+                    == split_words(wstr, allowEmpty));
+                assert(widen_bytes(split_words_by(str, ',', allowEmpty))
+                    == split_words_by(wstr, L',', allowEmpty));
+                assert(widen_bytes(split_words_by(str, '\x80', allowEmpty))
+                    == split_words_by(wstr, wchar_t(0x80), allowEmpty));
+                assert(widen_bytes(split_words_by_many(str,
+                        std::string(" ,\r"), allowEmpty))
+                    == split_words_by_many(wstr, std::wstring(L" ,\r"),
+                        allowEmpty));
+                assert(widen_bytes(split_words_by_many(str, many_delims,
+                        allowEmpty))
+                    == split_words_by_many(wstr, widen_bytes(many_delims),
+                        allowEmpty));
+                assert(widen_bytes(split_lines(str, allowEmpty))
+                    == split_lines(wstr, allowEmpty));
+                assert(split_lines_spans(str, allowEmpty)
+                    == split_lines_spans(wstr, allowEmpty));
+            }
+            const unsigned char* bytes =
+                reinterpret_cast<const unsigned char*>(str.data());
+            assert(internal::find_first_byte_in_class(bytes, str.size(),
+                    internal::line_break_bytes())
+                == std::min(str.find_first_of("\r\n"), str.size()));
+            assert(internal::find_first_byte_in_class(bytes, str.size(),
+                    internal::whitespace_bytes())
+                == std::min(str.find_first_of(" \t\n\v\f\r"), str.size()));
+            assert(widen_bytes(trim_whitespace_left(str))
+                == trim_whitespace_left(wstr));
+            assert(widen_bytes(trim_whitespace_right(str))
+                == trim_whitespace_right(wstr));
+            assert(widen_bytes(trim_whitespace(str)) == trim_whitespace(wstr));
+            assert(widen_bytes(clean_newlines(str)) == clean_newlines(wstr));
+            assert(clean_newlines(str) == replace_elems('\r', '\n',
+                replace_tokens(std::string("\r\n"), std::string("\n"), str)));
+            check_line_splitter(str, gen);
+            check_line_splitter(wstr, gen);
+        }
+    }
+}
+
 void Test_StringTools()
 {
     using namespace fplus;
@@ -968,10 +1356,146 @@ void Test_StringTools()
     assert(split_words_by(text, ' ', false) == textSplitBySpaceOnly);
     assert(split_words_by_many(text, std::string{ " ,\r\n" }, false) == textSplitBySpaceAndCommaAndLine);
 
+    typedef std::vector<std::pair<std::size_t, std::size_t>> Spans;
+    auto parts_of_spans = [&](const Spans& spans) -> std::vector<std::string>
+    {
+        std::vector<std::string> result;
+        for (const auto& span : spans)
+            result.push_back(text.substr(span.first, span.second));
+        return result;
+    };
+    for (bool allowEmpty : {false, true})
+    {
+        assert(parts_of_spans(split_lines_spans(text, allowEmpty))
+            == split_lines(text, allowEmpty));
+        assert(parts_of_spans(split_words_spans(text, allowEmpty))
+            == split_words(text, allowEmpty));
+        assert(parts_of_spans(split_words_by_spans(text, ' ', allowEmpty))
+            == split_words_by(text, ' ', allowEmpty));
+        assert(parts_of_spans(split_words_by_many_spans(
+                text, std::string(" ,\r\n"), allowEmpty))
+            == split_words_by_many(text, std::string(" ,\r\n"), allowEmpty));
+        assert(parts_of_spans(split_by_token_spans(
+                std::string("a"), allowEmpty, text))
+            == split_by_token(std::string("a"), allowEmpty, text));
+    }
+    for (const std::string lines : {"", "\n", "\r", "\r\n", "\n\r", "a\r\r\nb",
+        "\r\n\r\n", "a\n"})
+    {
+        for (bool allowEmpty : {false, true})
+        {
+            std::vector<std::string> parts;
+            for (const auto& span : split_lines_spans(lines, allowEmpty))
+                parts.push_back(lines.substr(span.first, span.second));
+            assert(parts == split_lines(lines, allowEmpty));
+        }
+    }
+    assert(split_words_spans(std::string("How are you?"), false)
+        == Spans({{0, 3}, {4, 3}, {8, 3}}));
+    auto is_even = [](int x) { return x % 2 == 0; };
+    assert(split_by_spans(is_even, true, std::vector<int>({1,3,2,2,5,5,3,6,7,9}))
+        == Spans({{0, 2}, {3, 0}, {4, 3}, {8, 2}}));
+    auto int_eq = [](int x, int y) { return x == y; };
+    assert(group_by_spans(int_eq, std::vector<int>({1,2,2,2,3,2,2,4,5,5}))
+        == Spans({{0, 1}, {1, 3}, {4, 1}, {5, 2}, {7, 1}, {8, 2}}));
+    assert(group_by_spans(int_eq, std::vector<int>()) == Spans());
+    assert(group_by_spans(int_eq, std::list<int>({7})) == Spans({{0, 1}}));
+    auto both_even = [](int x, int y) { return x % 2 == 0 && y % 2 == 0; };
+    {
+        const std::vector<int> ys = {2,4,1,6,8,8,3,3};
+        const auto groups = group_by(both_even, ys);
+        const auto spans = group_by_spans(both_even, ys);
+        assert(spans.size() == groups.size());
+        for (std::size_t i = 0; i < spans.size(); ++i)
+            assert(get_range(spans[i].first,
+                spans[i].first + spans[i].second, ys) == groups[i]);
+    }
+    assert(split_by_token_spans(std::string(", "), false,
+        std::string("foo, bar, baz")) == Spans({{0, 3}, {5, 3}, {10, 3}}));
+    assert(split_by_token(std::string(","), false, std::string("a,,b"))
+        == std::vector<std::string>({"a", "b"}));
+    assert(split_by_token(std::string(","), false, std::string(",a,"))
+        == std::vector<std::string>({"a"}));
+    assert(split_by_token(std::string(","), true, std::string("a,,b"))
+        == std::vector<std::string>({"a", "", "b"}));
+
+#if __cplusplus >= 201703L
+    auto views_as_strings = [](const auto& views)
+    {
+        std::vector<std::string> result;
+        for (const auto& view : views)
+            result.push_back(std::string(view));
+        return result;
+    };
+    for (bool allowEmpty : {false, true})
+    {
+        assert(views_as_strings(split_lines_views(text, allowEmpty))
+            == split_lines(text, allowEmpty));
+        assert(views_as_strings(split_words_views(text, allowEmpty))
+            == split_words(text, allowEmpty));
+        assert(views_as_strings(split_words_by_views(text, ' ', allowEmpty))
+            == split_words_by(text, ' ', allowEmpty));
+        assert(views_as_strings(split_words_by_many_views(
+                text, std::string(" ,\r\n"), allowEmpty))
+            == split_words_by_many(text, std::string(" ,\r\n"), allowEmpty));
+        assert(views_as_strings(split_by_token_views(
+                std::string("a"), allowEmpty, text))
+            == split_by_token(std::string("a"), allowEmpty, text));
+    }
+    assert(split_words_views(text, false).front().data() == text.data());
+#endif
+
+    {
+        auto& isa = internal::active_char_kernel_isa();
+        const auto detected_isa = isa;
+        for (auto tested_isa : {internal::char_kernel_isa::scalar,
+            internal::char_kernel_isa::sse2, internal::char_kernel_isa::avx2})
+        {
+            if (tested_isa > detected_isa)
+                continue;
+            isa = tested_isa;
+            check_char_kernels();
+        }
+        isa = detected_isa;
+    }
+
+    {
+        fplus::line_splitter<std::string> splitter(false);
+        std::vector<std::string> lines;
+        auto add_line = [&](const std::string& line) { lines.push_back(line); };
+        splitter.feed("Hi,\r", add_line);
+        assert(lines == std::vector<std::string>({"Hi,"}));
+        splitter.feed("\nhow are", add_line);
+        splitter.feed(" you?", add_line);
+        assert(lines.size() == 1);
+        splitter.finish(add_line);
+        assert(lines == std::vector<std::string>({"Hi,", "how are you?"}));
+        splitter.feed("again", add_line);
+        splitter.finish(add_line);
+        assert(lines.back() == "again");
+    }
+    assert(clean_newlines(std::string("a\r\nb\rc\n")) == "a\nb\nc\n");
+
     assert(to_string_fill_left('0', 5, 42) == std::string("00042") );
     assert(to_string_fill_right(' ', 5, 42) == std::string("42   ") );
 }
 
+// Sets a C locale with a decimal point other than '.', if one is installed.
+// Returns the previous locale then, and an empty string otherwise.
+std::string set_decimal_comma_locale()
+{
+    const std::string previous = std::setlocale(LC_ALL, nullptr);
+    for (const char* name : {"", "de_DE.UTF-8", "de_DE.utf8", "de_DE",
+        "fr_FR.UTF-8", "fr_FR.utf8", "German"})
+    {
+        if (std::setlocale(LC_ALL, name) != nullptr &&
+            std::strcmp(std::localeconv()->decimal_point, ".") != 0)
+            return previous;
+    }
+    std::setlocale(LC_ALL, previous.c_str());
+    return std::string();
+}
+
 void Test_Read()
 {
     using namespace fplus;
@@ -994,83 +1518,1275 @@ void Test_Read()
     assert(is_in_range(-42.4f, -42.2f)(unsafe_get_just(read_value<float>("-42.3"))));
     assert(is_in_range(-42.4 , -42.2 )(unsafe_get_just(read_value<double>("-42.3"))));
     assert(is_in_range(-42.4L, -42.2L )(unsafe_get_just(read_value<long double>("-42.3"))));
+
+    assert(read_value<int>("  +7") == just(7));
+    assert(read_value<int>("7 ") == nothing<int>());
+    assert(read_value<int>("") == nothing<int>());
+    assert(read_value<int>("-") == nothing<int>());
+    assert(read_value<int>("2147483647") == just(2147483647));
+    assert(read_value<int>("-2147483648") == just<int>(-2147483647 - 1));
+    assert(read_value<int>("2147483648") == nothing<int>());
+    assert(read_value<int>("-2147483649") == nothing<int>());
+    assert(read_value<long long>("-9223372036854775808")
+        == just(std::numeric_limits<long long>::min()));
+    assert(read_value<unsigned long long>("18446744073709551615")
+        == just(std::numeric_limits<unsigned long long>::max()));
+    assert(read_value<unsigned long long>("18446744073709551616")
+        == nothing<unsigned long long>());
+    assert(read_value<unsigned int>("4294967296") == nothing<unsigned int>());
+    assert(read_value<unsigned int>("-1") == nothing<unsigned int>());
+    assert(read_value<unsigned int>("-0") == just(0u));
+    assert(unsafe_get_error(read_value_result<int>("99999999999"))
+        == "Out of range.");
+    assert(unsafe_get_error(read_value_result<int>("42x"))
+        == "Trailing chars.");
+
+    assert(read_value<double>("1e5") == just(1e5));
+    assert(read_value<double>(".5") == just(0.5));
+    assert(read_value<double>("5.") == just(5.0));
+    assert(read_value<double>("-0") == just(-0.0));
+    assert(read_value<double>("0x1p3") == just(8.0));
+    assert(read_value<double>("1e") == nothing<double>());
+    assert(read_value<double>(".") == nothing<double>());
+    assert(read_value<double>("1e999") == nothing<double>());
+    assert(read_value<double>("1.5 ") == nothing<double>());
+    assert(read_value<double>("-inf") ==
+        just(-std::numeric_limits<double>::infinity()));
+    assert(std::isnan(unsafe_get_just(read_value<double>("nan"))));
+    assert(read_value<double>("1.7976931348623157e308")
+        == just(std::numeric_limits<double>::max()));
+    assert(read_value<double>("123456789012345678901234567890")
+        == just(123456789012345678901234567890.0));
+    {
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<long long> mantissas(
+            -99999999999LL, 99999999999LL);
+        std::uniform_int_distribution<int> exponents(-40, 40);
+        std::uniform_int_distribution<std::uint64_t> bits;
+        for (int i = 0; i < 20000; ++i)
+        {
+            const std::string str = std::to_string(mantissas(gen)) + "e" +
+                std::to_string(exponents(gen));
+            errno = 0;
+            const float f = std::strtof(str.c_str(), nullptr);
+            assert(read_value<float>(str) ==
+                (errno == ERANGE ? nothing<float>() : just(f)));
+            assert(read_value<double>(str)
+                == just(std::strtod(str.c_str(), nullptr)));
+            std::uint64_t x = bits(gen);
+            double d;
+            std::memcpy(&d, &x, sizeof(d));
+            if (!std::isfinite(d) || std::fabs(d) < 1e-300)
+                continue;
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), "%.17g", d);
+            assert(read_value<double>(buffer) == just(d));
+        }
+    }
+
+    assert(read_values<int>(std::vector<std::string>({"1", "x", "3"}))
+        == std::vector<maybe<int>>({just(1), nothing<int>(), just(3)}));
+    assert(read_values<double>(std::list<std::string>()).empty());
+
+    const std::string previous_locale = set_decimal_comma_locale();
+    if (!previous_locale.empty())
+    {
+        assert(read_value<double>("1.5") == just(1.5));
+        assert(read_value<double>("1.5e30") == just(1.5e30));
+        assert(read_value<double>("6.02e23") == just(6.02e23));
+        assert(read_value<double>("0.12345678901234567890123")
+            == just(0.12345678901234567890123));
+        assert(read_value<double>("0x1.8p1") == just(3.0));
+        assert(read_value<float>("2.5e-40") == nothing<float>());
+        assert(read_value<long double>("1.25e40") == just(1.25e40L));
+        assert(read_value<double>("1,5e30") == nothing<double>());
+        assert(read_value_result<double>("1.5e30.5") ==
+            (error<double, std::string>("Trailing chars.")));
+        std::setlocale(LC_ALL, previous_locale.c_str());
+    }
 }
 
-bool is_odd(int x) { return x % 2 == 1; }
-void Test_example_KeepIf()
+// Upper bounds for the number of heap allocations of single calls,
+// to catch unnecessary copies inside of the library.
+void Test_Lazy()
 {
-    typedef std::vector<int> Ints;
-    Ints numbers = { 24, 11, 65, 44, 80, 18, 73, 90, 69, 18 };
+    using namespace fplus;
+    typedef std::vector<int> IntVector;
+    typedef std::list<int> IntList;
+    typedef std::vector<IntVector> IntVectors;
+    const IntVector xs = {1, 2, 3, 4, 5, 6, 7, 8};
+    const IntList intList = {1, 2, 3, 4, 5, 6, 7, 8};
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto is_small = [](int x) { return x < 4; };
+    auto squared = [](int x) { return x * x; };
+
+    assert(lazy::materialize(lazy::transform(squared, xs)) == transform(squared, xs));
+    assert(lazy::materialize(lazy::keep_if(is_even, xs)) == keep_if(is_even, xs));
+    assert(lazy::materialize(lazy::drop_if(is_even, intList)) ==
+        drop_if(is_even, intList));
+    assert(lazy::materialize(lazy::take(3, xs)) == take(3, xs));
+    assert(lazy::materialize(lazy::take(20, xs)) == xs);
+    assert(lazy::materialize(lazy::drop(3, intList)) == drop(3, intList));
+    assert(lazy::materialize(lazy::drop(20, xs)) == IntVector());
+    assert(lazy::materialize(lazy::take_while(is_small, xs)) ==
+        take_while(is_small, xs));
+    assert(lazy::materialize(lazy::zip(xs, intList)) == zip(xs, xs));
+    assert(lazy::materialize<IntList>(lazy::keep_if(is_even, xs)) ==
+        keep_if(is_even, intList));
+
+    // Stages are fused and run in one pass.
+    assert(lazy::materialize(lazy::transform(squared,
+        lazy::keep_if(is_even, lazy::drop(1, xs)))) ==
+        transform(squared, keep_if(is_even, drop(1, xs))));
+    assert(lazy::materialize(lazy::take(2, lazy::keep_if(is_even,
+        lazy::transform(squared, xs)))) == IntVector({4, 16}));
+
+    // Temporaries are moved into the view.
+    auto view = lazy::keep_if(is_even, IntVector({1, 2, 3, 4}));
+    assert(lazy::materialize(view) == IntVector({2, 4}));
+
+    assert(lazy::materialize(lazy::concat(IntVectors({{1, 2}, {}, {3}, {}}))) ==
+        IntVector({1, 2, 3}));
+    assert(lazy::materialize(lazy::concat(
+        lazy::split_by(is_even, false, xs))) == IntVector({1, 3, 5, 7}));
+
+    typedef std::vector<std::string> Strings;
+    const std::string text = "How are, you? ";
+    assert(lazy::materialize(lazy::split_words(text, false)) ==
+        split_words(text, false));
+    assert(lazy::materialize(lazy::split_words(text, true)) ==
+        split_words(text, true));
+    assert(lazy::materialize(lazy::split_words(std::string(), true)) == Strings());
+    assert(lazy::materialize(lazy::split_by(is_even, true,
+        IntVector({1,3,2,2,5,5,3,6,7,9}))) ==
+        split_by(is_even, true, IntVector({1,3,2,2,5,5,3,6,7,9})));
+    assert(lazy::materialize(lazy::concat(lazy::split_words(text, false))) ==
+        "Howareyou");
+
+    IntVector iterated;
+    for (int x : lazy::keep_if(is_even, xs))
+        iterated.push_back(x);
+    assert(iterated == keep_if(is_even, xs));
+
+    // Consumers stop as soon as the result is known.
+    std::size_t calls = 0;
+    auto counted_squared = [&calls](int x) { ++calls; return x * x; };
+    assert(lazy::is_elem_of(9, lazy::transform(counted_squared, xs)));
+    assert(calls == 3);
+    calls = 0;
+    assert(lazy::find_first_by(is_even,
+        lazy::transform(counted_squared, xs)) == just(4));
+    assert(calls == 2);
+    calls = 0;
+    assert(lazy::any_by(is_even, lazy::transform(counted_squared, xs)));
+    assert(calls == 2);
+    calls = 0;
+    assert(!lazy::all_by(is_small, lazy::transform(counted_squared, xs)));
+    assert(calls == 2);
+    calls = 0;
+    lazy::materialize(lazy::take(3, lazy::keep_if(is_even,
+        lazy::transform(counted_squared, xs))));
+    assert(calls == 6);
+    assert(lazy::find_first_by(is_even, lazy::take(0, xs)) ==
+        nothing<int>());
+    assert(lazy::is_elem_of(std::string("you"),
+        lazy::split_words(text, false)));
+    assert(!lazy::is_elem_of(std::string("I"),
+        lazy::split_words(text, false)));
+}
 
-    { // Version 1: hand written range based for loop
-    Ints odds;
-    for (int x : numbers)
-        if (is_odd(x))
-            odds.push_back(x);
+void Test_Par()
+{
+    using namespace fplus;
+    typedef std::vector<int> IntVector;
+    typedef std::deque<int> IntDeque;
+    // Force chunking even for small inputs.
+    const std::size_t min_parallel_size = par::min_parallel_size();
+    par::min_parallel_size() = 1;
+
+    const IntVector xs = generate_by_idx<IntVector>(
+        [](std::size_t i) { return static_cast<int>((i * 7919) % 1000); },
+        1000);
+    const IntDeque xs_deque = convert_container<IntDeque>(xs);
+    const std::string text(1000, 'a');
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto is_big = [](int x) { return x > 2000; };
+    auto squared = [](int x) { return x * x; };
+    auto plus_idx = [](std::size_t i, int x) { return static_cast<int>(i) + x; };
+    auto plus = [](int x, int y) { return x + y; };
+
+    assert(par::transform(squared, xs) == transform(squared, xs));
+    assert(par::transform(squared, xs_deque) == transform(squared, xs_deque));
+    assert(par::transform(is_even, xs) == transform(is_even, xs));
+    assert(par::transform(just<int>, xs) == transform(just<int>, xs));
+    assert(par::transform_with_idx(plus_idx, xs) ==
+        transform_with_idx(plus_idx, xs));
+    assert(par::generate_by_idx<IntVector>(
+        [](std::size_t i) { return static_cast<int>(i); }, 1000) ==
+        generate_range<IntVector>(0, 1000));
+    assert(par::keep_if(is_even, xs) == keep_if(is_even, xs));
+    assert(par::keep_if(is_even, xs_deque) == keep_if(is_even, xs_deque));
+    assert(par::drop_if(is_even, xs) == drop_if(is_even, xs));
+    assert(par::keep_if(is_big, xs) == IntVector());
+    assert(par::count_if(is_even, xs) == count_if(is_even, xs));
+    assert(par::all_by(is_even, xs) == all_by(is_even, xs));
+    assert(par::all_by(logical_not(is_big), xs));
+    assert(par::any_by(is_even, xs));
+    assert(!par::any_by(is_big, xs));
+    assert(par::sum(xs) == sum(xs));
+    assert(par::fold_left(plus, 42, xs) == fold_left(plus, 42, xs));
+    assert(par::sort_by(std::less<int>(), xs) == sort(xs));
+    assert(par::sort_by(std::greater<int>(), xs_deque) ==
+        sort_by(std::greater<int>(), xs_deque));
+    assert(par::transform([](char c) { return static_cast<char>(c + 1); },
+        text) == std::string(1000, 'b'));
+    assert(par::transform(squared, IntVector()) == IntVector());
+
+    // Chunk results are combined in input order.
+    typedef std::vector<std::string> Strings;
+    const Strings words = transform([](int x) { return std::to_string(x); },
+        xs);
+    auto append_strings = [](const std::string& acc, const std::string& x)
+        { return acc + x; };
+    assert(par::fold_left(append_strings, std::string("-"), words) ==
+        fold_left(append_strings, std::string("-"), words));
+    typedef std::pair<int, std::size_t> IntAndIdx;
+    const auto with_idx = transform_with_idx(
+        [](std::size_t i, int x) { return IntAndIdx(x % 10, i); }, xs);
+    auto first_less = [](const IntAndIdx& a, const IntAndIdx& b)
+        { return a.first < b.first; };
+    const auto sorted = par::sort_by(first_less, with_idx);
+    assert(sorted == sort(with_idx));
+
+    // Exceptions reach the caller.
+    bool thrown = false;
+    try
+    {
+        par::transform([](int x) -> int
+        {
+            if (x == 999)
+                throw std::runtime_error("999");
+            return x;
+        }, xs);
     }
-
-    { // Version 2: STL
-    Ints odds;
-    std::copy_if(std::begin(numbers), std::end(numbers),
-            std::back_inserter(odds), is_odd);
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
     }
+    assert(thrown);
+
+    // Nested parallel calls.
+    const std::vector<IntVector> xss(8, xs);
+    const auto sums = par::transform([](const IntVector& ys)
+        { return par::sum(ys); }, xss);
+    assert(sums == std::vector<int>(8, sum(xs)));
+
+    assert(par::count_occurrences(xs) == count_occurrences(xs));
+    assert(par::count_occurrences(text) == count_occurrences(text));
+    assert(par::count_occurrences(IntVector({1,2,2,3,2})) ==
+        (std::map<int, std::size_t>({{1, 1}, {2, 3}, {3, 1}})));
+    assert(par::count_occurrences(
+        transform([](int x) { return std::to_string(x % 17); }, xs)) ==
+        count_occurrences(
+            transform([](int x) { return std::to_string(x % 17); }, xs)));
+    typedef std::unordered_map<std::uint16_t, std::size_t> ShortCounts;
+    const auto shorts = transform([](int x)
+        { return static_cast<std::uint16_t>(x * 61); }, xs);
+    assert((par::count_occurrences<std::vector<std::uint16_t>, ShortCounts>(
+        shorts)) == (count_occurrences<std::vector<std::uint16_t>,
+            ShortCounts>(shorts)));
+
+    par::min_parallel_size() = min_parallel_size;
+
+    // Small inputs are sorted sequentially, but stably too.
+    const auto few_with_idx = take(100, with_idx);
+    assert(par::sort_by(first_less, few_with_idx) == sort(few_with_idx));
+}
 
-    { // Version : FunctionalPlus
-    auto odds = fplus::keep_if(is_odd, numbers);
+// Sequence types only providing some of the members
+// container_builder looks for.
+template <typename T>
+class push_back_vector
+{
+public:
+    typedef T value_type;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    push_back_vector() : reserved_(0) {}
+    const_iterator begin() const { return xs_.begin(); }
+    const_iterator end() const { return xs_.end(); }
+    std::size_t size() const { return xs_.size(); }
+    bool empty() const { return xs_.empty(); }
+    void reserve(std::size_t size) { reserved_ = size; xs_.reserve(size); }
+    void push_back(const T& x) { xs_.push_back(x); }
+    std::size_t reserved() const { return reserved_; }
+    const std::vector<T>& elems() const { return xs_; }
+private:
+    std::vector<T> xs_;
+    std::size_t reserved_;
+};
+
+template <typename T>
+class emplace_back_vector
+{
+public:
+    typedef T value_type;
+    typedef typename std::vector<T>::const_iterator const_iterator;
+    const_iterator begin() const { return xs_.begin(); }
+    const_iterator end() const { return xs_.end(); }
+    std::size_t size() const { return xs_.size(); }
+    template <typename... Args>
+    void emplace_back(Args&&... args)
+    {
+        xs_.emplace_back(std::forward<Args>(args)...);
     }
-}
+    const std::vector<T>& elems() const { return xs_; }
+private:
+    std::vector<T> xs_;
+};
 
-void run_n_times(std::function<std::vector<int>(std::vector<int>)> f,
-    std::size_t n, const std::string& name, const std::vector<int>& inList)
+// Reference implementation comparing the token at every position.
+template <typename Container>
+std::vector<std::size_t> naive_instances_of_token(const Container& token,
+    const Container& xs, bool overlapping)
 {
-    typedef std::chrono::time_point<std::chrono::system_clock> Time;
-    Time startTime = std::chrono::system_clock::now();
-    size_t lengthSum = 0;
-    for (size_t i = 0; i < n; ++i)
+    std::vector<std::size_t> result;
+    const std::size_t n = fplus::size_of_cont(xs);
+    const std::size_t m = fplus::size_of_cont(token);
+    for (std::size_t i = 0; m <= n && i <= n - m; ++i)
     {
-        lengthSum += f(inList).size();
+        if (!result.empty() && !overlapping && i < result.back() + m)
+            continue;
+        if (fplus::get_range(i, i + m, xs) == token)
+            result.push_back(i);
     }
-    Time endTime = std::chrono::system_clock::now();
-    std::chrono::duration<double> elapsed_seconds = endTime - startTime;
-    std::cout << name << "(check: " << lengthSum << "), elapsed time: " << elapsed_seconds.count() << "s\n";
+    return result;
 }
 
-void Test_example_KeepIf_performance()
+template <typename Container>
+void check_token_search(const Container& token, const Container& xs)
 {
     using namespace fplus;
+    const auto overlapping = naive_instances_of_token(token, xs, true);
+    assert(find_all_instances_of_token(token, xs) == overlapping);
+    assert(find_all_instances_of_token_non_overlapping(token, xs)
+        == naive_instances_of_token(token, xs, false));
+    assert(find_first_instance_of_token(token, xs) == (overlapping.empty()
+        ? nothing<std::size_t>() : just(overlapping.front())));
+}
 
-    typedef std::vector<int> Ints;
-    auto run_loop = [&](const Ints numbers)
+template <typename Container>
+void check_token_search_random(const std::string& alphabet)
+{
+    std::mt19937 gen(42);
+    for (std::size_t n : {0, 1, 7, 40, 300})
     {
-        Ints odds;
-        for (int x : numbers)
-            if (is_odd(x))
-                odds.push_back(x);
-        return odds;
+        for (std::size_t m : {1, 2, 3, 7, 8, 9, 20})
+        {
+            for (int round = 0; round < 3; ++round)
+            {
+                std::uniform_int_distribution<std::size_t> dis(
+                    0, alphabet.size() - 1);
+                Container xs;
+                for (std::size_t i = 0; i < n; ++i)
+                    xs.insert(std::end(xs),
+                        static_cast<typename Container::value_type>(
+                            alphabet[dis(gen)]));
+                Container token;
+                for (std::size_t i = 0; i < m; ++i)
+                    token.insert(std::end(token),
+                        static_cast<typename Container::value_type>(
+                            alphabet[dis(gen)]));
+                check_token_search(token, xs);
+                if (n >= m)
+                    check_token_search(fplus::get_range(n - m, n, xs), xs);
+            }
+        }
+    }
+}
+
+template <typename Container>
+void check_tokens_search_random(const std::string& alphabet)
+{
+    typedef std::vector<std::pair<std::size_t, std::size_t>> Instances;
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> dis(0, alphabet.size() - 1);
+    auto random_container = [&](std::size_t n) -> Container
+    {
+        Container xs;
+        for (std::size_t i = 0; i < n; ++i)
+            xs.insert(std::end(xs), static_cast<typename Container::value_type>(
+                alphabet[dis(gen)]));
+        return xs;
     };
-    auto run_stl = [&](const Ints numbers)
+    for (std::size_t token_count : {1, 2, 5, 20})
     {
-        Ints odds;
-            std::copy_if(std::begin(numbers), std::end(numbers),
-                    std::back_inserter(odds), is_odd);
-        return odds;
+        std::vector<Container> tokens;
+        for (std::size_t i = 0; i < token_count; ++i)
+            tokens.push_back(random_container(1 + i % 4));
+        const auto automaton = fplus::make_token_automaton(tokens);
+        for (std::size_t n : {0, 1, 10, 200})
+        {
+            const Container xs = random_container(n);
+            Instances expected;
+            for (std::size_t i = 0; i < tokens.size(); ++i)
+                for (std::size_t pos : naive_instances_of_token(
+                        tokens[i], xs, true))
+                    expected.push_back(std::make_pair(i, pos));
+            std::sort(std::begin(expected), std::end(expected),
+                [](const std::pair<std::size_t, std::size_t>& a,
+                    const std::pair<std::size_t, std::size_t>& b)
+            {
+                return std::make_pair(a.second, a.first)
+                    < std::make_pair(b.second, b.first);
+            });
+            assert(fplus::find_all_instances_of_tokens(automaton, xs)
+                == expected);
+            assert(fplus::find_all_instances_of_tokens(tokens, xs)
+                == expected);
+        }
+    }
+}
+
+template <typename Container>
+void check_replace_tokens_random(const std::string& alphabet)
+{
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<std::size_t> dis(0, alphabet.size() - 1);
+    auto random_container = [&](std::size_t n) -> Container
+    {
+        Container xs;
+        for (std::size_t i = 0; i < n; ++i)
+            xs.insert(std::end(xs), static_cast<typename Container::value_type>(
+                alphabet[dis(gen)]));
+        return xs;
     };
-    auto run_FunctionalPlus = [&](const Ints numbers)
-        { return keep_if(is_odd, numbers); };
-
-    // make debug runs faster
-#if defined NDEBUG || defined _DEBUG
-    std::size_t numRuns = 10;
-#else
-    std::size_t numRuns = 20000;
+    for (std::size_t source_size : {0, 1, 2, 3, 9})
+    {
+        for (std::size_t dest_size : {0, 1, 2, 3, 9})
+        {
+            for (std::size_t n : {0, 1, 2, 10, 100})
+            {
+                const Container source = random_container(source_size);
+                const Container dest = random_container(dest_size);
+                const Container xs = random_container(n);
+                const Container expected =
+                    fplus::join(dest, fplus::split_by_token(source, true, xs));
+                assert(fplus::replace_tokens(source, dest, xs) == expected);
+                Container ys = xs;
+                assert(fplus::replace_tokens(source, dest, std::move(ys))
+                    == expected);
+            }
+        }
+    }
+}
+
+void Test_TokenSearch()
+{
+    using namespace fplus;
+    typedef std::vector<int> IntVector;
+    typedef std::vector<std::size_t> IdxVector;
+    // Byte search with memchr and Boyer-Moore-Horspool.
+    check_token_search_random<std::string>("ab");
+    check_token_search_random<std::string>("abcd\xff");
+    check_token_search_random<std::vector<unsigned char>>("ab\x80");
+    // First element search and Knuth-Morris-Pratt.
+    check_token_search_random<std::vector<int>>("ab");
+    check_token_search_random<std::deque<int>>("abc");
+    // Comparison at every position.
+    check_token_search_random<std::list<int>>("ab");
+
+    const std::string long_token = "abcabcabca";
+    assert(find_all_instances_of_token(long_token,
+        std::string("abcabcabcabcabca"))
+        == IdxVector({0, 3, 6}));
+    assert(find_all_instances_of_token_non_overlapping(long_token,
+        std::string("abcabcabcabcabcabcabcabca"))
+        == IdxVector({0, 12}));
+    assert(find_all_instances_of_token(std::vector<int>(9, 1),
+        std::vector<int>(11, 1)) == IdxVector({0, 1, 2}));
+    assert(find_all_instances_of_token_non_overlapping(
+        std::vector<int>(9, 1), std::vector<int>(20, 1))
+        == IdxVector({0, 9}));
+    assert(is_infix_of(long_token, std::string("xxabcabcabcay")) == true);
+    assert(is_infix_of(long_token, std::string("xxabcabcabcby")) == false);
+    assert(replace_tokens(long_token, std::string("-"),
+        std::string("abcabcabcabcabcabcabcabcay")) == "-bc-bcay");
+    assert(trim_token_left(std::string("ab"), std::string("ababac"))
+        == "ac");
+    assert(trim_token_right(std::string("ab"), std::string("cabab"))
+        == "c");
+
+    check_replace_tokens_random<std::string>("ab");
+    check_replace_tokens_random<std::string>("abc");
+    check_replace_tokens_random<std::vector<int>>("ab");
+    check_replace_tokens_random<std::list<int>>("ab");
+    assert(replace_tokens(std::string(""), std::string("-"),
+        std::string("ab")) == "-a-b-");
+    assert(replace_tokens(std::string("aa"), std::string("bb"),
+        std::string("aaa")) == "bba");
+    {
+        std::string str = "x--x--xxxxxxxxxxxxxxxxxxxx";
+        const char* const data = str.data();
+        const std::string replaced = replace_tokens(std::string("--"),
+            std::string("++"), std::move(str));
+        assert(replaced == "x++x++xxxxxxxxxxxxxxxxxxxx");
+        assert(replaced.data() == data);
+    }
+
+    // Aho-Corasick
+    check_tokens_search_random<std::string>("ab");
+    check_tokens_search_random<std::string>("abc\xff");
+    check_tokens_search_random<std::vector<int>>("abc");
+    check_tokens_search_random<std::list<int>>("ab");
+    typedef std::vector<std::pair<std::size_t, std::size_t>> Instances;
+    const std::vector<std::string> he_she_hers = {"he", "she", "hers"};
+    assert(find_all_instances_of_tokens(he_she_hers, std::string("ushers"))
+        == Instances({{1, 1}, {0, 2}, {2, 2}}));
+    assert(find_all_instances_of_tokens(std::vector<std::string>({"", "a"}),
+        std::string("ba")) == Instances({{0, 0}, {0, 1}, {1, 1}, {0, 2}}));
+    assert(find_all_instances_of_tokens(std::vector<std::string>({"a", "a"}),
+        std::string("a")) == Instances({{0, 0}, {1, 0}}));
+    assert(find_all_instances_of_tokens(std::vector<std::string>(),
+        std::string("a")) == Instances());
+    const auto he_she_hers_automaton = make_token_automaton(he_she_hers);
+    assert(he_she_hers_automaton.token_count() == 3);
+    assert(find_all_instances_of_tokens(he_she_hers_automaton,
+        std::string("she")) == Instances({{1, 0}, {0, 1}}));
+    assert(find_all_instances_of_tokens(he_she_hers_automaton,
+        std::string("xyz")) == Instances());
+    assert(replace_tokens_many(std::vector<std::pair<std::string, std::string>>(
+        {{"he", "HE"}, {"hers", "X"}}), std::string("ushers and he"))
+        == "usX and HE");
+    assert(replace_tokens_many(std::map<std::string, std::string>(
+        {{"cat", "dog"}, {"dog", "cat"}}), std::string("cat dog catdog"))
+        == "dog cat dogcat");
+    assert(replace_tokens_many(he_she_hers_automaton,
+        std::vector<std::string>({"1", "2", "3"}), std::string("ushershe"))
+        == "u2r2");
+    assert(replace_tokens_many(std::map<IntVector, IntVector>(
+        {{{1, 2}, {}}, {{2, 3}, {9, 9}}}), IntVector({1, 2, 3, 2, 3, 4}))
+        == IntVector({3, 9, 9, 4}));
+    assert(replace_tokens_many(std::map<std::string, std::string>(),
+        std::string("abc")) == "abc");
+    {
+        std::map<std::string, std::string> single = {{"123", "_"}};
+        const std::string xs = "--123----123123";
+        assert(replace_tokens_many(single, xs)
+            == replace_tokens(std::string("123"), std::string("_"), xs));
+    }
+}
+
+struct ShowPoint
+{
+    int x_;
+    int y_;
+};
+
+void show_into(std::string& out, const ShowPoint& p)
+{
+    out += '<';
+    fplus::show_into(out, p.x_);
+    out += '|';
+    fplus::show_into(out, p.y_);
+    out += '>';
+}
+
+template <typename T>
+std::string show_via_stream(const T& x)
+{
+    std::ostringstream ss;
+    ss << x;
+    return ss.str();
+}
+
+template <typename T>
+void check_show_integers()
+{
+    typedef std::numeric_limits<T> Limits;
+    std::vector<T> values = {T(0), T(1), T(9), T(10), T(99), T(100),
+        Limits::max(), Limits::min(), T(Limits::max() - 1),
+        T(Limits::min() + 1), T(Limits::max() / 10)};
+    if (std::is_signed<T>::value)
+        values.push_back(T(0 - 1));
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<long long> dis(
+        static_cast<long long>(Limits::min() / 2),
+        static_cast<long long>(Limits::max() / 2));
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(static_cast<T>(dis(gen)));
+    for (T x : values)
+        assert(fplus::show(x) == show_via_stream(x));
+}
+
+template <typename T>
+T parse_float_for_show(const std::string& str);
+
+template <>
+float parse_float_for_show<float>(const std::string& str)
+{
+    return std::strtof(str.c_str(), nullptr);
+}
+
+template <>
+double parse_float_for_show<double>(const std::string& str)
+{
+    return std::strtod(str.c_str(), nullptr);
+}
+
+template <typename T>
+void check_show_floats()
+{
+    typedef std::numeric_limits<T> Limits;
+    std::vector<T> values = {T(0), -T(0), T(1), T(-1.5), T(0.1),
+        T(1e-5), T(123456), T(1234567), T(1e100L > Limits::max() ? 1e30 : 1e100),
+        Limits::max(), Limits::min(), Limits::lowest(), Limits::denorm_min(),
+        Limits::epsilon(), Limits::infinity(), -Limits::infinity(),
+        Limits::quiet_NaN()};
+    std::mt19937 gen(11);
+    std::uniform_real_distribution<double> mantissa(-10, 10);
+    std::uniform_int_distribution<int> exponent(-30, 30);
+    for (int i = 0; i < 1000; ++i)
+        values.push_back(static_cast<T>(
+            mantissa(gen) * std::pow(10.0, exponent(gen))));
+    for (T x : values)
+    {
+        assert(fplus::show(x) == show_via_stream(x));
+        const std::string exact = fplus::show_round_trip(x);
+        if (std::isnan(x))
+        {
+            assert(exact == show_via_stream(x));
+            continue;
+        }
+        // The shortest precision reading back the same value wins.
+        std::string expected;
+        for (int precision = 1; expected.empty(); ++precision)
+        {
+            std::ostringstream ss;
+            ss.precision(precision);
+            ss << x;
+            if (parse_float_for_show<T>(ss.str()) == x)
+                expected = ss.str();
+        }
+        assert(exact == expected);
+    }
+}
+
+void Test_Show()
+{
+    using namespace fplus;
+    check_show_integers<short>();
+    check_show_integers<unsigned short>();
+    check_show_integers<int>();
+    check_show_integers<unsigned int>();
+    check_show_integers<long>();
+    check_show_integers<unsigned long>();
+    check_show_integers<long long>();
+    check_show_integers<unsigned long long>();
+    check_show_floats<float>();
+    check_show_floats<double>();
+
+    assert(show('x') == "x");
+    assert(show(true) == "1");
+    assert(show("abc") == "abc");
+    assert(show(std::string("abc")) == "abc");
+    assert(show(1.0 / 3.0) == "0.333333");
+    assert(show(2.5f) == "2.5");
+    assert(show(1e20) == "1e+20");
+    assert(show(std::make_pair(1, std::string("one"))) == "(1, one)");
+
+    assert(show_round_trip(0.1) == "0.1");
+    assert(show_round_trip(1.0 / 3.0) == "0.3333333333333333");
+    assert(show_round_trip(0.1f) == "0.1");
+    assert(show_round_trip(1e23) == "1e+23");
+    assert(show_round_trip(100.0) == "100");
+
+    typedef std::vector<int> IntVector;
+    assert(show_cont(IntVector()) == "[]");
+    assert(show_cont(IntVector({-1, 0, 42})) == "[-1, 0, 42]");
+    assert(show_cont_with_frame(" => ", "{", "}", IntVector({1, 2, 3}))
+        == "{1 => 2 => 3}");
+    assert(show_cont(std::vector<double>({0.5, -2})) == "[0.5, -2]");
+    assert(show_cont(std::vector<std::string>({"a", "", "b"}))
+        == "[a, , b]");
+
+    const std::vector<ShowPoint> points = {{1, 2}, {-3, 4}};
+    assert(show(points[0]) == "<1|2>");
+    assert(show_cont(points) == "[<1|2>, <-3|4>]");
+    assert(show(std::make_pair(ShowPoint{5, 6}, 7)) == "(<5|6>, 7)");
+    assert(show_maybe(just(ShowPoint{0, 0})) == "Just <0|0>");
+
+    assert(show_maybe(just(-7)) == "Just -7");
+    assert(show_maybe(nothing<double>()) == "Nothing");
+    assert(show_maybe(just(std::make_pair(1, 2))) == "Just (1, 2)");
+    assert(show_result(ok<double, std::string>(0.25)) == "Ok 0.25");
+    assert(show_result(error<int, std::string>("x")) == "Error x");
+    assert(show_cont(std::vector<maybe<int>>({just(1), nothing<int>()}))
+        == "[Just 1, Nothing]");
+
+    const std::string previous_locale = set_decimal_comma_locale();
+    if (!previous_locale.empty())
+    {
+        assert(show(1.5) == "1.5");
+        assert(show(1.5f) == "1.5");
+        assert(show(1.5L) == "1.5");
+        assert(show(-2.5e30) == "-2.5e+30");
+        assert(show_cont(std::vector<double>({0.5, 2})) == "[0.5, 2]");
+        assert(show_round_trip(0.1) == "0.1");
+        assert(read_value<double>(show_round_trip(1.0 / 3.0))
+            == just(1.0 / 3.0));
+        std::setlocale(LC_ALL, previous_locale.c_str());
+    }
+}
+
+void check_lazy_split_lines(const std::string& str)
+{
+    typedef std::vector<std::string> Strings;
+    for (bool allowEmpty : {false, true})
+    {
+        const auto expected = fplus::split_lines(str, allowEmpty);
+        assert(fplus::lazy::materialize(
+            fplus::lazy::split_lines(str, allowEmpty)) == expected);
+        assert(fplus::lazy::materialize(
+            fplus::lazy::split_lines(std::string(str), allowEmpty))
+                == expected);
+        Strings lines;
+        for (const auto& line : fplus::lazy::split_lines(str, allowEmpty))
+            lines.push_back(line);
+        assert(lines == expected);
+#if __cplusplus >= 201703L
+        Strings from_views;
+        for (std::string_view line :
+                fplus::lazy::split_lines_views(str, allowEmpty))
+            from_views.push_back(std::string(line));
+        assert(from_views == expected);
 #endif
+    }
+}
 
-    Ints numbers = generate<Ints>(rand, 5000);
-    run_n_times(run_loop, numRuns, "Hand-written for loop", numbers);
-    run_n_times(run_stl, numRuns, "std::copy_if", numbers);
-    run_n_times(run_FunctionalPlus, numRuns, "FunctionalPlus::keep_if", numbers);
+void Test_File()
+{
+    using namespace fplus;
+    typedef std::vector<std::string> Strings;
+
+    for (const std::string str : {"", "a", "\n", "\r\n", "\r", "a\n",
+            "a\r\nb", "\n\nx\r\r\ny\n", "Hi,\r\nhow are you?\r"})
+        check_lazy_split_lines(str);
+    {
+        const std::string alphabet = "ab \r\n";
+        std::mt19937 gen(5);
+        std::uniform_int_distribution<std::size_t> dis(0, alphabet.size() - 1);
+        for (std::size_t n = 0; n < 100; ++n)
+        {
+            std::string str;
+            for (std::size_t i = 0; i < n; ++i)
+                str.push_back(alphabet[dis(gen)]);
+            check_lazy_split_lines(str);
+        }
+    }
+
+    const std::string path = "fplus_test_file.txt";
+    const Strings lines = {"first", "", "third line", "x"};
+    const auto written = write_lines(path, lines);
+    assert(is_ok(written) && unsafe_get_ok(written) == 4);
+
+    const auto file = read_file_mapped(path);
+    assert(is_ok(file));
+    const mapped_file& contents = file.unsafe_get_ok();
+#ifdef FPLUS_HAS_MMAP
+    assert(contents.is_mapped());
+#endif
+    assert(contents.str() == "first\n\nthird line\nx\n");
+    assert(lazy::materialize(lazy::split_lines(contents, true))
+        == Strings({"first", "", "third line", "x", ""}));
+    assert(count('\n', contents) == 4);
+
+    const auto streamed = internal::read_file_streamed(path);
+    assert(is_ok(streamed));
+    assert(!streamed.unsafe_get_ok().is_mapped());
+    assert(streamed.unsafe_get_ok().str() == contents.str());
+
+    // read, split, filter and write again without a temporary container
+    const auto non_empty = write_lines(path + ".out", lazy::keep_if(
+        [](const std::string& line) { return !line.empty(); },
+        lazy::split_lines(unsafe_get_ok(read_file_mapped(path)), false)));
+    assert(is_ok(non_empty) && unsafe_get_ok(non_empty) == 3);
+    assert(read_file_mapped(path + ".out").unsafe_get_ok().str()
+        == "first\nthird line\nx\n");
+
+    const auto numbers = write_lines(path, std::vector<int>({1, -2, 3}));
+    assert(is_ok(numbers));
+    assert(read_file_mapped(path).unsafe_get_ok().str() == "1\n-2\n3\n");
+
+    // Large enough for several blocks
+    Strings many;
+    for (int i = 0; i < 100000; ++i)
+        many.push_back(std::to_string(i));
+    assert(unsafe_get_ok(write_lines(path, many)) == many.size());
+    assert(lazy::materialize(lazy::split_lines(
+        read_file_mapped(path).unsafe_get_ok(), false)) == many);
+
+    assert(is_ok(write_lines(path, Strings())));
+    const auto empty = read_file_mapped(path);
+    assert(is_ok(empty) && empty.unsafe_get_ok().empty());
+    assert(lazy::materialize(
+        lazy::split_lines(empty.unsafe_get_ok(), true)).empty());
+
+    std::remove(path.c_str());
+    std::remove((path + ".out").c_str());
+    const auto missing = read_file_mapped(path);
+    assert(is_error(missing));
+    assert(missing.unsafe_get_error().find(path) == 0);
+    assert(is_error(internal::read_file_streamed(path)));
+    assert(is_error(write_lines("no_such_dir/file.txt", lines)));
 }
 
+typedef std::vector<std::vector<std::string>> CsvRecords;
+
+// Straightforward sequential reading, char by char.
+CsvRecords naive_csv_records(const std::string& str, char delimiter)
+{
+    CsvRecords records;
+    std::size_t i = 0;
+    const std::size_t n = str.size();
+    while (i < n)
+    {
+        if (str[i] == '\n')
+        {
+            ++i;
+            continue;
+        }
+        if (str[i] == '\r' && i + 1 < n && str[i + 1] == '\n')
+        {
+            i += 2;
+            continue;
+        }
+        std::vector<std::string> record;
+        for (;;)
+        {
+            std::string field;
+            if (i < n && str[i] == '"')
+            {
+                ++i;
+                while (i < n)
+                {
+                    if (str[i] == '"')
+                    {
+                        ++i;
+                        if (i < n && str[i] == '"')
+                            field += str[i++];
+                        else
+                            break;
+                    }
+                    else
+                    {
+                        field += str[i++];
+                    }
+                }
+                while (i < n && str[i] != delimiter && str[i] != '\n')
+                    ++i;
+            }
+            else
+            {
+                while (i < n && str[i] != delimiter && str[i] != '\n')
+                    field += str[i++];
+                if (!field.empty() && field.back() == '\r')
+                    field.pop_back();
+            }
+            record.push_back(field);
+            if (i < n && str[i] == delimiter)
+            {
+                ++i;
+                continue;
+            }
+            if (i < n)
+                ++i;
+            break;
+        }
+        records.push_back(record);
+    }
+    return records;
+}
+
+template <typename T>
+void check_csv_column(const fplus::csv_column<T>& column,
+    const CsvRecords& records, std::size_t idx)
+{
+    assert(column.values.size() == records.size());
+    assert(column.valid.size() == records.size());
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        const auto expected = idx < records[i].size()
+            ? fplus::read_value<T>(records[i][idx]) : fplus::nothing<T>();
+        assert(column.valid[i] == fplus::is_just(expected));
+        assert(column.values[i] == fplus::just_with_default(T(), expected));
+    }
+}
+
+void check_csv_column(const fplus::csv_column<std::string>& column,
+    const CsvRecords& records, std::size_t idx)
+{
+    assert(column.values.size() == records.size());
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        assert(column.valid[i] == (idx < records[i].size()));
+        assert(column.values[i] ==
+            (idx < records[i].size() ? records[i][idx] : std::string()));
+    }
+}
+
+void check_read_csv_columns(const std::string& str, char delimiter,
+    bool skipHeader)
+{
+    const auto all_records = naive_csv_records(str, delimiter);
+    CsvRecords records = all_records;
+    // The header is the first line, unless it is empty.
+    if (skipHeader && !str.empty() && str[0] != '\n' &&
+        str.compare(0, 2, "\r\n") != 0)
+        records.erase(records.begin());
+    const auto columns = fplus::read_csv_columns<int, double, std::string>(
+        delimiter, skipHeader, str);
+    check_csv_column(std::get<0>(columns), records, 0);
+    check_csv_column(std::get<1>(columns), records, 1);
+    check_csv_column(std::get<2>(columns), records, 2);
+}
+
+std::string random_csv(std::mt19937& gen, std::size_t records,
+    char delimiter)
+{
+    const std::vector<std::string> fields = {"1", "-42", "2.5", "1e3",
+        "x", "", " 7", "\"3\"", "\"a\"\"b\"", "\"multi\nline\"",
+        "\"with" + std::string(1, delimiter) + "delimiter\"",
+        "\"\"", "99999999999", "abc def", "\"\r\n\""};
+    std::uniform_int_distribution<std::size_t> field_dis(0, fields.size() - 1);
+    std::uniform_int_distribution<int> count_dis(0, 5);
+    std::uniform_int_distribution<int> line_end_dis(0, 5);
+    std::string result;
+    for (std::size_t i = 0; i < records; ++i)
+    {
+        const int count = count_dis(gen);
+        for (int j = 0; j < count; ++j)
+        {
+            if (j != 0)
+                result += delimiter;
+            result += fields[field_dis(gen)];
+        }
+        const int line_end = line_end_dis(gen);
+        result += line_end == 0 ? "\r\n" : line_end == 1 ? "\n\n" : "\n";
+    }
+    return result;
+}
+
+void Test_Csv()
+{
+    using namespace fplus;
+    typedef std::vector<int> IntVector;
+    typedef std::vector<std::string> Strings;
+    typedef std::vector<bool> Bools;
+
+    const auto columns = read_csv_columns<int, std::string>(',', false,
+        std::string("1,a\n2,\"b,c\"\nx,d\n"));
+    assert(std::get<0>(columns).values == IntVector({1, 2, 0}));
+    assert(std::get<0>(columns).valid == Bools({true, true, false}));
+    assert(std::get<1>(columns).values == Strings({"a", "b,c", "d"}));
+    assert(std::get<1>(columns).valid == Bools({true, true, true}));
+
+    const auto tsv = read_csv_columns<std::string, double, int>('\t', true,
+        std::string("name\tvalue\tcount\r\n"
+            "\"say \"\"hi\"\"\"\t1.5\t3\r\n"
+            "\r\n"
+            "two\nlines\t-2\n"
+            "short\n"
+            "\"line\nbreak\"\t0.25\t7\textra\t\"x\ny\"\n"
+            "last\t1e2\t5"));
+    assert(std::get<0>(tsv).values == Strings(
+        {"say \"hi\"", "two", "lines", "short", "line\nbreak", "last"}));
+    assert(std::get<1>(tsv).values ==
+        std::vector<double>({1.5, 0, -2, 0, 0.25, 100}));
+    assert(std::get<1>(tsv).valid ==
+        Bools({true, false, true, false, true, true}));
+    assert(std::get<2>(tsv).values == IntVector({3, 0, 0, 0, 7, 5}));
+    assert(std::get<2>(tsv).valid ==
+        Bools({true, false, false, false, true, true}));
+
+    const auto empty = read_csv_columns<int>(',', true, std::string());
+    assert(std::get<0>(empty).values.empty());
+
+    const std::size_t min_parallel_size = par::min_parallel_size();
+    std::mt19937 gen(3);
+    for (std::size_t parallel_size : {std::size_t(1), std::size_t(1000000)})
+    {
+        par::min_parallel_size() = parallel_size;
+        for (const std::string str : {"", "\n", "a", "\"", "1,2,3",
+                "\"a\nb\"\n\"c\nd\"\n", "\"\"\"\n\"\n\"\n", "1,\"2\"\"\n"})
+        {
+            check_read_csv_columns(str, ',', false);
+            check_read_csv_columns(str, ',', true);
+        }
+        for (std::size_t records = 0; records < 60; ++records)
+        {
+            for (char delimiter : {',', '\t'})
+            {
+                const std::string str = random_csv(gen, records, delimiter);
+                check_read_csv_columns(str, delimiter, false);
+                check_read_csv_columns(str, delimiter, true);
+            }
+        }
+    }
+    par::min_parallel_size() = min_parallel_size;
+
+    // Without quotes it is the same as splitting and reading by hand.
+    {
+        std::string str;
+        for (int i = 0; i < 20000; ++i)
+            str += std::to_string(i) + ";" + std::to_string(i * 0.5) +
+                (i % 7 == 0 ? ";oops\n" : ";x\n");
+        IntVector ints;
+        std::vector<double> doubles;
+        for (const auto& line : split_lines(str, false))
+        {
+            const auto fields = split_words_by(line, ';', true);
+            ints.push_back(unsafe_get_just(read_value<int>(fields[0])));
+            doubles.push_back(unsafe_get_just(read_value<double>(fields[1])));
+        }
+        const auto csv = read_csv_columns<int, double>(';', false, str);
+        assert(std::get<0>(csv).values == ints);
+        assert(std::get<1>(csv).values == doubles);
+        assert(all(std::get<1>(csv).valid));
+        const std::string path = "fplus_test_file.csv";
+        assert(is_ok(write_lines(path, split_lines(str, false))));
+        const auto file_csv = read_csv_columns<int, double>(';', false,
+            read_file_mapped(path).unsafe_get_ok());
+        assert(std::get<0>(file_csv).values == ints);
+        std::remove(path.c_str());
+    }
+}
+
+void Test_RleVector()
+{
+    using namespace fplus;
+    typedef std::vector<int> IntVector;
+    typedef std::vector<std::pair<std::size_t, int>> Runs;
+    typedef rle_vector<int> IntRle;
+
+    const IntRle xs(Runs({{3, 1}, {0, 7}, {2, 5}, {1, 5}, {1, 1}}));
+    assert(xs.runs() == Runs({{3, 1}, {3, 5}, {1, 1}}));
+    assert(convert_container<IntVector>(xs) == IntVector({1,1,1,5,5,5,1}));
+    assert(size_of_cont(xs) == 7);
+    assert(is_empty(IntRle()) == true);
+    assert(size_of_cont(IntRle()) == 0);
+    assert(IntRle().begin() == IntRle().end());
+    assert(to_rle_vector(IntVector({1,1,1,5,5,5,1})) == xs);
+    assert(to_rle_vector(IntVector()) == IntRle());
+    assert(IntRle(run_length_encode(IntVector({1,1,1,5,5,5,1}))) == xs);
+    assert(run_length_decode(xs.runs()) == IntVector({1,1,1,5,5,5,1}));
+
+    assert(elem_at_idx(0, xs) == 1);
+    assert(elem_at_idx(2, xs) == 1);
+    assert(elem_at_idx(3, xs) == 5);
+    assert(elem_at_idx(6, xs) == 1);
+    assert(xs.run_idx(5) == 1);
+    assert(xs.run_start(2) == 6);
+    assert(sum(xs) == 19);
+    assert(count(1, xs) == 4);
+    assert(count(2, xs) == 0);
+    assert(find_first_idx(5, xs) == just<std::size_t>(3));
+    assert(find_first_idx(2, xs) == nothing<std::size_t>());
+
+    // Runs mapped to equal values are merged.
+    auto is_odd_int = [](int x) { return x % 2 != 0; };
+    const rle_vector<bool> odds = transform(is_odd_int, xs);
+    assert(odds.runs() ==
+        (std::vector<std::pair<std::size_t, bool>>({{7, true}})));
+    auto times_2 = [](int x) { return 2 * x; };
+    assert(convert_container<IntVector>(transform(times_2, xs)) ==
+        IntVector({2,2,2,10,10,10,2}));
+    auto is_one = [](int x) { return x == 1; };
+    assert(keep_if(is_one, xs).runs() == Runs({{4, 1}}));
+    assert(keep_if(is_odd_int, IntRle()) == IntRle());
+
+    rle_vector<std::string> strs;
+    strs.push_back("a");
+    strs.push_back("a");
+    strs.append_run(3, "b");
+    assert(sum(strs) == "aabbb");
+    assert(strs.runs().size() == 2);
+
+    // Functions without an own version iterate over the elements.
+    assert(maximum(xs) == 5);
+    assert(all_by(is_odd_int, xs) == true);
+    assert(keep_if(is_odd_int, convert_container<IntVector>(xs)) ==
+        IntVector({1,1,1,5,5,5,1}));
+
+    std::mt19937 gen(29);
+    for (std::size_t run_count : {0, 1, 2, 50})
+    {
+        const IntVector lengths = random_ints(gen, 5, run_count);
+        const IntVector values = random_ints(gen, 3, run_count);
+        Runs runs;
+        for (std::size_t i = 0; i < run_count; ++i)
+            runs.push_back(std::make_pair(
+                static_cast<std::size_t>(std::abs(lengths[i])), values[i]));
+        const IntVector ys = run_length_decode(runs);
+        const IntRle rle(runs);
+        assert(convert_container<IntVector>(rle) == ys);
+        assert(rle == to_rle_vector(ys));
+        assert(rle.runs() == run_length_encode(ys));
+        assert(size_of_cont(rle) == ys.size());
+        for (std::size_t idx = 0; idx < ys.size(); ++idx)
+            assert(elem_at_idx(idx, rle) == ys[idx]);
+        assert(sum(rle) == sum(ys));
+        for (int x = -4; x < 4; ++x)
+        {
+            assert(count(x, rle) == count(x, ys));
+            assert(find_first_idx(x, rle) == find_first_idx(x, ys));
+        }
+        assert(convert_container<IntVector>(keep_if(is_odd_int, rle)) ==
+            keep_if(is_odd_int, ys));
+        assert(convert_container<IntVector>(transform(times_2, rle)) ==
+            transform(times_2, ys));
+    }
+}
+
+void Test_ContainerBuilder()
+{
+    using namespace fplus;
+    typedef std::vector<int> IntVector;
+    const IntVector xs = {1, 2, 3, 4, 5};
+    auto squared = [](int x) { return x * x; };
+    auto is_odd = [](int x) { return x % 2 == 1; };
+
+    static_assert(std::is_same<container_builder<std::string>::iterator,
+        std::back_insert_iterator<std::string>>::value,
+        "Strings must be appended to with push_back.");
+    static_assert(std::is_same<container_builder<std::set<int>>::iterator,
+        std::insert_iterator<std::set<int>>>::value,
+        "Sets must be inserted into.");
+
+    typedef push_back_vector<int> PushBackInts;
+    const auto pushed = transform_convert<PushBackInts>(squared, xs);
+    assert(pushed.elems() == transform(squared, xs));
+    assert(pushed.reserved() == xs.size());
+    assert(keep_if(is_odd, pushed).elems() == IntVector({1, 9, 25}));
+    assert(generate_by_idx<PushBackInts>(
+        [](std::size_t i) { return static_cast<int>(i); }, 3).reserved() == 3);
+
+    typedef emplace_back_vector<int> EmplaceBackInts;
+    assert(convert_container<EmplaceBackInts>(xs).elems() == xs);
+    assert(transform_convert<EmplaceBackInts>(squared, xs).elems() ==
+        transform(squared, xs));
+
+    const std::string text(1000, 'a');
+    auto next_char = [](char c) { return static_cast<char>(c + 1); };
+    assert(alloc_count::measure([&]
+        { return transform(next_char, text); }).allocations == 1);
+    assert(alloc_count::measure([&]
+        { return replicate<char, std::string>(1000, 'a'); }).allocations == 1);
+    assert(alloc_count::measure([&]
+        { return append(text, text); }).allocations == 1);
+}
+
+void Test_Allocations()
+{
+    using namespace fplus;
+    using alloc_count::measure;
+
+    typedef std::vector<int> IntVector;
+    typedef std::list<int> IntList;
+    const IntVector xs = generate_range<IntVector>(0, 1000);
+    const IntList intList = convert_container<IntList>(xs);
+    auto plus = [](int x, int y) { return x + y; };
+    auto is_even = [](int x) { return x % 2 == 0; };
+    auto squared = [](int x) { return x * x; };
+
+    assert(measure([&]{ return size_of_cont(xs); }).allocations == 0);
+    assert(measure([&]{ return fold_left(plus, 0, xs); }).allocations == 0);
+    assert(measure([&]{ return fold_left_1(plus, xs); }).allocations == 0);
+    assert(measure([&]{ return fold_right(plus, 0, xs); }).allocations == 0);
+    assert(measure([&]{ return fold_right_1(plus, xs); }).allocations == 0);
+    assert(measure([&]{ return sum(xs); }).allocations == 0);
+    assert(measure([&]{ return sum(intList); }).allocations == 0);
+    assert(measure([&]{ return is_elem_of(-1, xs); }).allocations == 0);
+    assert(measure([&]{ return count(2, xs); }).allocations == 0);
+    assert(measure([&]{ return count_if(is_even, xs); }).allocations == 0);
+    assert(measure([&]{ return find_first_idx(500, xs); }).allocations == 0);
+    assert(measure([&]{ return all_by(is_even, xs); }).allocations == 0);
+    assert(measure([&]{ return is_sorted(xs); }).allocations == 0);
+    assert(measure([&]{ return elem_at_idx(500, xs); }).allocations == 0);
+
+    assert(measure([&]{ return transform(squared, xs); }).allocations == 1);
+    assert(measure([&]{ return transform(squared, xs); }).bytes ==
+        xs.size() * sizeof(int));
+    assert(measure([&]{ return reverse(xs); }).allocations == 1);
+    assert(measure([&]{ return sort(xs); }).allocations == 1);
+    assert(measure([&]{ return unique(xs); }).allocations == 1);
+    assert(measure([&]{ return append(xs, xs); }).allocations == 1);
+    assert(measure([&]{ return intersperse(0, xs); }).allocations == 1);
+    assert(measure([&]{ return replicate<int, IntVector>(1000, 1); })
+        .allocations == 1);
+    assert(measure([&]{ return insert_at(5, xs, xs); }).allocations == 1);
+    assert(measure([&]{ return replace_if(is_even, 0, xs); })
+        .allocations == 1);
+    const IntVector zeros(1000, 0);
+    const IntVector zero_zero = {0, 0};
+    const IntVector one = {1};
+    const IntVector one_one = {1, 1};
+    assert(measure([&]{ return replace_tokens(zero_zero, one, zeros); })
+        .allocations == 1);
+    assert(measure([&]{ return transform(squared, intList); }).allocations
+        == intList.size());
+
+    auto is_big = [](int x) { return x > 500; };
+    assert(measure([&]{ return just(42); }).allocations == 0);
+    assert(measure([&]{ return ok<int, std::string>(42); }).allocations == 0);
+    assert(measure([&]{ return read_value_result<int>("42"); }).allocations
+        == 0);
+    const auto squared_result = lift_result<std::string>(squared);
+    const auto three = ok<int, std::string>(3);
+    assert(measure([&]{ return squared_result(three); }).allocations == 0);
+    assert(measure([&]{ return find_first_by(is_big, xs); }).allocations == 0);
+    assert(measure([&]{ return find_first_idx_by(is_big, xs); })
+        .allocations == 0);
+
+    // Temporaries passed in are reused.
+    IntVector ys = xs;
+    ys.reserve(2 * xs.size());
+    IntVector zs = zeros;
+    alloc_count::scope in_place;
+    ys = append(std::move(ys), xs);
+    ys = keep_if(is_even, std::move(ys));
+    ys = drop_if(is_even, transform(squared, std::move(ys)));
+    ys = unique(sort(reverse(std::move(ys))));
+    ys = replace_if(is_even, 0, std::move(ys));
+    ys = trim(0, std::move(ys));
+    zs = replace_tokens(zero_zero, one_one, std::move(zs));
+    zs = trim_token_right(one, std::move(zs));
+    assert(in_place.allocations() == 0);
+    assert(zs.empty());
+}
+
+bool is_odd(int x) { return x % 2 == 1; }
+void Test_example_KeepIf()
+{
+    typedef std::vector<int> Ints;
+    Ints numbers = { 24, 11, 65, 44, 80, 18, 73, 90, 69, 18 };
+
+    { // Version 1: hand written range based for loop
+    Ints odds;
+    for (int x : numbers)
+        if (is_odd(x))
+            odds.push_back(x);
+    }
+
+    { // Version 2: STL
+    Ints odds;
+    std::copy_if(std::begin(numbers), std::end(numbers),
+            std::back_inserter(odds), is_odd);
+    }
+
+    { // Version : FunctionalPlus
+    auto odds = fplus::keep_if(is_odd, numbers);
+    }
+}
 
 void Test_example_SameOldSameOld()
 {
@@ -1189,9 +2905,44 @@ int main()
     Test_Read();
     std::cout << "Read OK." << std::endl;
 
+    std::cout << "Testing Lazy." << std::endl;
+    Test_Lazy();
+    std::cout << "Lazy OK." << std::endl;
+
+    std::cout << "Testing Par." << std::endl;
+    Test_Par();
+    std::cout << "Par OK." << std::endl;
+
+    std::cout << "Testing TokenSearch." << std::endl;
+    Test_TokenSearch();
+    std::cout << "TokenSearch OK." << std::endl;
+
+    std::cout << "Testing Show." << std::endl;
+    Test_Show();
+    std::cout << "Show OK." << std::endl;
+
+    std::cout << "Testing File." << std::endl;
+    Test_File();
+    std::cout << "File OK." << std::endl;
+
+    std::cout << "Testing Csv." << std::endl;
+    Test_Csv();
+    std::cout << "Csv OK." << std::endl;
+
+    std::cout << "Testing RleVector." << std::endl;
+    Test_RleVector();
+    std::cout << "RleVector OK." << std::endl;
+
+    std::cout << "Testing ContainerBuilder." << std::endl;
+    Test_ContainerBuilder();
+    std::cout << "ContainerBuilder OK." << std::endl;
+
+    std::cout << "Testing Allocations." << std::endl;
+    Test_Allocations();
+    std::cout << "Allocations OK." << std::endl;
+
     std::cout << "Testing Applications." << std::endl;
     Test_example_KeepIf();
-    Test_example_KeepIf_performance();
     Test_example_SameOldSameOld();
     Test_example_IInTeam();
     Test_example_AllIsCalmAndBright();